@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct AdaptiveStats
+ * @brief Counters of one adaptive render
+ */
+struct AdaptiveStats {
+    PathStats paths;                 // Over every sample of both passes
+    long long samples = 0;           // Camera rays
+    long long refinedPixels = 0;     // Pixels that went past the first pass
+};
+
+/**
+ * @class AdaptiveRenderer
+ * @brief Variance- and contrast-driven supersampling ("adaptive" renderer)
+ *
+ * Flat pixels, the background above all, do not need the full grid of
+ * SamplePixel. A first pass gives every pixel adaptiveMinSamples samples of
+ * the grid (AntiAliasing::AddSamples, stratified order). A second pass keeps
+ * adding batches of that size, up to the sample count, while the standard error
+ * of the pixel's luminance is above adaptiveThreshold. A pixel also gets at
+ * least one more batch when its first-pass luminance differs by more than
+ * adaptiveContrast from a 4-neighbor: an edge that runs between the first
+ * samples of two pixels leaves both of them uniform, only the contrast shows it.
+ */
+class AdaptiveRenderer {
+public:
+    /**
+     * @param scene Scene to trace against; thresholds come from its settings
+     * @param antiAliasing Sub-pixel grid, its size is the cap of samples per pixel
+     */
+    AdaptiveRenderer(const Scene& scene, const AntiAliasing& antiAliasing);
+
+    /**
+     * @brief Renders every pixel of the image
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads of each pass
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     * @param sampleCounts Optional, resized to width * height and filled with the samples of each pixel (row-major)
+     */
+    AdaptiveStats Render(Image& image,
+                         const Vec3& camOrigin,
+                         const Vec3& lowerLeftCorner,
+                         const Vec3& horizontal,
+                         const Vec3& vertical,
+                         unsigned numThreads,
+                         const LightTiles* lightTiles = nullptr,
+                         std::vector<int>* sampleCounts = nullptr) const;
+
+private:
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+};
@@ -1,10 +1,15 @@
 #ifndef ANTIALIASING_HPP
 #define ANTIALIASING_HPP
 
-#include <vector>
+#include <cstdint>
 #include <memory>
-#include "Shape.hpp"
+#include <vector>
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "LightTiles.hpp"
 #include "Color.hpp"
+#include "Radiance.hpp"
+#include "Sampler.hpp"
 #include "Vec3.hpp"
 
 /**
@@ -13,11 +18,24 @@
  *
  * Eliminates jagged edges by casting multiple rays per pixel in a regular grid.
  * Each sample is positioned at the center of its sub-pixel cell and colors are averaged.
+ * Other patterns (jittered, Sobol, R2, blue noise, see Sampler.hpp) take any
+ * sample count and break up the aliasing of near-axis-aligned edges.
  *
  * Performance impact:
  * - samplesPerAxis = 2 → 4 rays/pixel (2x2 grid)   - Fast, noticeable improvement
  * - samplesPerAxis = 4 → 16 rays/pixel (4x4 grid)  - High quality, recommended
  * - samplesPerAxis = 8 → 64 rays/pixel (8x8 grid)  - Ultra quality, very slow
+ *
+ * Adaptive sampling (AdaptiveRenderer) treats the grid as a cap: cells are
+ * added to a pixel in a stratified order with AddSamples, until its error is low.
+ *
+ * The grids of 1, 2x2, 4x4 and 8x8 samples have compile-time specializations
+ * of SamplePixel: the cell offsets come from constexpr tables and the loops
+ * have fixed trip counts, so the compiler unrolls them, and the
+ * virtual Sampler::Offset call and the index division go away. The
+ * constructor picks the path from a dispatch table indexed by
+ * samplesPerAxis; the other counts and samplers take the generic loop.
+ * Both give the same image, bit for bit.
  */
 class AntiAliasing {
 private:
@@ -25,18 +43,47 @@ private:
     int totalSamples_;
     float invSamplesPerAxis_;
     float invTotalSamples_;
+    float sampleWidth_;              // Share of the pixel width one sample stands for, 1 / sqrt(totalSamples_)
+    std::shared_ptr<const Sampler> sampler_;
+    std::vector<int> sampleOrder_;   // Sample indices, any prefix spread over the whole pixel
+
+    using SamplePixelFn = Radiance (AntiAliasing::*)(int, int, int, int, const Vec3&, const Vec3&, const Vec3&,
+                                                     const Vec3&, const Scene&, PathStats*, const LightTiles*) const;
+    SamplePixelFn samplePixel_;      // SampleGrid<samplesPerAxis> when specialized, SamplePixelGeneric otherwise
+
+    /// SamplePixel for the samplesPerAxis x samplesPerAxis grid, offsets and loop bounds known at compile time
+    template <int SamplesPerAxis>
+    Radiance SampleGrid(int pixelX, int pixelY, int imageWidth, int imageHeight,
+                        const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+                        const Vec3& horizontal, const Vec3& vertical, const Scene& scene,
+                        PathStats* stats, const LightTiles* lightTiles) const;
 
 public:
     /**
      * @brief Construct an AntiAliasing sampler
      * @param samplesPerAxis Number of samples along each axis (total = samplesPerAxis^2)
+     * @param samplerType Sample pattern in the pixel
+     * @param samplesPerPixel Samples per pixel for the patterns other than Grid; 0 for samplesPerAxis^2
+     */
+    explicit AntiAliasing(int samplesPerAxis = 4, SamplerType samplerType = SamplerType::Grid, int samplesPerPixel = 0);
+
+    /**
+     * @brief Position of a sample in its pixel, from the sampler
+     * @param pixelX X coordinate of the pixel
+     * @param pixelY Y coordinate of the pixel
+     * @param sampleIndex Sample within the pixel, in [0, GetTotalSamples())
+     * @param outX Offset along the image width, in [0, 1)
+     * @param outY Offset along the image height, in [0, 1)
      */
-    explicit AntiAliasing(int samplesPerAxis = 4);
+    void SampleOffset(int pixelX, int pixelY, int sampleIndex, float& outX, float& outY) const
+    {
+        sampler_->Offset(pixelX, pixelY, sampleIndex, outX, outY);
+    }
 
     /**
      * @brief Sample a single pixel with anti-aliasing
      *
-     * Casts multiple rays per pixel in a regular grid pattern and averages the results.
+     * Casts GetTotalSamples() rays at the sampler's positions and averages the results.
      *
      * @param pixelX X coordinate of the pixel
      * @param pixelY Y coordinate of the pixel
@@ -46,30 +93,140 @@ public:
      * @param lowerLeftCorner Lower-left corner of the viewport
      * @param horizontal Horizontal viewport vector
      * @param vertical Vertical viewport vector
-     * @param scene Vector of shapes in the scene
-     * @return Anti-aliased color for the pixel
+     * @param scene Scene to trace against
+     * @param stats Optional path counters, accumulated over the samples
+     * @param lightTiles Optional per-tile light lists for the first hits; all lights otherwise
+     * @return Anti-aliased, unclamped radiance of the pixel
+     */
+    Radiance SamplePixel(
+        int pixelX, int pixelY,
+        int imageWidth, int imageHeight,
+        const Vec3& camOrigin,
+        const Vec3& lowerLeftCorner,
+        const Vec3& horizontal,
+        const Vec3& vertical,
+        const Scene& scene,
+        PathStats* stats = nullptr,
+        const LightTiles* lightTiles = nullptr
+    ) const
+    {
+        return (this->*samplePixel_)(pixelX, pixelY, imageWidth, imageHeight, camOrigin, lowerLeftCorner,
+                                     horizontal, vertical, scene, stats, lightTiles);
+    }
+
+    /**
+     * @brief SamplePixel through the runtime loop, whatever the sampler and count
+     *
+     * The reference the grid specializations are checked and benchmarked against.
+     * Parameters as in SamplePixel.
      */
-    Color SamplePixel(
+    Radiance SamplePixelGeneric(
         int pixelX, int pixelY,
         int imageWidth, int imageHeight,
         const Vec3& camOrigin,
         const Vec3& lowerLeftCorner,
         const Vec3& horizontal,
         const Vec3& vertical,
-        const std::vector<std::unique_ptr<Shape>>& scene
+        const Scene& scene,
+        PathStats* stats = nullptr,
+        const LightTiles* lightTiles = nullptr
     ) const;
 
+    /// Whether SamplePixel runs a compile-time specialization (grid of 1, 2x2, 4x4 or 8x8 samples)
+    bool IsSpecialized() const { return samplePixel_ != &AntiAliasing::SamplePixelGeneric; }
+
+    /**
+     * @struct PixelSamples
+     * @brief Samples taken so far for one pixel by AddSamples
+     *
+     * Keeps the radiance sum and a running (Welford) mean and variance of the
+     * luminance, clamped to 1 so that highlights above white do not keep a
+     * saturated pixel sampling.
+     */
+    struct PixelSamples {
+        Radiance sum;
+        float mean = 0.0f;      // Mean clamped luminance
+        float m2 = 0.0f;        // Sum of squared deviations from the mean
+        int count = 0;
+
+        Radiance Average() const { return count > 0 ? sum * (1.0f / static_cast<float>(count)) : Radiance(); }
+
+        /// Squared standard error of the mean luminance, unbiased variance / count; 0 below 2 samples
+        float SquaredStandardError() const
+        {
+            return count > 1 ? m2 / (static_cast<float>(count - 1) * static_cast<float>(count)) : 0.0f;
+        }
+    };
+
     /**
-     * @brief Get the number of samples per axis
+     * @brief Traces the next cells of GetSampleOrder() for a pixel
+     *
+     * Each cell is the same sample as in SamplePixel (position, cone and path
+     * seed), so a pixel sampled up to GetTotalSamples() sees the same rays.
+     *
+     * @param pixel Samples of the pixel so far, updated
+     * @param count Cells to add, capped at GetTotalSamples() in total
+     * Other parameters as in SamplePixel
+     */
+    void AddSamples(
+        PixelSamples& pixel, int count,
+        int pixelX, int pixelY,
+        int imageWidth, int imageHeight,
+        const Vec3& camOrigin,
+        const Vec3& lowerLeftCorner,
+        const Vec3& horizontal,
+        const Vec3& vertical,
+        const Scene& scene,
+        PathStats* stats = nullptr,
+        const LightTiles* lightTiles = nullptr
+    ) const;
+
+    /**
+     * @brief Opening angle of the cone of one camera sample
+     *
+     * The angle between neighboring samples at the center of the view, which
+     * is the width a sample stands for. Used when the scene has
+     * "textureFilter"; the cones of both pipelines come from here.
+     */
+    float SampleSpread(int imageHeight, const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+                       const Vec3& horizontal, const Vec3& vertical) const;
+
+    /**
+     * @brief Seed of one sample's path, shared by every renderer so random decisions match
+     * @param pixelX X coordinate of the pixel
+     * @param pixelY Y coordinate of the pixel
+     * @param imageWidth Width of the image
+     * @param sampleIndex Sample within the pixel (row-major in the grid)
+     *
+     * Unsigned arithmetic: large frames with many samples wrap around instead of overflowing
+     */
+    std::uint32_t PathSeed(int pixelX, int pixelY, int imageWidth, int sampleIndex) const
+    {
+        const std::uint32_t pixel = static_cast<std::uint32_t>(pixelY) * static_cast<std::uint32_t>(imageWidth)
+                                  + static_cast<std::uint32_t>(pixelX);
+        return pixel * static_cast<std::uint32_t>(totalSamples_) + static_cast<std::uint32_t>(sampleIndex);
+    }
+
+    /**
+     * @brief Get the number of samples per axis of the grid
      * @return Number of samples along each axis
      */
     int GetSamplesPerAxis() const { return samplesPerAxis_; }
 
     /**
      * @brief Get the total number of samples per pixel
-     * @return Total samples (samplesPerAxis^2)
+     * @return Total samples (samplesPerAxis^2 for the grid)
      */
     int GetTotalSamples() const { return totalSamples_; }
+
+    /**
+     * @brief Sample indices in the order AddSamples visits them
+     *
+     * Grid: ordered-dither (Bayer) ranks, so the first 4 cells fall in different
+     * quadrants of the pixel, the first 16 in different sixteenths, and so on.
+     * The other samplers are progressive already and keep their own order.
+     */
+    const std::vector<int>& GetSampleOrder() const { return sampleOrder_; }
 };
 
 #endif // ANTIALIASING_HPP
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct BudgetStats
+ * @brief Counters of one time-budgeted render
+ */
+struct BudgetStats {
+    PathStats paths;                 // Over every sample of both passes
+    long long samples = 0;           // Camera rays
+    long long tileRefinements = 0;   // Batches given to a tile after the first pass
+    long long unsampledPixels = 0;   // Pixels the first pass did not reach before the deadline
+    double firstPassMs = 0.0;        // Time of the full-image pass
+    double elapsedMs = 0.0;          // Time of the whole render, deadline included
+    int tilesX = 0;                  // Tiles per row
+    int tilesY = 0;                  // Tile rows
+    std::vector<float> tileSamples;  // Mean samples per pixel of each tile, row-major
+};
+
+/**
+ * @class BudgetRenderer
+ * @brief Anytime rendering within a wall-clock budget ("budget" renderer)
+ *
+ * A first pass gives every pixel one sample, coarse to fine: rows in
+ * bit-reversed order (0, 1/2, 1/4, 3/4, 1/8... of the height), and the pixels
+ * of each row likewise, so that there is an image of the whole frame early,
+ * even from a pass cut short. The remaining time goes to the tiles of
+ * the light lists (LightTiles::TILE_SIZE pixels square) by expected error
+ * reduction, in batches that bring a pixel to the next multiple of
+ * adaptiveMinSamples (where the sampler's strata are complete): adding b
+ * samples to a pixel of n samples takes its squared standard error from s² to
+ * s² n / (n + b), and a tile's priority is that reduction summed over its
+ * pixels; tiles with pixels short of one full batch, whose error estimate is
+ * not reliable yet, go first. The threads take the worst tile from a shared
+ * queue, give each of its pixels one more batch, and put it back with its new
+ * priority.
+ *
+ * The clock is checked before every pixel of both passes: the render stops at
+ * the deadline, one pixel's batch late at most, and the image holds the mean
+ * of whatever samples each pixel got. A budget too short for the first pass
+ * leaves pixels without a sample, counted in unsampledPixels; they show the
+ * nearest sampled pixel in city-block distance, or the background if there is
+ * none. Pixels stop at the sample count of the AntiAliasing, which is then a
+ * cap; the render ends early once every pixel reaches it.
+ */
+class BudgetRenderer {
+public:
+    /**
+     * @param scene Scene to trace against; the batch size and the budget come from its settings
+     * @param antiAliasing Sample pattern, its count is the cap of samples per pixel
+     */
+    BudgetRenderer(const Scene& scene, const AntiAliasing& antiAliasing);
+
+    /**
+     * @brief Renders the image until the budget runs out or every pixel is at the cap
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads of each pass
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     * @param sampleCounts Optional, resized to width * height and filled with the samples of each pixel (row-major)
+     */
+    BudgetStats Render(Image& image,
+                       const Vec3& camOrigin,
+                       const Vec3& lowerLeftCorner,
+                       const Vec3& horizontal,
+                       const Vec3& vertical,
+                       unsigned numThreads,
+                       const LightTiles* lightTiles = nullptr,
+                       std::vector<int>* sampleCounts = nullptr) const;
+
+private:
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+};
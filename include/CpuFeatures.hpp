@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Instruction set levels the hot kernels are compiled for, from the most
+ * portable to the widest. The order matters: a level implies all lower ones.
+ */
+enum class IsaLevel {
+    Scalar = 0,  // Plain C++, any CPU
+    SSE42,       // SSE4.2
+    AVX2,        // AVX2 + FMA
+    AVX512       // AVX-512 F/VL/BW/DQ
+};
+
+/**
+ * CPU feature detection used to pick the kernel variant at startup
+ */
+namespace CpuFeatures {
+    /**
+     * Queries cpuid (and xgetbv for the OS-enabled register state) and
+     * returns the widest level this CPU can run.
+     * @return Scalar on non-x86 builds
+     */
+    IsaLevel DetectIsaLevel();
+
+    /**
+     * Short lower-case name of a level ("scalar", "sse4.2", "avx2", "avx512")
+     */
+    const char* IsaLevelName(IsaLevel level);
+
+    /**
+     * Parses a level name as accepted by the RAYTRACER_ISA environment variable
+     * @param name Level name, case-insensitive ("sse42" and "sse4.2" are both accepted)
+     * @param out Parsed level, untouched on failure
+     * @return true if the name is known
+     */
+    bool ParseIsaLevel(const std::string& name, IsaLevel& out);
+}
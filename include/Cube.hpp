@@ -5,7 +5,7 @@
 #include "Vec3.hpp"
 
 // Dessine un cube centré (cx, cy), de côté 'size', teinté par baseColor.
-// Éclairage minimal : ambiant + Lambert
+// Couleur unie, éclairée par Ray::ShadeSurface
 class Cube : public Shape
 {
 public:
@@ -14,7 +14,6 @@ public:
     bool Intersect(const Vec3 &o, const Vec3 &d, float &out_t) override;
 
     const Color& GetColor() const { return _color; }
-    Color GetShadedColor(const Vec3& hitPoint) const;
     const Vec3& GetCenter() const { return _center; }
     float GetReflectivity() const { return _reflectivity; }
     float GetSize() const { return _size; }
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include "Image.hpp"
+#include "Scene.hpp"
+#include "Shape.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct DenoiseGuides
+ * @brief Per-pixel auxiliary buffers that tell the denoiser where the edges are
+ *
+ * One ray through each pixel center: the shape it hits, the normal and the
+ * distance there. They are noise-free even at one sample per pixel.
+ */
+struct DenoiseGuides {
+    int width = 0;
+    int height = 0;
+    std::vector<const Shape*> shapes;   // nullptr: background
+    std::vector<Vec3> normals;          // Unit normal of the hit, zero on the background
+    std::vector<float> depths;          // Distance from the camera to the hit, 0 on the background
+
+    /**
+     * @brief Traces the guides of an image
+     * @param scene Scene to trace against
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads tracing the rows
+     */
+    static DenoiseGuides Trace(const Scene& scene, int width, int height,
+                               const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+                               const Vec3& horizontal, const Vec3& vertical,
+                               unsigned numThreads);
+};
+
+/**
+ * @class Denoiser
+ * @brief Edge-avoiding à-trous wavelet filter ("denoise" renderer)
+ *
+ * Dammertz et al. 2010: each iteration blurs the framebuffer with the 5x5
+ * B3-spline kernel, its taps spread 2^i pixels apart, so 5 iterations cover
+ * a 125-pixel-wide footprint for 25 taps per pixel each. Every tap is
+ * weighted by how much its pixel looks like the center one, with the
+ * edge-stopping functions of SVGF (Schied et al. 2017):
+ * - the shape seen must be the same (silhouettes never blur);
+ * - normals: max(0, dot)^64 (creases of the cubes, sphere curvature);
+ * - depth: difference against what the local depth slope predicts over the
+ *   tap's offset, so a floor seen at a grazing angle still blurs;
+ * - luminance: difference against luminanceSigma standard errors of the
+ *   center pixel, from the variance of its samples. A pixel whose samples
+ *   agree (flat surface, inside a checker cell) keeps its value; one whose
+ *   samples disagree (an edge, the horizon, a rough reflection) averages with
+ *   the similar pixels around it. The variance is filtered along with the
+ *   color, so the wider passes see the reduced noise.
+ *
+ * Rows are spread over the threads; each iteration reads one buffer and writes
+ * the other.
+ */
+class Denoiser {
+public:
+    /// Depth difference, in units of the predicted one, at which a tap weighs e^-1
+    static constexpr float DEPTH_SIGMA = 1.0f;
+
+    /// Relative depth tolerance added to the prediction, so flat-on surfaces (zero slope) still blur
+    static constexpr float DEPTH_EPSILON = 1e-3f;
+
+    /// Luminance tolerance added to the standard error, so noise-free pixels keep exact matches only
+    static constexpr float LUMINANCE_EPSILON = 1e-3f;
+
+    /**
+     * @param iterations Passes of the à-trous filter, step 2^i at pass i
+     * @param luminanceSigma Luminance difference, in standard errors of the center pixel, at which a tap weighs e^-1
+     */
+    Denoiser(int iterations, float luminanceSigma);
+
+    /**
+     * @brief Filters the image in place
+     * @param image Radiance framebuffer, before Image::WriteFile
+     * @param guides Auxiliary buffers of the same size
+     * @param variances Squared standard error of each pixel's mean luminance, clamped to 1
+     *                  (AntiAliasing::PixelSamples::SquaredStandardError), row-major
+     * @param numThreads Threads filtering the rows
+     */
+    void Apply(Image& image, const DenoiseGuides& guides, const std::vector<float>& variances,
+               unsigned numThreads) const;
+
+private:
+    int iterations_;
+    float luminanceSigma_;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Shape.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct EdgeStats
+ * @brief Counters of one edge-detected render
+ */
+struct EdgeStats {
+    PathStats paths;               // Over every sample of both passes
+    long long samples = 0;         // Camera rays
+    long long edgePixels = 0;      // Pixels supersampled by the second pass
+    long long coveragePixels = 0;  // Edge pixels resolved by the coverage of a sphere silhouette instead
+};
+
+/**
+ * @class EdgeRenderer
+ * @brief Two-pass anti-aliasing driven by a geometry buffer ("edge" renderer)
+ *
+ * Our scenes are a few large, smooth spheres and cubes on a plane: only a small
+ * share of the pixels holds an edge. The first pass traces one ray through the
+ * center of each pixel and records what it sees (SurfaceId). The second pass
+ * supersamples with the full grid of SamplePixel only the pixels that differ
+ * from a 4-neighbor, and keeps the single sample everywhere else. Near the
+ * horizon the floor cells shrink below two pixels and neighbors may see the
+ * same cell by chance, so there the floor is always supersampled.
+ *
+ * With "coverageAA", an edge pixel where a single non-reflective sphere
+ * stands against a single other surface skips the grid (a mirror sphere
+ * turns to its reflections at the limb, which one ray would miss). The center and its 4-neighbors must
+ * split into samples of that sphere, inside its silhouette cone, and samples
+ * of one other surface outside it. The silhouette is then a straight line
+ * across the pixel (the cone is linearized from its value at the center and
+ * corners, and pixels where it bends are left to the grid): its exact share
+ * of the pixel area weights the center sample and one more ray, traced at
+ * the centroid of the other side. A pixel the line does not cross keeps its
+ * center sample alone.
+ */
+class EdgeRenderer {
+public:
+    /// Neighbors whose normals are further apart than this cosine (about 25 degrees) make an edge
+    static constexpr float NORMAL_EDGE_COS = 0.9f;
+    /// coverageAA: a silhouette further than this from a straight line across the pixel, in pixels, takes the grid
+    static constexpr float MAX_BEND = 0.02f;
+    /// coverageAA: below this share of the pixel, the other side of the silhouette is not traced
+    static constexpr float MIN_COVERAGE = 0.001f;
+
+    /**
+     * @struct SurfaceId
+     * @brief First-pass record of one pixel
+     *
+     * The shape and the floor checker cell seen by the camera ray, its normal,
+     * and on a reflective surface the shape and cell seen by the reflected ray:
+     * a reflection edge on a mirror sphere is as visible as a silhouette.
+     */
+    struct SurfaceId {
+        const Shape* shape = nullptr;      // nullptr: background
+        int cell = 0;                      // Ray::CheckerCell on the plane, 0 elsewhere
+        Vec3 normal;
+        const Shape* reflected = nullptr;  // Shape hit by the reflected ray, nullptr if none or not reflective
+        int reflectedCell = 0;
+        bool undersampled = false;         // Floor cells smaller than two pixels here
+
+        /// Whether an edge runs between two pixels
+        bool DiffersFrom(const SurfaceId& other) const
+        {
+            return undersampled || shape != other.shape || cell != other.cell
+                || reflected != other.reflected || reflectedCell != other.reflectedCell
+                || (shape != nullptr && dot(normal, other.normal) < NORMAL_EDGE_COS);
+        }
+    };
+
+    /**
+     * @struct Coverage
+     * @brief A pixel cut in two by a straight edge
+     */
+    struct Coverage {
+        float inside = 0.0f;                     // Share of the pixel area on the inside
+        float insideX = 0.0f, insideY = 0.0f;    // Centroid of the inside part, from the pixel center
+        float outsideX = 0.0f, outsideY = 0.0f;  // Centroid of the outside part
+    };
+
+    /// Cuts the unit pixel by the line g0 + gx * dx + gy * dy = 0, (dx, dy) from its center; inside is g > 0
+    static Coverage PixelCoverage(float g0, float gx, float gy);
+
+    /**
+     * @param scene Scene to trace against
+     * @param antiAliasing Sub-pixel grid used on the edge pixels (same samples as SamplePixel)
+     */
+    EdgeRenderer(const Scene& scene, const AntiAliasing& antiAliasing);
+
+    /**
+     * @brief Renders every pixel of the image
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads of each pass
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     * @param sampleCounts Optional, resized to width * height and filled with the samples of each pixel (row-major)
+     */
+    EdgeStats Render(Image& image,
+                     const Vec3& camOrigin,
+                     const Vec3& lowerLeftCorner,
+                     const Vec3& horizontal,
+                     const Vec3& vertical,
+                     unsigned numThreads,
+                     const LightTiles* lightTiles = nullptr,
+                     std::vector<int>* sampleCounts = nullptr) const;
+
+private:
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Selects the math used by shading: the exact std:: functions or the
+ * approximations of the FastMath namespace
+ */
+enum class MathMode {
+    Exact,
+    Fast
+};
+
+/**
+ * Fast approximations of the transcendental functions used by shading
+ * (procedural textures, specular lobe). Errors below are measured bounds,
+ * checked by tests/units/test_fastmath.cpp.
+ */
+namespace FastMath {
+    constexpr float PI = 3.14159265358979f;
+    constexpr float HALF_PI = 1.57079632679490f;
+    constexpr float INV_TWO_PI = 0.159154943091895f;
+    // 2*pi split in two (Cody-Waite) so k * 2*pi is subtracted without losing the low bits
+    constexpr float TWO_PI_HI = 6.28125f;
+    constexpr float TWO_PI_LO = 1.93530717958647692e-3f;
+
+    // floor() without the libm call (roundss needs SSE4.1, which the default build does not assume)
+    inline int FloorToInt(float x) {
+        const int i = static_cast<int>(x);
+        return i - (x < static_cast<float>(i) ? 1 : 0);
+    }
+
+    // Reduces x to [-pi, pi]
+    inline float ReduceAngle(float x) {
+        const float k = static_cast<float>(FloorToInt(x * INV_TWO_PI + 0.5f));
+        return (x - k * TWO_PI_HI) - k * TWO_PI_LO;
+    }
+
+    // Odd degree-7 minimax polynomial on [-pi/2, pi/2] (max absolute error 6e-7)
+    inline float SinPoly(float x) {
+        const float x2 = x * x;
+        return x * (9.999966191e-1f + x2 * (-1.666482923e-1f + x2 * (8.306331424e-3f + x2 * -1.836378815e-4f)));
+    }
+
+    /**
+     * Sine by range reduction to [-pi/2, pi/2] and an odd degree-7 polynomial.
+     * Max absolute error: 8e-7 for |x| <= 1e4 (the range of the texture seeds). Valid for |x| < 1e6.
+     */
+    inline float Sin(float x) {
+        x = ReduceAngle(x);
+
+        // sin(x) = sin(pi - x) folds [-pi, pi] onto [-pi/2, pi/2]
+        if (x > HALF_PI) x = PI - x;
+        else if (x < -HALF_PI) x = -PI - x;
+
+        return SinPoly(x);
+    }
+
+    /**
+     * Cosine as sin(pi/2 - |x|) after the same range reduction.
+     * Max absolute error: 8e-7 for |x| <= 1e4. Valid for |x| < 1e6.
+     */
+    inline float Cos(float x) {
+        return SinPoly(HALF_PI - std::fabs(ReduceAngle(x)));
+    }
+
+    /**
+     * 2^x: integer part in the exponent bits, fraction in [-0.5, 0.5] by a degree-5 minimax polynomial.
+     * Max relative error: 2e-7. x is clamped to [-126, 127] so the result stays a normal float.
+     */
+    inline float Exp2(float x) {
+        x = x < -126.0f ? -126.0f : (x > 127.0f ? 127.0f : x);
+        const int i = FloorToInt(x + 0.5f);
+        const float f = x - static_cast<float>(i);
+
+        float p = 1.000000072f + f * (6.931469669e-1f + f * (2.402211974e-1f + f * (5.550713513e-2f
+                + f * (9.675540717e-3f + f * 1.327639465e-3f))));
+
+        const std::uint32_t bits = static_cast<std::uint32_t>(i + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return p * scale;
+    }
+
+    /**
+     * log2(x) for x > 0: exponent bits plus a degree-7 minimax polynomial in (m - 1) for the
+     * mantissa m in [sqrt(1/2), sqrt(2)) (no division).
+     * Max absolute error: 1.5e-6 on [1e-6, 10], mostly the float rounding of the result;
+     * elsewhere relative 1e-7. Denormals and x <= 0 are not supported.
+     */
+    inline float Log2(float x) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        int e = static_cast<int>((bits >> 23) & 0xff) - 127;
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+
+        if (m > 1.41421356f) {
+            m *= 0.5f;
+            e += 1;
+        }
+
+        const float t = m - 1.0f;
+        const float p = t * (1.442699730f + t * (-7.213758599e-1f + t * (4.804647495e-1f + t * (-3.589625030e-1f
+                      + t * (2.972673171e-1f + t * (-2.726921609e-1f + t * 1.706097962e-1f))))));
+        return static_cast<float>(e) + p;
+    }
+
+    /**
+     * x^y for x >= 0 as Exp2(y * Log2(x)); returns 0 for x <= 0.
+     * Max relative error: 2e-6 on [1e-6, 1] for the texture exponents (0.6 and 1.4); in general
+     * about 3e-7 + |y * log2(x)| * 1e-7.
+     */
+    inline float Pow(float x, float y) {
+        if (x <= 0.0f) return 0.0f;
+        return Exp2(y * Log2(x));
+    }
+
+    /**
+     * x^N by exponentiation by squaring: ceil(log2 N) + popcount(N) - 1 multiplications.
+     * Each squaring doubles the relative error of its input: max relative error about
+     * (N - 1) * 6e-8, i.e. 4e-6 for N = 64 (for results above the denormal range).
+     */
+    template <unsigned N>
+    constexpr float PowInt(float x) {
+        if constexpr (N == 0) {
+            return 1.0f;
+        } else {
+            const float half = PowInt<N / 2>(x);
+            if constexpr (N % 2 == 0) return half * half;
+            else return half * half * x;
+        }
+    }
+
+    /**
+     * Runtime exponent version of PowInt<N>, same error bound
+     */
+    inline float PowInt(float x, unsigned n) {
+        float result = 1.0f;
+        while (n) {
+            if (n & 1u) result *= x;
+            x *= x;
+            n >>= 1;
+        }
+        return result;
+    }
+
+    // Mode-selected variants used by shading
+
+    inline float Sin(float x, MathMode mode) {
+        return mode == MathMode::Fast ? Sin(x) : std::sin(x);
+    }
+
+    inline float Cos(float x, MathMode mode) {
+        return mode == MathMode::Fast ? Cos(x) : std::cos(x);
+    }
+
+    inline float Pow(float x, float y, MathMode mode) {
+        return mode == MathMode::Fast ? Pow(x, y) : std::pow(x, y);
+    }
+
+    template <unsigned N>
+    inline float PowInt(float x, MathMode mode) {
+        return mode == MathMode::Fast ? PowInt<N>(x) : std::pow(x, static_cast<float>(N));
+    }
+}
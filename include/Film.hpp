@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "Image.hpp"
+#include "Radiance.hpp"
+
+/// Reconstruction filter of the film ("pixelFilter" render setting)
+enum class PixelFilter {
+    Box,            // Samples average into the pixel they fall in (historical SamplePixel)
+    Gaussian,       // exp(-x² / 2σ²), σ = 0.5 pixel, shifted to reach 0 at the radius
+    Mitchell,       // Mitchell-Netravali cubic, B = C = 1/3; small negative lobes sharpen
+    BlackmanHarris  // 4-term Blackman-Harris window, smooth with very low side lobes
+};
+
+/**
+ * @class ReconstructionFilter
+ * @brief Separable weight of a sample for a pixel, as a function of their distance
+ *
+ * Weight(dx, dy) = Weight1D(dx) * Weight1D(dy), zero beyond the radius along
+ * either axis. The weights are not normalized: the film divides by their sum.
+ * Weight1D interpolates a table of the closed form: the box stays exact, the
+ * others are within about 1e-4 of it.
+ */
+class ReconstructionFilter {
+public:
+    /**
+     * @param type Filter shape
+     * @param radius Half-width in pixels; 0 for the default of the shape (box 0.5, Gaussian 1.5, Mitchell and Blackman-Harris 2)
+     * @throws std::invalid_argument if radius is negative or above MAX_RADIUS
+     */
+    explicit ReconstructionFilter(PixelFilter type = PixelFilter::Box, float radius = 0.0f);
+
+    /// Largest accepted radius in pixels; bounds the footprint of a splat
+    static constexpr float MAX_RADIUS = 8.0f;
+
+    /// Entries of the weight table over [0, radius]
+    static constexpr int TABLE_SIZE = 256;
+
+    /// Weight of a sample dx pixels away along one axis, interpolated in the precomputed table
+    float Weight1D(float dx) const
+    {
+        const float x = std::abs(dx) * tableScale_;
+        if (x > static_cast<float>(TABLE_SIZE))
+            return 0.0f;
+        const int k = std::min(static_cast<int>(x), TABLE_SIZE - 1);
+        const float t = x - static_cast<float>(k);
+        return table_[k] + (table_[k + 1] - table_[k]) * t;
+    }
+
+    /// Weight of a sample dx pixels away along one axis, from the closed form (the table is built from it)
+    float Evaluate1D(float dx) const;
+
+    float Weight(float dx, float dy) const { return Weight1D(dx) * Weight1D(dy); }
+
+    PixelFilter GetType() const { return type_; }
+    float GetRadius() const { return radius_; }
+
+    /// Default half-width of a filter shape in pixels
+    static float DefaultRadius(PixelFilter type);
+
+private:
+    PixelFilter type_;
+    float radius_;
+    float invRadius_;
+    float gaussianFloor_;   // exp(-r² / 2σ²), subtracted so the Gaussian reaches 0 at the radius
+    float tableScale_;      // TABLE_SIZE / radius
+    std::array<float, TABLE_SIZE + 1> table_;   // Evaluate1D at k * radius / TABLE_SIZE; a splat evaluates
+                                                // about 2 * (2 * radius + 1) weights, the cosines would dominate
+};
+
+/**
+ * @class FilmTile
+ * @brief Private accumulation buffer of one block of pixels
+ *
+ * A tile owns the samples generated in its pixels, but a sample splats into
+ * every pixel within the filter radius, so the buffer extends past the block
+ * by the radius on each side. Each tile is written by a single thread; tiles
+ * meet only in Film::MergeTile.
+ */
+class FilmTile {
+public:
+    /**
+     * @param x0 First pixel column whose samples the tile receives
+     * @param y0 First pixel row
+     * @param x1 One past the last column
+     * @param y1 One past the last row
+     * @param filter Filter of the film
+     * @param width Image width, the buffer is clipped to the image
+     * @param height Image height
+     */
+    FilmTile(int x0, int y0, int x1, int y1, const ReconstructionFilter& filter, int width, int height);
+
+    /**
+     * @brief Adds a sample to every pixel its filter reaches
+     * @param filmX Sample position in pixels, pixel i spans [i, i + 1)
+     * @param filmY Sample position in pixels, pixel j spans [j, j + 1)
+     * @param radiance Radiance of the sample
+     */
+    void AddSample(float filmX, float filmY, const Radiance& radiance);
+
+private:
+    friend class Film;
+
+    const ReconstructionFilter& filter_;
+    int bufferX0_, bufferY0_;     // First pixel of the buffer, in image coordinates
+    int bufferWidth_, bufferHeight_;
+    std::vector<Radiance> sums_;  // Weighted radiance
+    std::vector<float> weights_;  // Sum of the weights
+};
+
+/**
+ * @class Film
+ * @brief Image plane that reconstructs pixels from splatted samples
+ *
+ * Decouples the samples from the pixels: a renderer traces the samples of a
+ * block into a FilmTile, then merges it. Each pixel ends up as the
+ * weighted sum of the samples around it divided by the sum of their weights.
+ */
+class Film {
+public:
+    Film(int width, int height, const ReconstructionFilter& filter);
+
+    /// Tile of the pixels [x0, x1) x [y0, y1) for this film
+    FilmTile MakeTile(int x0, int y0, int x1, int y1) const;
+
+    /// Adds a tile's sums to the film; not thread-safe, called by one thread at a time
+    void MergeTile(const FilmTile& tile);
+
+    /// Writes every pixel to the image; negative lobes may undershoot, results are clamped at 0
+    void Resolve(Image& image) const;
+
+    const ReconstructionFilter& GetFilter() const { return filter_; }
+
+private:
+    int width_, height_;
+    ReconstructionFilter filter_;
+    std::vector<Radiance> sums_;
+    std::vector<float> weights_;
+};
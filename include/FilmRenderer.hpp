@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AntiAliasing.hpp"
+#include "Film.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct FilmStats
+ * @brief Counters of one filtered render
+ */
+struct FilmStats {
+    PathStats paths;             // Over every sample
+    long long samples = 0;       // Camera rays
+    long long tiles = 0;         // Film tiles traced and merged
+};
+
+/**
+ * @class FilmRenderer
+ * @brief Traces the samples of each tile and splats them through a reconstruction filter ("film" renderer)
+ *
+ * SamplePixel averages the samples that fall in a pixel (a box filter of
+ * one pixel). Here each sample weighs on every pixel within the filter
+ * radius, neighbors included, so a wider and smoother filter spends the same
+ * rays on softer, less aliased edges.
+ *
+ * The image is cut into LightTiles::TILE_SIZE² tiles handed out to the
+ * threads one at a time. A thread traces the samples of its tile (the same
+ * positions and path seeds as SamplePixel) into a private FilmTile that
+ * extends past the tile by the filter radius. Tiles are merged into the film
+ * in tile order, each as soon as every tile before it is, under a lock: no
+ * two threads ever write the film at once, the result does not depend on the
+ * scheduling, and only the tiles waiting for a slower one are held.
+ */
+class FilmRenderer {
+public:
+    /**
+     * @param scene Scene to trace against
+     * @param antiAliasing Sample positions and count per pixel
+     * @param filter Reconstruction filter of the film
+     */
+    FilmRenderer(const Scene& scene, const AntiAliasing& antiAliasing, const ReconstructionFilter& filter);
+
+    /**
+     * @brief Renders every pixel of the image
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads tracing the tiles
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     */
+    FilmStats Render(Image& image,
+                     const Vec3& camOrigin,
+                     const Vec3& lowerLeftCorner,
+                     const Vec3& horizontal,
+                     const Vec3& vertical,
+                     unsigned numThreads,
+                     const LightTiles* lightTiles = nullptr) const;
+
+private:
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+    ReconstructionFilter filter_;
+};
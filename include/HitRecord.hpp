@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Vec3A.hpp"
+
+class Shape;
+
+/**
+ * @struct HitRecord
+ * @brief Closest intersection found for a ray, with the data shading needs
+ */
+struct HitRecord {
+    const Shape* shape = nullptr;  // nullptr if the ray escapes
+    float t = 0.0f;                // Distance along the ray
+    Vec3A point;                   // Hit position
+    Vec3A normal;                  // Unit surface normal at the hit
+    float footprint = 0.0f;        // Width of the ray cone on the surface, 0 for a point sample
+    float curvature = 0.0f;        // 1 / radius on spheres, 0 on flat surfaces
+};
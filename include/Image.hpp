@@ -3,24 +3,44 @@
 #include <iostream>
 #include <vector>
 #include "Color.hpp"
+#include "Radiance.hpp"
+
+// Courbe de transfert appliquée par WriteFile lors de la quantification en 8 bits
+enum class TransferCurve
+{
+    Linear,  // floor(v * 255), valeurs écrites telles quelles
+    SRGB,    // Encodage sRGB (IEC 61966-2-1)
+    Gamma22  // Puissance 1/2.2
+};
+
+// Opérateur de tone mapping appliqué par WriteFile à la radiance linéaire, avant la courbe de transfert
+enum class ToneMapOperator
+{
+    Clamp,     // Valeurs hors de [0, 1] simplement bornées (rendu historique)
+    Reinhard,  // x / (1 + x), par canal
+    ACES       // Approximation ACES filmique (Narkowicz 2015), par canal
+};
 
 class Image
 {
 private:
     unsigned int width = 1920;
     unsigned int height = 1080;
-    std::vector<Color> buffer;
+    std::vector<Radiance> buffer;  // Radiance linéaire non bornée
 
 public:
     Image(unsigned int w, unsigned int h);
-    Image(unsigned int w, unsigned int h, Color c);
+    Image(unsigned int w, unsigned int h, Radiance c);
     ~Image();
 
-    void SetPixel(unsigned int x, unsigned int y, Color color);
-    Color GetPixel(unsigned int x, unsigned int y);
+    void SetPixel(unsigned int x, unsigned int y, Radiance color);
+    Radiance GetPixel(unsigned int x, unsigned int y) const;
 
     int GetWidth();
     int GetHeight();
 
-    void WriteFile(const char *filename) const;
+    // Seule étape qui ramène la radiance dans [0, 1] : tone mapping, courbe de transfert puis
+    // quantification en PNG RGB 8 bits ; vectorisée et répartie par lignes sur les threads
+    void WriteFile(const char *filename, TransferCurve curve = TransferCurve::Linear,
+                   ToneMapOperator toneMap = ToneMapOperator::Clamp) const;
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include "CpuFeatures.hpp"
+
+/*
+ * Views over the packed scene geometry consumed by the kernels.
+ * Only raw pointers here: the kernel translation units are compiled with
+ * per-ISA flags and must not instantiate inline or STL code shared with the
+ * rest of the program (the linker would keep one copy, possibly the AVX-512 one).
+ */
+
+struct PackedSpheres {
+    const float* cx;
+    const float* cy;
+    const float* cz;
+    const float* radius2;     // Padding entries hold -inf so they never hit
+    const int* shapeIndex;
+    int count;
+    int paddedCount;          // Multiple of the widest kernel lane count
+};
+
+struct PackedBoxes {
+    const float* minX;
+    const float* minY;
+    const float* minZ;
+    const float* maxX;
+    const float* maxY;
+    const float* maxZ;
+    const int* shapeIndex;
+    int count;
+};
+
+struct PackedPlanes {
+    const float* px;
+    const float* py;
+    const float* pz;
+    const float* nx;
+    const float* ny;
+    const float* nz;
+    const int* shapeIndex;
+    int count;
+};
+
+struct PackedGeometry {
+    PackedSpheres spheres;
+    PackedBoxes boxes;
+    PackedPlanes planes;
+};
+
+/// Entries of the optional transfer-curve table taken by quantizeChannels
+constexpr int TRANSFER_LUT_SIZE = 4096;
+
+/**
+ * @struct KernelTable
+ * @brief Entry points of one ISA variant of the hot kernels
+ */
+struct KernelTable {
+    IsaLevel level;
+
+    /**
+     * @brief Closest intersection of a ray with the packed geometry
+     * @param geometry Packed spheres, boxes and planes
+     * @param origin Ray origin (x, y, z)
+     * @param direction Normalized ray direction (x, y, z)
+     * @param out_t Distance to the hit, only written on hit
+     * @return Index of the hit shape in the scene, or -1
+     */
+    int (*closestHit)(const PackedGeometry& geometry, const float origin[3], const float direction[3], float& out_t);
+
+    /**
+     * @brief Occlusion test of a shadow ray: stops at the first primitive found
+     * @param geometry Packed spheres, boxes and planes
+     * @param origin Ray origin (x, y, z)
+     * @param direction Normalized ray direction (x, y, z)
+     * @param max_t Only hits closer than this distance count (distance to the light)
+     * @return true if any primitive is hit in [0, max_t)
+     */
+    bool (*anyHit)(const PackedGeometry& geometry, const float origin[3], const float direction[3], float max_t);
+
+    /**
+     * @brief Converts float channel values to 8-bit
+     * @param values Channel values, nominally in [0, 1]; clamped
+     * @param out Output bytes, one per value
+     * @param count Number of values (3 per RGB pixel)
+     * @param lut Optional transfer table of TRANSFER_LUT_SIZE entries indexed by
+     *            round(v * (TRANSFER_LUT_SIZE - 1)); nullptr stores floor(v * 255)
+     */
+    void (*quantizeChannels)(const float* values, unsigned char* out, std::size_t count, const unsigned char* lut);
+};
+
+namespace Kernels {
+    /**
+     * Kernel variant used by the renderer. Chosen on first call from the
+     * detected CPU level, or from the RAYTRACER_ISA environment variable
+     * ("scalar", "sse4.2", "avx2", "avx512") to force a level for benchmarking.
+     * Logs the selection once.
+     */
+    const KernelTable& Active();
+
+    /**
+     * Kernel variant compiled for exactly this level
+     * @return nullptr if that variant is not part of this build
+     */
+    const KernelTable* ForLevel(IsaLevel level);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include "Vec3.hpp"
+#include "Color.hpp"
+#include "Radiance.hpp"
+
+enum class LightType {
+    Directional,    // Infinitely far away: same direction everywhere, never fades
+    Point           // Emits from a position, fades to zero at its range
+};
+
+/**
+ * @struct Light
+ * @brief Light source declared in the "lights" array of a scene file
+ *
+ * Surfaces are lit by every light that faces them (Blinn-Phong, see
+ * Ray::ShadeSurface). With the "shadows" render setting, each contribution is
+ * first checked with a shadow ray (Scene::Occluded).
+ */
+struct Light {
+    LightType type = LightType::Directional;
+
+    /// Directional: unit direction the light travels in
+    Vec3 direction = Vec3(0.0f, 1.0f, 0.0f);
+
+    /// Point: position of the light
+    Vec3 position;
+
+    /// Color times intensity, may exceed 1
+    Radiance emission = Radiance(1.0f, 1.0f, 1.0f);
+
+    /// Point: distance at which the light has faded to zero, as (1 - (d / range)²)²; infinite means no falloff
+    float range = std::numeric_limits<float>::infinity();
+
+    static Light Directional(const Vec3& direction, const Color& color = Color(1.0f, 1.0f, 1.0f), float intensity = 1.0f)
+    {
+        Light light;
+        light.type = LightType::Directional;
+        light.direction = normalize(direction);
+        light.emission = Radiance(color) * intensity;
+        return light;
+    }
+
+    static Light Point(const Vec3& position, float range, const Color& color = Color(1.0f, 1.0f, 1.0f), float intensity = 1.0f)
+    {
+        Light light;
+        light.type = LightType::Point;
+        light.position = position;
+        light.range = range;
+        light.emission = Radiance(color) * intensity;
+        return light;
+    }
+
+    /// Lighting of scenes that declare no lights: the historical white light from above, slightly behind
+    static std::vector<Light> Defaults()
+    {
+        return {Directional(Vec3(0.0f, 1.0f, -0.3f))};
+    }
+};
+
+/**
+ * @struct LightSet
+ * @brief Indices into Scene::GetLights() of the lights to evaluate at a shading point
+ */
+struct LightSet {
+    const int* indices = nullptr;
+    int count = 0;
+};
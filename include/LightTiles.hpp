@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include "Light.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @class LightTiles
+ * @brief Per-tile light lists for the camera hits, built once per frame
+ *
+ * The image is cut into TILE_SIZE² pixel tiles. Every camera sample of a tile
+ * travels inside the pyramid from the camera through the tile's corners on
+ * the image plane, so its first hit does too: a point light whose range
+ * sphere lies entirely outside that pyramid contributes exactly nothing there
+ * and is left out of the tile's list. Directional lights and point lights
+ * without a range reach everything and are in every list.
+ *
+ * Only the first hit of a path may use these lists; reflected rays leave the
+ * pyramid and are shaded with Scene::AllLights().
+ */
+class LightTiles {
+public:
+    static constexpr int TILE_SIZE = 16;
+
+    /**
+     * @param lights Lights of the scene (Scene::GetLights())
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     */
+    LightTiles(const std::vector<Light>& lights, int width, int height,
+               const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+               const Vec3& horizontal, const Vec3& vertical);
+
+    /// Lights that can reach the first hit of any sample of this pixel
+    LightSet ForPixel(int pixelX, int pixelY) const
+    {
+        const int tile = (pixelY / TILE_SIZE) * tilesX_ + pixelX / TILE_SIZE;
+        return {indices_.data() + offsets_[tile], offsets_[tile + 1] - offsets_[tile]};
+    }
+
+    /// Average length of the tile lists, against GetLightCount() without culling
+    double AverageLightsPerTile() const;
+    int GetLightCount() const { return lightCount_; }
+
+private:
+    int tilesX_;
+    int tilesY_;
+    int lightCount_;
+    std::vector<int> offsets_;   // Tile t owns indices_[offsets_[t] .. offsets_[t + 1])
+    std::vector<int> indices_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "RenderSettings.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct PreviewStats
+ * @brief Counters of one preview render
+ */
+struct PreviewStats {
+    PathStats paths;                  // Over every traced sample
+    long long tracedPixels = 0;       // Pixels of the pattern, plus the fallbacks
+    long long interpolatedPixels = 0; // Pixels rebuilt from their neighbors
+    long long fallbackPixels = 0;     // Missing pixels with no neighbor on their surface, traced after all
+    double guideMs = 0.0;             // Time of the shape-id pass
+};
+
+/**
+ * @class PreviewRenderer
+ * @brief Traces half the pixels and interpolates the others along edges ("preview" renderer)
+ *
+ * A shape-id pass first sends one ray through every pixel center, intersection
+ * only (no shading, no reflection), and keeps the shape hit and, on the
+ * floor, the checker cell. The pixels of the pattern, a checkerboard or the
+ * even rows, are then traced as usual with SamplePixel. Each missing pixel is
+ * rebuilt from the pairs of traced neighbors across it: left-right and
+ * up-down on the checkerboard, up-down and both diagonals between interlaced
+ * rows. Only pairs whose two ends see the pixel's own surface count, and of
+ * those the one with the smallest luminance difference wins, the direction
+ * that runs along the edge rather than across it. Without such a pair, the
+ * neighbors on the same surface are averaged; a pixel with none (a shape or a
+ * floor cell edge thinner than a pixel, which interlacing would lose) is
+ * traced.
+ */
+class PreviewRenderer {
+public:
+    /**
+     * @param scene Scene to trace against
+     * @param antiAliasing Sample pattern of the traced pixels (same samples as SamplePixel)
+     * @param pattern Pixels to trace, not Off
+     */
+    PreviewRenderer(const Scene& scene, const AntiAliasing& antiAliasing, PreviewPattern pattern);
+
+    /// Whether the pattern traces pixel (x, y)
+    static bool IsTraced(PreviewPattern pattern, int x, int y)
+    {
+        return pattern == PreviewPattern::Interlaced ? y % 2 == 0 : (x + y) % 2 == 0;
+    }
+
+    /**
+     * @brief Renders every pixel of the image
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads of each pass
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     */
+    PreviewStats Render(Image& image,
+                        const Vec3& camOrigin,
+                        const Vec3& lowerLeftCorner,
+                        const Vec3& horizontal,
+                        const Vec3& vertical,
+                        unsigned numThreads,
+                        const LightTiles* lightTiles = nullptr) const;
+
+private:
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+    PreviewPattern pattern_;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct ProgressiveStats
+ * @brief Counters of one progressive render
+ */
+struct ProgressiveStats {
+    PathStats paths;                 // Over every pass
+    long long samples = 0;           // Camera rays
+    std::vector<int> passSamples;    // Samples per pixel at the end of each pass
+    std::vector<double> passMs;      // Time at the end of each pass, from the start of the render
+    int snapshots = 0;               // Intermediate images written, failed ones not counted
+};
+
+/**
+ * @class ProgressiveRenderer
+ * @brief Renders in passes of growing sample counts, writing the image along the way ("progressive" renderer)
+ *
+ * Pass k brings every pixel to 4^k samples (1, 4, 16, ...), the last one to
+ * the full count of the AntiAliasing. Each pass continues the pixel's samples
+ * with AntiAliasing::AddSamples, so no ray is traced twice and the final
+ * image holds the same samples as a single-pass render; the stratified order
+ * of AddSamples spreads every prefix over the whole pixel.
+ *
+ * The image so far is written to a snapshot file after each pass
+ * (progressiveDumpSeconds = 0) or every progressiveDumpSeconds seconds, mid
+ * pass included: the rows already done show the new pass, the others the
+ * previous one. Workers copy each finished row into a preview under a mutex;
+ * the thread whose row crosses the dump time copies the preview and encodes
+ * it, to a temporary file renamed over the snapshot so that a viewer never
+ * reads half a PNG. A snapshot that cannot be written is reported on the
+ * error stream and skipped; the render goes on. The snapshot file is left in
+ * place: removing it once the final image is written is up to the caller.
+ */
+class ProgressiveRenderer {
+public:
+    /**
+     * @param scene Scene to trace against; dump interval, transfer curve and tone mapping come from its settings
+     * @param antiAliasing Sample pattern, its count is the samples of the last pass
+     */
+    ProgressiveRenderer(const Scene& scene, const AntiAliasing& antiAliasing);
+
+    /**
+     * @brief Sample counts of the passes: 1, 4, 16, ... then totalSamples
+     * @param totalSamples Samples per pixel of the finished image
+     */
+    static std::vector<int> PassSamples(int totalSamples);
+
+    /**
+     * @brief Renders every pixel of the image, pass after pass
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads of each pass
+     * @param snapshotFile PNG rewritten with the image so far; empty for none
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     */
+    ProgressiveStats Render(Image& image,
+                            const Vec3& camOrigin,
+                            const Vec3& lowerLeftCorner,
+                            const Vec3& horizontal,
+                            const Vec3& vertical,
+                            unsigned numThreads,
+                            const std::string& snapshotFile,
+                            const LightTiles* lightTiles = nullptr) const;
+
+private:
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+};
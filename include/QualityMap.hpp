@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/// Rectangle of the image with its own quality ("qualityRegions" render setting), in fractions of the image size
+struct QualityRegion {
+    float x = 0.0f;         // Left edge, 0 at the left of the image
+    float y = 0.0f;         // Top edge, 0 at the top of the image
+    float width = 1.0f;
+    float height = 1.0f;
+    float quality = 1.0f;   // In [0, 1]
+};
+
+/**
+ * @class QualityMap
+ * @brief Quality in [0, 1] of every pixel, which scales its samples and reflection depth
+ *
+ * Built from a grayscale PNG (black 0, white 1) stretched over the image with
+ * nearest-pixel lookup, or from a uniform default; the regions are painted
+ * over it in order, the last one winning where they overlap.
+ *
+ * Quality q gives a pixel round(q * samples) camera samples and paths of
+ * round(q * maxDepth) segments, at least one of each: full quality is the
+ * uniform render, and the cheapest pixels still get a primary ray.
+ */
+class QualityMap {
+public:
+    /**
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param quality Quality of every pixel before the regions
+     */
+    QualityMap(int width, int height, float quality = 1.0f);
+
+    /**
+     * @brief Map of a render from its settings
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param mapFile Grayscale PNG, any size; empty to start from defaultQuality
+     * @param regions Rectangles painted over, in order
+     * @param defaultQuality Quality outside the regions when there is no PNG
+     * @throws std::runtime_error if the PNG cannot be read
+     */
+    static QualityMap Build(int width, int height, const std::string& mapFile,
+                            const std::vector<QualityRegion>& regions, float defaultQuality);
+
+    /// Sets the quality of the pixels whose centers fall in the region
+    void Paint(const QualityRegion& region);
+
+    float At(int x, int y) const { return quality_[static_cast<std::size_t>(y) * width_ + x]; }
+
+    /// Camera samples of a pixel out of the full count, in [1, totalSamples]
+    int Samples(int x, int y, int totalSamples) const;
+
+    /// Path length of a pixel out of the full depth, in [1, maxDepth]
+    int Depth(int x, int y, int maxDepth) const;
+
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+
+private:
+    int width_;
+    int height_;
+    std::vector<float> quality_;   // Row-major, row 0 at the top like the image
+};
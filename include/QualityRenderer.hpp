@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "QualityMap.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct QualityStats
+ * @brief Counters of one render through a quality map
+ */
+struct QualityStats {
+    PathStats paths;                  // Over every sample
+    long long samples = 0;            // Camera rays traced
+    long long uniformSamples = 0;     // Camera rays of the uniform render, full count everywhere
+    long long uniformRays = 0;        // Segments of the uniform render, extrapolated from each pixel's own paths
+};
+
+/**
+ * @class QualityRenderer
+ * @brief Spends the samples and reflection depth where the quality map asks for them ("quality" renderer)
+ *
+ * Each pixel gets QualityMap::Samples of the AntiAliasing samples, in the
+ * stratified order of AntiAliasing::AddSamples, and traces them against the
+ * view whose maxDepth is QualityMap::Depth. The views differ by maxDepth only;
+ * the last one is the full-depth scene.
+ *
+ * The rays saved are counted against a uniform render: its camera rays are
+ * exact, its segments are extrapolated pixel by pixel from the paths traced
+ * there (segments per sample times the full count). For pixels with a shorter
+ * depth this leaves out the bounces they skipped, so the saving reported is
+ * a lower bound.
+ */
+class QualityRenderer {
+public:
+    /**
+     * @param depthViews depthViews[d - 1] traces paths of at most d segments, d = 1 .. maxDepth
+     * @param antiAliasing Sample pattern, its count is what full quality gets
+     * @param map Quality of every pixel, same size as the image
+     */
+    QualityRenderer(const std::vector<const Scene*>& depthViews, const AntiAliasing& antiAliasing, const QualityMap& map);
+
+    /**
+     * @brief Renders every pixel of the image
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads rendering the rows
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     * @param sampleCounts Optional, resized to width * height and filled with the samples of each pixel (row-major)
+     */
+    QualityStats Render(Image& image,
+                        const Vec3& camOrigin,
+                        const Vec3& lowerLeftCorner,
+                        const Vec3& horizontal,
+                        const Vec3& vertical,
+                        unsigned numThreads,
+                        const LightTiles* lightTiles = nullptr,
+                        std::vector<int>* sampleCounts = nullptr) const;
+
+private:
+    std::vector<const Scene*> depthViews_;
+    const AntiAliasing& antiAliasing_;
+    const QualityMap& map_;
+};
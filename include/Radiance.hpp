@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iostream>
+#include "Color.hpp"
+
+/**
+ * @class Radiance
+ * @brief Unclamped linear RGB used for every internal accumulation
+ *
+ * Unlike Color, nothing here clamps: shading, reflection mixing, sample
+ * averaging and the framebuffer all keep values above 1 (highlights, boosted
+ * roulette paths). The only mapping to [0, 1] is the tone-mapping stage of
+ * Image::WriteFile. Color stays the type of the material albedos.
+ */
+class Radiance {
+private:
+    float r = 0.0f;
+    float g = 0.0f;
+    float b = 0.0f;
+
+public:
+    Radiance() = default;
+    Radiance(float r_, float g_, float b_) : r(r_), g(g_), b(b_) {}
+    Radiance(const Color& c) : r(c.R()), g(c.G()), b(c.B()) {}
+
+    float R() const { return r; }
+    float G() const { return g; }
+    float B() const { return b; }
+
+    Radiance operator+(const Radiance& o) const { return {r + o.r, g + o.g, b + o.b}; }
+    Radiance operator-(const Radiance& o) const { return {r - o.r, g - o.g, b - o.b}; }
+    Radiance operator*(float s)           const { return {r * s, g * s, b * s}; }
+    Radiance operator*(const Radiance& o) const { return {r * o.r, g * o.g, b * o.b}; }
+
+    Radiance& operator+=(const Radiance& o) { r += o.r; g += o.g; b += o.b; return *this; }
+
+    /// Clamped copy, for code that still needs a displayable Color
+    Color ToColor() const { return Color(r, g, b); }
+
+    friend std::ostream& operator<<(std::ostream& os, const Radiance& c) {
+        os << "Radiance(" << c.r << ", " << c.g << ", " << c.b << ")";
+        return os;
+    }
+};
@@ -1,10 +1,42 @@
 #pragma once
 
-#include "Vec3.hpp"
+#include "Vec3A.hpp"
+#include "HitRecord.hpp"
 #include "Color.hpp"
-#include "Shape.hpp"
-#include <vector>
-#include <memory>
+#include "Radiance.hpp"
+#include "Scene.hpp"
+#include "RenderSettings.hpp"
+#include <cstdint>
+
+/**
+ * Compteurs de chemins, cumulés par TraceScene quand ils sont demandés.
+ */
+struct PathStats {
+  long long rays = 0;        // Segments tracés (rayon primaire compris)
+  long long terminated = 0;  // Chemins arrêtés avant maxDepth par ContinuePath
+  long long shadowRays = 0;  // Tests d'occultation vers les lumières (réglage "shadows")
+
+  PathStats& operator+=(const PathStats& other)
+  {
+    rays += other.rays;
+    terminated += other.terminated;
+    shadowRays += other.shadowRays;
+    return *this;
+  }
+};
+
+/**
+ * Cône de rayon : approximation des différentielles de rayon (Amanatides,
+ * « ray cones »). Suit la largeur de l'empreinte d'un échantillon depuis la
+ * caméra et à travers les réflexions, pour que les textures se filtrent
+ * sur cette largeur.
+ */
+struct RayCone {
+  float width = 0.0f;   // Largeur du cône à l'origine du rayon
+  float spread = 0.0f;  // Angle d'ouverture en radians ; cône nul : échantillon ponctuel
+
+  float WidthAt(float t) const { return width + spread * t; }
+};
 
 /**
  * Représente un rayon lumineux dans l'espace 3D pour le raytracing.
@@ -18,29 +50,114 @@ public:
    * Construit un rayon avec une origine et une direction données.
    * @param origin Point de départ du rayon dans l'espace 3D
    * @param direction Vecteur directionnel du rayon (devrait être normalisé)
+   * @param cone Empreinte portée par le rayon, nulle par défaut (pas de filtrage)
    */
-  Ray(const Vec3 &origin, const Vec3 &direction);
+  Ray(const Vec3A &origin, const Vec3A &direction, const RayCone &cone = RayCone());
 
   /**
    * Lance le rayon à travers la scène et calcule la couleur résultante.
-   * Parcourt toutes les formes, trouve la plus proche intersectée,
-   * et retourne sa couleur avec ombrage. Retourne noir si aucune intersection.
-   * @param scene Liste des formes présentes dans la scène
-   * @return Couleur du pixel résultant du lancer de rayon
+   * Intégrateur itératif : une seule boucle suit le chemin réfléchi en portant
+   * son poids (produit des réflectivités), sans récursion ni clamp
+   * intermédiaire. Chaque surface ajoute sa couleur pondérée par
+   * poids * (1 - réflectivité) ; le fond reçoit le poids restant quand le rayon
+   * s'échappe, que maxDepth est atteint ou que la coupure déterministe arrête
+   * le chemin. Profondeur et arrêt viennent des réglages de la scène.
+   * @param scene Vue de la scène à parcourir
+   * @param pathSeed Graine du chemin pour la roulette russe (un nombre par échantillon)
+   * @param stats Compteurs à incrémenter, optionnel
+   * @param primaryLights Lumières de la tuile du pixel (LightTiles) pour le premier
+   *        impact ; les rebonds, qui partent n'importe où, utilisent toutes les lumières
+   * @param firstHit Premier impact du chemin, optionnel (shape à nullptr si le rayon
+   *        s'échappe), pour classer le pixel sans intersecter une seconde fois
+   * @return Radiance non bornée résultant du lancer de rayon
+   */
+  Radiance TraceScene(const Scene& scene, std::uint32_t pathSeed = 0, PathStats* stats = nullptr,
+                      const LightSet* primaryLights = nullptr, HitRecord* firstHit = nullptr) const;
+
+  /**
+   * Décide si un chemin continue après une réflexion, selon settings.termination.
+   * Coupure : s'arrête si throughput <= minThroughput (le fond estime le reste).
+   * Roulette : sous rouletteThreshold, survit avec la probabilité
+   * throughput / rouletteThreshold et son poids est divisé par cette probabilité ;
+   * sinon throughput passe à 0 (estimation sans biais).
+   * @param settings Réglages de rendu
+   * @param throughput Poids du chemin, ajusté par la roulette
+   * @param pathSeed Graine du chemin
+   * @param bounce Numéro du rebond (1 pour le premier rayon réfléchi)
+   * @return true si le rayon réfléchi doit être tracé
+   */
+  static bool ContinuePath(const RenderSettings& settings, float& throughput, std::uint32_t pathSeed, int bounce);
+
+  /**
+   * Cherche l'intersection la plus proche et remplit le point et la normale,
+   * la courbure et l'empreinte du cône sur la surface (largeur au point
+   * d'impact divisée par le cosinus d'incidence).
+   * @param scene Vue de la scène à parcourir
+   * @param hit Résultat, hit.shape vaut nullptr si le rayon s'échappe
+   * @return true si une forme est touchée
+   */
+  bool Intersect(const Scene& scene, HitRecord& hit) const;
+
+  /**
+   * Couleur de surface au point touché et part réfléchie (Fresnel pour les
+   * sphères et cubes, constante pour le plan). Partagé par TraceScene et le
+   * pipeline wavefront.
+   * Sphères et cubes : ambiant + Blinn-Phong sommé sur les lumières données.
+   * Le damier du plan n'est pas éclairé, mais s'assombrit vers l'ambiant
+   * dans l'ombre. Avec le réglage "shadows", chaque lumière tournée vers la
+   * surface et à sa portée est d'abord testée par un rayon d'ombre
+   * (Scene::Occluded, arrêt au premier obstacle).
+   * @param scene Vue de la scène (réglages de rendu, lumières)
+   * @param hit Intersection remplie par Intersect
+   * @param direction Direction du rayon incident
+   * @param lights Lumières à évaluer en ce point
+   * @param outReflectivity Poids du rayon réfléchi, 0 si la surface ne réfléchit pas
+   * @param stats Compteurs à incrémenter (rayons d'ombre), optionnel
+   * @return Radiance de la surface (non bornée), pondérée par 1 - outReflectivity lors du mélange
+   */
+  static Radiance ShadeSurface(const Scene& scene, const HitRecord& hit, const Vec3A& direction,
+                               const LightSet& lights, float& outReflectivity, PathStats* stats = nullptr);
+
+  /**
+   * Rayon réfléchi au point d'impact, légèrement décollé de la surface. Le
+   * cône repart de sa largeur au point d'impact ; une sphère (miroir convexe)
+   * l'ouvre de 2 * largeur * courbure.
+   * @param hit Intersection remplie par Intersect
    */
-  Color TraceScene(const std::vector<std::unique_ptr<Shape>>& scene, int depth = 5) const;
+  Ray Reflected(const HitRecord& hit) const;
+
+  /**
+   * Case du damier du plan sous un point : 1 pour les cases claires, 0 pour
+   * les sombres. Sert à ShadeSurface et à la détection de bords (EdgeRenderer).
+   */
+  static int CheckerCell(const Vec3& point);
+
+  /**
+   * Côté d'une case du damier, en unités de la scène.
+   */
+  static float CheckerCellSize();
+
+  /**
+   * Couleur renvoyée par un rayon qui s'échappe ou dépasse la profondeur maximale.
+   */
+  static Radiance BackgroundColor();
 
   /**
    * Retourne le point d'origine du rayon.
    * @return Position de départ du rayon
    */
-  Vec3 GetOrigin() const { return _origin; }
+  const Vec3A& GetOrigin() const { return _origin; }
 
   /**
    * Retourne la direction du rayon.
    * @return Vecteur directionnel du rayon
    */
-  Vec3 GetDirection() const { return _direction; }
+  const Vec3A& GetDirection() const { return _direction; }
+
+  /**
+   * Retourne le cône porté par le rayon.
+   */
+  const RayCone& GetCone() const { return _cone; }
 
   /**
    * Calcule un point le long du rayon à une distance t de l'origine.
@@ -48,9 +165,10 @@ public:
    * @param t Distance paramétrique le long du rayon
    * @return Point 3D situé à la distance t sur le rayon
    */
-  Vec3 PointAt(float t) const { return _origin + _direction * t; }
+  Vec3A PointAt(float t) const { return _origin + _direction * t; }
 
 private:
-  Vec3 _origin;     // Point de départ du rayon
-  Vec3 _direction;  // Direction du rayon (vecteur unitaire)
+  Vec3A _origin;     // Point de départ du rayon
+  Vec3A _direction;  // Direction du rayon (vecteur unitaire)
+  RayCone _cone;     // Empreinte de l'échantillon
 };
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Image.hpp"
+#include "FastMath.hpp"
+#include "Film.hpp"
+#include "QualityMap.hpp"
+#include "Sampler.hpp"
+
+/// How the image is traced: one sample's path at a time (Ray::TraceScene) or staged ray queues (WavefrontRenderer)
+enum class RenderPipeline {
+    Recursive,
+    Wavefront
+};
+
+/// When a reflection path stops before the maximum depth (see Ray::ContinuePath)
+enum class PathTermination {
+    Fixed,          // Only at maxDepth
+    Cutoff,         // Deterministic: once the path weight is at most minThroughput
+    RussianRoulette // Below rouletteThreshold, survives with probability weight / threshold (unbiased)
+};
+
+/// Renderer tracing the image, one per render: the modes exclude each other (see the "renderer" setting)
+enum class RendererType {
+    Standard,       // Every pixel at the full sample count
+    Adaptive,       // Samples where the pixel is noisy or contrasted (AdaptiveRenderer)
+    Budget,         // As many samples as a wall-clock budget allows (BudgetRenderer)
+    Progressive,    // Passes of growing sample counts with snapshots (ProgressiveRenderer)
+    Quality,        // Samples and depth per pixel from a quality map (QualityRenderer)
+    Preview,        // Half the pixels traced, the others interpolated (PreviewRenderer)
+    Edge,           // Full sample count on edge pixels only (EdgeRenderer)
+    Film,           // Samples splatted through a reconstruction filter (FilmRenderer)
+    Denoise         // Standard, then edge-aware denoising (Denoiser)
+};
+
+/// Pixels traced by a preview render, the others rebuilt from their neighbors (see PreviewRenderer)
+enum class PreviewPattern {
+    Checkerboard,   // Pixels with (x + y) even
+    Interlaced      // Even rows
+};
+
+/**
+ * @struct RenderSettings
+ * @brief Per-render options, read from the optional "render" block of a scene file
+ *
+ * Defaults reproduce the historical output: scenes without a "render" block
+ * render visually identical to before (silhouette pixels may differ by a few
+ * levels, from the SIMD intersection kernels and the fast inverse square root).
+ */
+struct RenderSettings {
+    /// Curve applied when the image is quantized to 8-bit ("linear", "srgb", "gamma22")
+    TransferCurve transfer = TransferCurve::Linear;
+
+    /// Tone mapping of the linear radiance before the transfer curve ("clamp", "reinhard", "aces")
+    ToneMapOperator toneMap = ToneMapOperator::Clamp;
+
+    /// Test every light contribution with a shadow ray ("shadows")
+    bool shadows = false;
+
+    /// Supersampling grid: samplesPerAxis² rays per pixel ("samplesPerAxis")
+    int samplesPerAxis = 4;
+
+    /// Sample pattern in the pixel ("sampler": "grid", "stratified", "sobol", "r2" or "bluenoise")
+    SamplerType sampler = SamplerType::Grid;
+
+    /// Samples per pixel of the samplers other than the grid, any count; 0 keeps samplesPerAxis² ("samplesPerPixel")
+    int samplesPerPixel = 0;
+
+    /// Renderer ("renderer": "standard", "adaptive", "budget", "progressive", "quality", "preview", "edge", "film" or
+    /// "denoise"). Renderers other than standard need the recursive pipeline; the settings below prefixed with a
+    /// renderer only apply to it. Adaptive and budget turn the sample count into a cap per pixel; denoise needs at
+    /// least 2 samples per pixel
+    RendererType renderer = RendererType::Standard;
+
+    /// Adaptive: samples of the first pass, also the size of each further batch ("adaptiveMinSamples")
+    int adaptiveMinSamples = 4;
+
+    /// Adaptive: standard error of the mean luminance (clamped to 1) at which a pixel stops ("adaptiveThreshold")
+    float adaptiveThreshold = 0.01f;
+
+    /// Adaptive: first-pass luminance difference with a neighbor that refines a pixel anyway ("adaptiveContrast")
+    float adaptiveContrast = 0.05f;
+
+    /// Budget: wall-clock budget of the tracing in milliseconds ("timeBudgetMs"): a first pass of one sample per
+    /// pixel, then the noisiest tiles get batches of adaptiveMinSamples until the deadline, which both passes check
+    int timeBudgetMs = 1000;
+
+    /// Progressive: the image so far is written to <output>_progress.png, removed once the final image is written.
+    /// Seconds between snapshots, mid pass included; 0 writes one after each pass ("progressiveDumpSeconds")
+    float progressiveDumpSeconds = 0.0f;
+
+    /// Quality: grayscale PNG scaling the samples and reflection depth of each pixel, black 0 to white 1
+    /// ("qualityMap"); a path relative to the scene file, empty for none
+    std::string qualityMap;
+
+    /// Quality: rectangles with their own quality, painted over the map in order ("qualityRegions")
+    std::vector<QualityRegion> qualityRegions;
+
+    /// Quality: quality outside the regions when there is no map ("qualityDefault")
+    float qualityDefault = 1.0f;
+
+    /// Preview: pixels traced ("previewPattern": "checkerboard" or "interlaced"); the others are interpolated along
+    /// edges found by a shape-id pass
+    PreviewPattern previewPattern = PreviewPattern::Checkerboard;
+
+    /// Edge: pixels where one non-reflective sphere meets one other surface are blended by the silhouette's exact
+    /// share of the pixel, from the center sample and one ray on the other side, instead of the full grid
+    /// ("coverageAA"). Requires the edge renderer
+    bool coverageAA = false;
+
+    /// Film: reconstruction filter splatting each sample over the neighboring pixels ("pixelFilter": "box",
+    /// "gaussian", "mitchell" or "blackmanharris"). A half-pixel box gives the per-pixel average
+    PixelFilter pixelFilter = PixelFilter::Gaussian;
+
+    /// Film: filter half-width in pixels, up to 8; 0 for the filter's default ("pixelFilterRadius")
+    float pixelFilterRadius = 0.0f;
+
+    /// Denoise: passes of the à-trous filter, footprint 4 * 2^iterations - 3 pixels ("denoiseIterations")
+    int denoiseIterations = 5;
+
+    /// Denoise: luminance difference, in standard errors of the pixel, at which a neighbor weighs e^-1 ("denoiseLuminanceSigma")
+    float denoiseLuminanceSigma = 0.5f;
+
+    /// Rays carry a cone (ray differentials) and textures filter over its footprint ("textureFilter")
+    bool textureFilter = false;
+
+    /// Bakes the sphere textures into cube maps at load time ("textureCache", see BakeSphereTextures)
+    bool textureCache = false;
+
+    /// Memory cap of the baked textures in MB; spheres past it keep the analytic texture ("textureCacheMB")
+    int textureCacheMB = 64;
+
+    /// Math used by textures and specular highlights ("exact" or "fast", see FastMath.hpp)
+    MathMode math = MathMode::Exact;
+
+    /// Tracing pipeline ("recursive" or "wavefront"); both produce the same image
+    RenderPipeline pipeline = RenderPipeline::Recursive;
+
+    /// Wavefront only: sort each reflection queue by Morton key before tracing it ("sortReflections")
+    bool sortReflections = false;
+
+    /// Maximum path length, camera ray included ("maxDepth")
+    int maxDepth = 5;
+
+    /// Early path termination ("termination": "fixed", "cutoff" or "roulette")
+    PathTermination termination = PathTermination::Cutoff;
+
+    /// Cutoff: path weight at or below which the rest of the path is estimated by the background ("minThroughput")
+    float minThroughput = 1e-3f;
+
+    /// Roulette: path weight below which paths are randomly killed ("rouletteThreshold")
+    float rouletteThreshold = 0.1f;
+
+    /// Also renders a fixed-depth reference and reports rays saved and error against it ("depthStats")
+    bool depthStats = false;
+};
@@ -7,7 +7,10 @@
 #include "Cube.hpp"
 #include "Shape.hpp"
 #include "Vec3.hpp"
+#include "RenderSettings.hpp"
 #include <memory>
 #include <vector>
 
-void render_scene(int width, int height, float screenZ, const char *outputFile);
+// settings : options de départ ; le bloc "render" d'une scène JSON les complète
+void render_scene(int width, int height, float screenZ, const char *outputFile,
+                  const RenderSettings &settings = RenderSettings());
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs work(thread) once on each of numThreads threads, the caller being thread 0
+ *
+ * Returns when every thread is done. At least one thread runs.
+ */
+template <typename Work>
+void RunThreads(unsigned numThreads, Work&& work)
+{
+    numThreads = std::max(numThreads, 1u);
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t)
+        threads.emplace_back([&work, t]() { work(t); });
+    work(0u);
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+/**
+ * @brief Runs rowPass(row, thread) over rows 0 to height - 1, rows taken one at a time
+ *
+ * Rows go to whichever thread is free, so the per-thread state a pass writes
+ * is indexed by the thread argument. Works for any numbered items, the tiles
+ * of a frame as well as its rows.
+ */
+template <typename RowPass>
+void RunRows(int height, unsigned numThreads, RowPass&& rowPass)
+{
+    std::atomic<int> nextRow{0};
+    RunThreads(numThreads, [&](unsigned t)
+    {
+        for (int j = nextRow++; j < height; j = nextRow++)
+            rowPass(j, t);
+    });
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Pattern of the camera samples inside a pixel ("sampler" render setting)
+enum class SamplerType {
+    Grid,         // Regular samplesPerAxis x samplesPerAxis grid, cell centers (historical)
+    Stratified,   // Correlated multi-jittered: jittered strata for any count (Kensler 2013)
+    Sobol,        // Sobol (0,2)-sequence with hash-based Owen scrambling (Burley 2020)
+    R2,           // Roberts' R2 sequence, randomly shifted per pixel
+    BlueNoise     // Progressive best-candidate point sets, randomly picked and shifted per pixel
+};
+
+/**
+ * @class Sampler
+ * @brief Sub-pixel sample positions used by AntiAliasing
+ *
+ * Offset() gives sample `index` of a pixel as a position in [0, 1)² inside
+ * it. Positions depend only on the pixel, the index and the sample count, so
+ * every renderer (and every run) sees the same samples. The random samplers
+ * decorrelate neighboring pixels with a hash of the pixel coordinates, which
+ * turns structured aliasing into noise.
+ *
+ * Any prefix of the Sobol, R2 and blue-noise sequences is itself well spread,
+ * which adaptive sampling relies on when it stops early.
+ */
+class Sampler {
+public:
+    explicit Sampler(int sampleCount) : sampleCount_(sampleCount) {}
+    virtual ~Sampler() = default;
+
+    /// Position of a sample in the pixel, each coordinate in [0, 1)
+    virtual void Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const = 0;
+
+    int GetSampleCount() const { return sampleCount_; }
+
+    /**
+     * @brief Creates a sampler
+     * @param type Pattern
+     * @param sampleCount Samples per pixel; Grid expects a perfect square
+     */
+    static std::unique_ptr<Sampler> Create(SamplerType type, int sampleCount);
+
+    /// Well-mixed 32-bit hash of a pixel and a salt, the per-pixel randomization of the samplers
+    static std::uint32_t HashPixel(int pixelX, int pixelY, std::uint32_t salt);
+
+protected:
+    int sampleCount_;
+};
+
+class GridSampler : public Sampler {
+public:
+    explicit GridSampler(int samplesPerAxis);
+    void Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const override;
+
+private:
+    int samplesPerAxis_;
+    float invSamplesPerAxis_;
+};
+
+class StratifiedSampler : public Sampler {
+public:
+    explicit StratifiedSampler(int sampleCount);
+    void Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const override;
+
+private:
+    int columns_;   // Strata along x
+    int rows_;      // Strata along y, columns_ * rows_ >= sampleCount
+};
+
+class SobolSampler : public Sampler {
+public:
+    explicit SobolSampler(int sampleCount) : Sampler(sampleCount) {}
+    void Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const override;
+};
+
+class R2Sampler : public Sampler {
+public:
+    explicit R2Sampler(int sampleCount) : Sampler(sampleCount) {}
+    void Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const override;
+};
+
+class BlueNoiseSampler : public Sampler {
+public:
+    /// Distinct point sets the pixels pick from
+    static constexpr int PATTERN_COUNT = 16;
+
+    explicit BlueNoiseSampler(int sampleCount);
+    void Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const override;
+
+private:
+    std::vector<float> points_;   // PATTERN_COUNT sets of sampleCount (x, y) pairs
+};
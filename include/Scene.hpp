@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "Shape.hpp"
+#include "Vec3.hpp"
+#include "Vec3A.hpp"
+#include "Kernels.hpp"
+#include "RenderSettings.hpp"
+#include "Light.hpp"
+#include "ShadingContext.hpp"
+
+/**
+ * @class Scene
+ * @brief Read-only, render-time view of the shapes with packed geometry for the kernels
+ *
+ * The shapes stay owned by the caller. Spheres, cubes and planes are mirrored
+ * into structure-of-arrays blocks so the ISA-specific intersection kernels
+ * (see Kernels.hpp) test several primitives per instruction; shapes of any
+ * other type are tested one by one through Shape::Intersect.
+ *
+ * The view must be rebuilt if shapes are added, removed or moved.
+ *
+ * The scene also carries its lights; without any, it is lit by Light::Defaults().
+ */
+class Scene {
+public:
+    /// Sphere arrays are padded to a multiple of the widest kernel (AVX-512, 16 floats)
+    static constexpr int LANE_PADDING = 16;
+
+    explicit Scene(const std::vector<std::unique_ptr<Shape>>& shapes, const RenderSettings& settings = RenderSettings(),
+                   std::vector<Light> lights = Light::Defaults());
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    /**
+     * @brief Finds the closest shape hit by a ray
+     * @param o Ray origin
+     * @param d Normalized ray direction
+     * @param out_t Distance to the hit, only written on hit
+     * @return Hit shape, or nullptr if the ray escapes
+     */
+    const Shape* ClosestHit(const Vec3& o, const Vec3& d, float& out_t) const;
+
+    /// Same as above for the aligned vectors of the ray hot path
+    const Shape* ClosestHit(const Vec3A& o, const Vec3A& d, float& out_t) const;
+
+    /**
+     * @brief Shadow ray test, stops at the first shape found
+     * @param o Ray origin, already offset off the shaded surface
+     * @param d Normalized direction towards the light
+     * @param maxDistance Distance to the light; hits beyond it do not occlude
+     * @return true if any shape lies between the origin and the light
+     */
+    bool Occluded(const Vec3A& o, const Vec3A& d, float maxDistance) const;
+
+    const std::vector<Shape*>& GetShapes() const { return _shapes; }
+    const std::vector<Light>& GetLights() const { return _lights; }
+    /// Every light of the scene, for shading points no culling applies to
+    LightSet AllLights() const { return {_allLights.data(), static_cast<int>(_allLights.size())}; }
+    const PackedGeometry& GetGeometry() const { return _geometry; }
+    const RenderSettings& GetSettings() const { return _settings; }
+    /// Lighting constants of this frame, built with the view
+    const ShadingContext& GetShading() const { return _shading; }
+
+private:
+    const Shape* ClosestHit(const float origin[3], const float direction[3], float& out_t) const;
+
+    std::vector<Shape*> _shapes;
+    std::vector<int> _otherShapes;   // Indices of shapes the kernels do not know
+    const KernelTable& _kernels;
+    RenderSettings _settings;
+    std::vector<Light> _lights;
+    std::vector<int> _allLights;     // 0 .. lights - 1
+    ShadingContext _shading;
+
+    // Structure-of-arrays storage behind _geometry
+    std::vector<float> _sphereCx, _sphereCy, _sphereCz, _sphereRadius2;
+    std::vector<int> _sphereShape;
+    std::vector<float> _boxMinX, _boxMinY, _boxMinZ, _boxMaxX, _boxMaxY, _boxMaxZ;
+    std::vector<int> _boxShape;
+    std::vector<float> _planePx, _planePy, _planePz, _planeNx, _planeNy, _planeNz;
+    std::vector<int> _planeShape;
+
+    PackedGeometry _geometry{};
+};
@@ -1,5 +1,7 @@
 #pragma once
+#include <filesystem>
 #include <fstream>
+#include <limits>
 #include <vector>
 #include <memory>
 #include "json.hpp"
@@ -9,6 +11,8 @@
 #include "Cube.hpp"
 #include "Vec3.hpp"
 #include "Color.hpp"
+#include "RenderSettings.hpp"
+#include "Light.hpp"
 
 using json = nlohmann::json;
 
@@ -23,9 +27,12 @@ public:
         Vec3 cameraPos;
         float screenZ;
         std::vector<std::unique_ptr<Shape>> shapes;
+        std::vector<Light> lights;
+        RenderSettings settings;
     };
 
-    static SceneData LoadFromFile(const std::string &filename)
+    // defaults : réglages de rendu complétés par le bloc "render" du fichier
+    static SceneData LoadFromFile(const std::string &filename, const RenderSettings &defaults = RenderSettings())
     {
         std::ifstream file(filename);
         if (!file.is_open())
@@ -68,6 +75,24 @@ public:
         scene.cameraPos = Vec3{camPos[0], camPos[1], camPos[2]};
         scene.screenZ = j["camera"]["screen_z"];
 
+        // Parse render settings (optional, each key overrides the defaults)
+        scene.settings = defaults;
+        if (j.contains("render"))
+            ParseRenderSettings(j["render"], scene.settings);
+
+        // The quality map is looked up next to the scene file
+        if (!scene.settings.qualityMap.empty()) {
+            std::filesystem::path map(scene.settings.qualityMap);
+            if (map.is_relative())
+                map = std::filesystem::path(filename).parent_path() / map;
+            if (!std::filesystem::exists(map))
+                throw std::runtime_error("Quality map not found: " + map.string());
+            scene.settings.qualityMap = map.string();
+        }
+
+        // Parse lights (optional, the historical directional light otherwise)
+        scene.lights = j.contains("lights") ? ParseLights(j["lights"]) : Light::Defaults();
+
         for (const auto &shape : j["shapes"]) {
             std::string type = shape["type"];
 
@@ -93,4 +118,308 @@ public:
 
         return scene;
     }
+
+private:
+    static std::vector<Light> ParseLights(const json &array)
+    {
+        std::vector<Light> lights;
+
+        for (const auto &light : array) {
+            std::string type = light["type"];
+
+            Color color(1.0f, 1.0f, 1.0f);
+            if (light.contains("color")) {
+                auto col = light["color"];
+                color = Color(col[0], col[1], col[2]);
+            }
+            float intensity = light.value("intensity", 1.0f);
+            if (intensity < 0.0f)
+                throw std::runtime_error("Light intensity must be positive");
+
+            if (type == "directional") {
+                auto dir = light["direction"];
+                Vec3 direction{dir[0], dir[1], dir[2]};
+                if (length(direction) == 0.0f)
+                    throw std::runtime_error("Directional light needs a non-zero direction");
+                lights.push_back(Light::Directional(direction, color, intensity));
+            } else if (type == "point") {
+                auto pos = light["position"];
+                float range = light.value("range", std::numeric_limits<float>::infinity());
+                if (!(range > 0.0f))
+                    throw std::runtime_error("Point light range must be positive");
+                lights.push_back(Light::Point(Vec3{pos[0], pos[1], pos[2]}, range, color, intensity));
+            }
+            else {
+                std::cerr << "Warning: Unknown light type \"" << type << "\" in scene\n";
+            }
+        }
+
+        return lights;
+    }
+
+    static void ParseRenderSettings(const json &r, RenderSettings &settings)
+    {
+        if (r.contains("transfer")) {
+            std::string transfer = r["transfer"];
+            if (transfer == "linear")
+                settings.transfer = TransferCurve::Linear;
+            else if (transfer == "srgb")
+                settings.transfer = TransferCurve::SRGB;
+            else if (transfer == "gamma22")
+                settings.transfer = TransferCurve::Gamma22;
+            else
+                throw std::runtime_error("Unknown transfer curve: " + transfer);
+        }
+
+        if (r.contains("toneMap")) {
+            std::string toneMap = r["toneMap"];
+            if (toneMap == "clamp")
+                settings.toneMap = ToneMapOperator::Clamp;
+            else if (toneMap == "reinhard")
+                settings.toneMap = ToneMapOperator::Reinhard;
+            else if (toneMap == "aces")
+                settings.toneMap = ToneMapOperator::ACES;
+            else
+                throw std::runtime_error("Unknown tone map: " + toneMap);
+        }
+
+        if (r.contains("shadows"))
+            settings.shadows = r["shadows"].get<bool>();
+
+        if (r.contains("samplesPerAxis")) {
+            settings.samplesPerAxis = r["samplesPerAxis"].get<int>();
+            if (settings.samplesPerAxis < 1)
+                throw std::runtime_error("samplesPerAxis must be at least 1");
+        }
+
+        if (r.contains("sampler")) {
+            std::string sampler = r["sampler"];
+            if (sampler == "grid")
+                settings.sampler = SamplerType::Grid;
+            else if (sampler == "stratified")
+                settings.sampler = SamplerType::Stratified;
+            else if (sampler == "sobol")
+                settings.sampler = SamplerType::Sobol;
+            else if (sampler == "r2")
+                settings.sampler = SamplerType::R2;
+            else if (sampler == "bluenoise")
+                settings.sampler = SamplerType::BlueNoise;
+            else
+                throw std::runtime_error("Unknown sampler: " + sampler);
+        }
+
+        if (r.contains("samplesPerPixel")) {
+            settings.samplesPerPixel = r["samplesPerPixel"].get<int>();
+            if (settings.samplesPerPixel < 0)
+                throw std::runtime_error("samplesPerPixel must not be negative");
+        }
+
+        if (r.contains("renderer")) {
+            std::string renderer = r["renderer"];
+            if (renderer == "standard")
+                settings.renderer = RendererType::Standard;
+            else if (renderer == "adaptive")
+                settings.renderer = RendererType::Adaptive;
+            else if (renderer == "budget")
+                settings.renderer = RendererType::Budget;
+            else if (renderer == "progressive")
+                settings.renderer = RendererType::Progressive;
+            else if (renderer == "quality")
+                settings.renderer = RendererType::Quality;
+            else if (renderer == "preview")
+                settings.renderer = RendererType::Preview;
+            else if (renderer == "edge")
+                settings.renderer = RendererType::Edge;
+            else if (renderer == "film")
+                settings.renderer = RendererType::Film;
+            else if (renderer == "denoise")
+                settings.renderer = RendererType::Denoise;
+            else
+                throw std::runtime_error("Unknown renderer: " + renderer);
+        }
+
+        if (r.contains("adaptiveMinSamples")) {
+            settings.adaptiveMinSamples = r["adaptiveMinSamples"].get<int>();
+            if (settings.adaptiveMinSamples < 2)
+                throw std::runtime_error("adaptiveMinSamples must be at least 2");
+        }
+
+        if (r.contains("adaptiveThreshold")) {
+            settings.adaptiveThreshold = r["adaptiveThreshold"].get<float>();
+            if (settings.adaptiveThreshold < 0.0f)
+                throw std::runtime_error("adaptiveThreshold must not be negative");
+        }
+
+        if (r.contains("adaptiveContrast")) {
+            settings.adaptiveContrast = r["adaptiveContrast"].get<float>();
+            if (settings.adaptiveContrast < 0.0f)
+                throw std::runtime_error("adaptiveContrast must not be negative");
+        }
+
+        if (r.contains("timeBudgetMs")) {
+            settings.timeBudgetMs = r["timeBudgetMs"].get<int>();
+            if (settings.timeBudgetMs < 1)
+                throw std::runtime_error("timeBudgetMs must be at least 1");
+        }
+
+        if (r.contains("progressiveDumpSeconds")) {
+            settings.progressiveDumpSeconds = r["progressiveDumpSeconds"].get<float>();
+            if (settings.progressiveDumpSeconds < 0.0f)
+                throw std::runtime_error("progressiveDumpSeconds must not be negative");
+        }
+
+        if (r.contains("qualityMap"))
+            settings.qualityMap = r["qualityMap"].get<std::string>();
+
+        if (r.contains("qualityRegions")) {
+            settings.qualityRegions.clear();
+            for (const auto &region : r["qualityRegions"]) {
+                QualityRegion q;
+                q.x = region.value("x", 0.0f);
+                q.y = region.value("y", 0.0f);
+                q.width = region.value("width", 1.0f);
+                q.height = region.value("height", 1.0f);
+                q.quality = region.value("quality", 1.0f);
+                if (q.x < 0.0f || q.y < 0.0f || q.width <= 0.0f || q.height <= 0.0f
+                    || q.x + q.width > 1.0f || q.y + q.height > 1.0f)
+                    throw std::runtime_error("qualityRegions must lie inside the image, in fractions of its size");
+                if (q.quality < 0.0f || q.quality > 1.0f)
+                    throw std::runtime_error("quality must be in [0, 1]");
+                settings.qualityRegions.push_back(q);
+            }
+        }
+
+        if (r.contains("qualityDefault")) {
+            settings.qualityDefault = r["qualityDefault"].get<float>();
+            if (settings.qualityDefault < 0.0f || settings.qualityDefault > 1.0f)
+                throw std::runtime_error("qualityDefault must be in [0, 1]");
+        }
+
+        if (r.contains("previewPattern")) {
+            std::string pattern = r["previewPattern"];
+            if (pattern == "checkerboard")
+                settings.previewPattern = PreviewPattern::Checkerboard;
+            else if (pattern == "interlaced")
+                settings.previewPattern = PreviewPattern::Interlaced;
+            else
+                throw std::runtime_error("Unknown preview pattern: " + pattern);
+        }
+
+        if (r.contains("coverageAA"))
+            settings.coverageAA = r["coverageAA"].get<bool>();
+
+        if (r.contains("pixelFilter")) {
+            std::string filter = r["pixelFilter"];
+            if (filter == "box")
+                settings.pixelFilter = PixelFilter::Box;
+            else if (filter == "gaussian")
+                settings.pixelFilter = PixelFilter::Gaussian;
+            else if (filter == "mitchell")
+                settings.pixelFilter = PixelFilter::Mitchell;
+            else if (filter == "blackmanharris")
+                settings.pixelFilter = PixelFilter::BlackmanHarris;
+            else
+                throw std::runtime_error("Unknown pixel filter: " + filter);
+        }
+
+        if (r.contains("pixelFilterRadius")) {
+            settings.pixelFilterRadius = r["pixelFilterRadius"].get<float>();
+            if (settings.pixelFilterRadius < 0.0f || settings.pixelFilterRadius > ReconstructionFilter::MAX_RADIUS)
+                throw std::runtime_error("pixelFilterRadius must be in [0, 8]");
+        }
+
+        if (r.contains("denoiseIterations")) {
+            settings.denoiseIterations = r["denoiseIterations"].get<int>();
+            if (settings.denoiseIterations < 1 || settings.denoiseIterations > 10)
+                throw std::runtime_error("denoiseIterations must be in [1, 10]");
+        }
+
+        if (r.contains("denoiseLuminanceSigma")) {
+            settings.denoiseLuminanceSigma = r["denoiseLuminanceSigma"].get<float>();
+            if (settings.denoiseLuminanceSigma <= 0.0f)
+                throw std::runtime_error("denoiseLuminanceSigma must be positive");
+        }
+
+        if (r.contains("textureFilter"))
+            settings.textureFilter = r["textureFilter"].get<bool>();
+
+        if (r.contains("textureCache"))
+            settings.textureCache = r["textureCache"].get<bool>();
+
+        if (r.contains("textureCacheMB")) {
+            settings.textureCacheMB = r["textureCacheMB"].get<int>();
+            if (settings.textureCacheMB < 0)
+                throw std::runtime_error("textureCacheMB must not be negative");
+        }
+
+        if (r.contains("math")) {
+            std::string math = r["math"];
+            if (math == "exact")
+                settings.math = MathMode::Exact;
+            else if (math == "fast")
+                settings.math = MathMode::Fast;
+            else
+                throw std::runtime_error("Unknown math mode: " + math);
+        }
+
+        if (r.contains("pipeline")) {
+            std::string pipeline = r["pipeline"];
+            if (pipeline == "recursive")
+                settings.pipeline = RenderPipeline::Recursive;
+            else if (pipeline == "wavefront")
+                settings.pipeline = RenderPipeline::Wavefront;
+            else
+                throw std::runtime_error("Unknown render pipeline: " + pipeline);
+        }
+
+        if (r.contains("sortReflections"))
+            settings.sortReflections = r["sortReflections"].get<bool>();
+
+        if (r.contains("maxDepth")) {
+            settings.maxDepth = r["maxDepth"].get<int>();
+            if (settings.maxDepth < 1)
+                throw std::runtime_error("maxDepth must be at least 1");
+        }
+
+        if (r.contains("termination")) {
+            std::string termination = r["termination"];
+            if (termination == "fixed")
+                settings.termination = PathTermination::Fixed;
+            else if (termination == "cutoff")
+                settings.termination = PathTermination::Cutoff;
+            else if (termination == "roulette")
+                settings.termination = PathTermination::RussianRoulette;
+            else
+                throw std::runtime_error("Unknown path termination: " + termination);
+        }
+
+        if (r.contains("minThroughput")) {
+            settings.minThroughput = r["minThroughput"].get<float>();
+            if (settings.minThroughput < 0.0f || settings.minThroughput >= 1.0f)
+                throw std::runtime_error("minThroughput must be in [0, 1)");
+        }
+
+        if (r.contains("rouletteThreshold")) {
+            settings.rouletteThreshold = r["rouletteThreshold"].get<float>();
+            if (settings.rouletteThreshold <= 0.0f || settings.rouletteThreshold > 1.0f)
+                throw std::runtime_error("rouletteThreshold must be in (0, 1]");
+        }
+
+        if (r.contains("depthStats"))
+            settings.depthStats = r["depthStats"].get<bool>();
+
+        if (settings.samplesPerPixel > 0 && settings.sampler == SamplerType::Grid)
+            throw std::runtime_error("samplesPerPixel needs a sampler other than grid (use samplesPerAxis)");
+
+        if (settings.renderer != RendererType::Standard && settings.pipeline != RenderPipeline::Recursive)
+            throw std::runtime_error("renderers other than standard require the recursive pipeline");
+
+        if (settings.coverageAA && settings.renderer != RendererType::Edge)
+            throw std::runtime_error("coverageAA requires the edge renderer");
+
+        const int samplesPerPixel = settings.samplesPerPixel > 0 ? settings.samplesPerPixel
+                                                                 : settings.samplesPerAxis * settings.samplesPerAxis;
+        if (settings.renderer == RendererType::Denoise && samplesPerPixel < 2)
+            throw std::runtime_error("denoise needs at least 2 samples per pixel to measure their variance");
+    }
 };
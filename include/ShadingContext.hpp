@@ -0,0 +1,81 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include "Light.hpp"
+#include "Radiance.hpp"
+#include "RenderSettings.hpp"
+#include "FastMath.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @struct ShadingContext
+ * @brief Lighting and material constants of one frame, shared by every hit
+ *
+ * Built once with the Scene view, so shading no longer normalizes the view
+ * vector, the directional light vectors and their halfway vectors, nor
+ * divides by the point light ranges, at every hit. Ray::ShadeSurface reads
+ * it through Scene::GetShading().
+ */
+struct ShadingContext {
+    /// One light in the form shading consumes
+    struct LightUniforms {
+        LightType type;
+        Vec3 toLight;        // Directional: unit vector towards the light
+        Vec3 halfway;        // Directional: normalize(toLight + viewDir)
+        Vec3 position;       // Point
+        Radiance emission;
+        float invRange;      // Point: 1 / range, 0 for no falloff
+
+        /**
+         * Falloff of a point light at a distance: (1 - (d / range)²)², exactly 0
+         * from the range on, so a light can be skipped wherever it is out of range.
+         */
+        float Falloff(float distance) const
+        {
+            const float x = distance * invRange;
+            if (x >= 1.0f)
+                return 0.0f;
+            const float window = 1.0f - x * x;
+            return window * window;
+        }
+
+        /**
+         * Direction towards the light, its distance and the radiance reaching a point
+         * before the shadow test
+         * @return false when the point is out of the light's range
+         */
+        bool Incident(const Vec3& point, Vec3& outToLight, float& outDistance, Radiance& outIncoming) const
+        {
+            if (type == LightType::Directional)
+            {
+                outToLight = toLight;
+                outDistance = std::numeric_limits<float>::infinity();
+                outIncoming = emission;
+                return true;
+            }
+
+            const Vec3 offset = position - point;
+            outDistance = length(offset);
+            const float falloff = Falloff(outDistance);
+            if (falloff <= 0.0f || outDistance == 0.0f)
+                return false;
+            outToLight = offset * (1.0f / outDistance);
+            outIncoming = emission * falloff;
+            return true;
+        }
+    };
+
+    /// Blinn-Phong exponent of every surface
+    static constexpr unsigned SHININESS = 64;
+
+    Vec3 viewDir;                   // Fixed view vector of the highlights
+    float ambient = 0.15f;
+    float diffuseStrength = 0.5f;
+    float specularStrength = 0.7f;
+    MathMode math = MathMode::Exact;
+    bool shadows = false;
+    std::vector<LightUniforms> lights;   // Same indices as Scene::GetLights()
+
+    ShadingContext(const std::vector<Light>& sceneLights, const RenderSettings& settings);
+};
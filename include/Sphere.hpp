@@ -3,27 +3,50 @@
 #include "Shape.hpp"
 #include "Vec3.hpp"
 #include "Image.hpp"
+#include "FastMath.hpp"
+#include "Radiance.hpp"
+#include <memory>
+
+class SphereTextureCache;
 
 // Dessine une sphère centrée (cx, cy), rayon en pixels, teintée par baseColor.
-// Éclairage minimal : ambiant + Lambert
+// Texture procédurale, éclairée par Ray::ShadeSurface
 class Sphere : public Shape
 {
 public:
+    enum class TextureType { Gradient, Marble, Noise };
+
     void RandomizeTexture();
+    void SetTexture(TextureType type, float seed) { _textureType = type; _textureSeed = seed; _textureCache.reset(); }
+    TextureType GetTextureType() const { return _textureType; }
+
+    /// Baked pattern sampled by GetAlbedo instead of the analytic texture (see BakeSphereTextures); nullptr to drop it
+    void SetTextureCache(std::shared_ptr<const SphereTextureCache> cache) { _textureCache = std::move(cache); }
+    bool HasTextureCache() const { return _textureCache != nullptr; }
 
     Sphere(const Vec3& center, float radius, const Color& color, float reflectivity = 0.0f);
 
     bool Intersect(const Vec3 &o, const Vec3 &d, float &out_t) override;
 
     const Color& GetColor() const { return _color; }
-    Color GetShadedColor(const Vec3& hitPoint) const;
+    /**
+     * Textured diffuse color at a surface point; the lights are applied by Ray::ShadeSurface
+     * @param footprint Width of the ray cone on the surface (HitRecord::footprint); the
+     *        oscillations of Marble and Noise fade to their mean as it spans their period.
+     *        0 evaluates the texture at the point
+     */
+    Radiance GetAlbedo(const Vec3& hitPoint, const Vec3& normal, float footprint = 0.0f,
+                       MathMode mathMode = MathMode::Exact) const;
+    /// Analytic texture pattern in [0, 1] that GetAlbedo multiplies the color by
+    float EvaluatePattern(const Vec3& hitPoint, const Vec3& normal, float footprint = 0.0f,
+                          MathMode mathMode = MathMode::Exact) const;
     const Vec3& GetCenter() const { return _center; }
+    float GetRadius() const { return _radius; }
     float GetReflectivity() const { return _reflectivity; }
 private:
-    enum class TextureType { Gradient, Marble, Noise };
-
     TextureType _textureType = TextureType::Gradient;
     float _textureSeed = 0.0f;
+    std::shared_ptr<const SphereTextureCache> _textureCache;
 
     Vec3 _center;
     float _radius;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "Shape.hpp"
+#include "Vec3.hpp"
+
+/**
+ * @class SphereTextureCache
+ * @brief Procedural pattern of one sphere baked into a cube map
+ *
+ * On a sphere the pattern only depends on the direction from the center, so
+ * it is stored as 6 faces of size² texels, indexed by the normal. A face is
+ * picked by the major axis of the normal and the two other coordinates,
+ * divided by it, give the position in [-1, 1]² on the face. Lookups are
+ * bilinear, clamped at the face borders.
+ */
+class SphereTextureCache {
+public:
+    /**
+     * @param size Texels per face side
+     * @param pattern Pattern for a unit direction, evaluated at every texel center
+     */
+    template <typename PatternFn>
+    SphereTextureCache(int size, PatternFn&& pattern)
+        : size_(size), texels_(static_cast<std::size_t>(6) * size * size)
+    {
+        for (int face = 0; face < 6; ++face)
+            for (int j = 0; j < size; ++j)
+                for (int i = 0; i < size; ++i)
+                    texels_[Index(face, i, j)] = pattern(TexelDirection(face, i, j));
+    }
+
+    /// Bilinear lookup of the pattern in a direction (need not be normalized)
+    float Sample(const Vec3& direction) const;
+
+    /// Unit direction through the center of a texel
+    Vec3 TexelDirection(int face, int i, int j) const;
+
+    int GetSize() const { return size_; }
+    std::size_t GetBytes() const { return texels_.size() * sizeof(float); }
+
+    /// Bytes a cache of this face size would take
+    static std::size_t BytesFor(int size) { return static_cast<std::size_t>(6) * size * size * sizeof(float); }
+
+private:
+    std::size_t Index(int face, int i, int j) const
+    {
+        return (static_cast<std::size_t>(face) * size_ + j) * size_ + i;
+    }
+
+    int size_;
+    std::vector<float> texels_;
+};
+
+/**
+ * @struct TextureBakeStats
+ * @brief Result of BakeSphereTextures
+ */
+struct TextureBakeStats {
+    int baked = 0;            // Spheres now sampling a cache
+    int analytic = 0;         // Textured spheres left analytic by the memory cap
+    std::size_t bytes = 0;    // Memory of the baked caches
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Bakes the Marble and Noise textures of the spheres, in parallel
+ *
+ * The face size follows the projected radius of each sphere (about 1.5
+ * texels per pixel of radius, between MIN_CACHE_SIZE and MAX_CACHE_SIZE), so a
+ * texel stays under a pixel where the sphere is seen directly. Spheres are
+ * served from the largest on screen down; those that would push the total over
+ * memoryCapBytes keep the analytic evaluation. Gradient spheres are cheap and
+ * never baked.
+ *
+ * @param shapes Shapes of the scene; caches are attached to their spheres
+ * @param camOrigin Camera origin
+ * @param pixelsPerUnit Pixels per world unit on a plane at distance 1 from the camera
+ * @param memoryCapBytes Maximum memory of all caches together
+ * @param numThreads Baking threads
+ */
+TextureBakeStats BakeSphereTextures(const std::vector<std::unique_ptr<Shape>>& shapes,
+                                    const Vec3& camOrigin, float pixelsPerUnit,
+                                    std::size_t memoryCapBytes, unsigned numThreads);
+
+constexpr int MIN_CACHE_SIZE = 16;
+constexpr int MAX_CACHE_SIZE = 1024;
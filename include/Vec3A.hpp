@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Vec3.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYTRACER_VEC3A_SSE 1
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @struct Vec3A
+ * @brief 16-byte aligned 3D vector for the ray, hit and camera hot paths
+ *
+ * Holds x, y, z in the first three lanes of an SSE register (the fourth lane
+ * is ignored by every operation), so each operator is a single instruction
+ * instead of three scalar ones. Vec3 stays the compact storage type used by
+ * the shapes and scene I/O; conversions between the two are explicit.
+ *
+ * SSE2 is part of the x86-64 baseline, so no extra compile flag is needed;
+ * other targets fall back to plain floats.
+ */
+struct alignas(16) Vec3A {
+#ifdef RAYTRACER_VEC3A_SSE
+    __m128 v;
+
+    Vec3A() : v(_mm_setzero_ps()) {}
+    Vec3A(float X, float Y, float Z) : v(_mm_set_ps(0.0f, Z, Y, X)) {}
+    explicit Vec3A(float s) : v(_mm_set1_ps(s)) {}
+    explicit Vec3A(__m128 m) : v(m) {}
+    explicit Vec3A(const Vec3& a) : v(_mm_set_ps(0.0f, a.z, a.y, a.x)) {}
+
+    float X() const { return _mm_cvtss_f32(v); }
+    float Y() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+    float Z() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))); }
+
+    /// Writes x, y, z, w to a 16-byte aligned array (the layout the kernels read)
+    void Store(float* out4) const { _mm_store_ps(out4, v); }
+
+    Vec3A operator+(const Vec3A& a) const { return Vec3A(_mm_add_ps(v, a.v)); }
+    Vec3A operator-(const Vec3A& a) const { return Vec3A(_mm_sub_ps(v, a.v)); }
+    Vec3A operator*(float s)        const { return Vec3A(_mm_mul_ps(v, _mm_set1_ps(s))); }
+    Vec3A operator/(float s)        const { return Vec3A(_mm_div_ps(v, _mm_set1_ps(s))); }
+    Vec3A operator-()               const { return Vec3A(_mm_sub_ps(_mm_setzero_ps(), v)); }
+
+    Vec3A& operator+=(const Vec3A& a) { v = _mm_add_ps(v, a.v); return *this; }
+#else
+    float e[4];
+
+    Vec3A() : e{0.0f, 0.0f, 0.0f, 0.0f} {}
+    Vec3A(float X, float Y, float Z) : e{X, Y, Z, 0.0f} {}
+    explicit Vec3A(float s) : e{s, s, s, s} {}
+    explicit Vec3A(const Vec3& a) : e{a.x, a.y, a.z, 0.0f} {}
+
+    float X() const { return e[0]; }
+    float Y() const { return e[1]; }
+    float Z() const { return e[2]; }
+
+    void Store(float* out4) const { for (int i = 0; i < 4; ++i) out4[i] = e[i]; }
+
+    Vec3A operator+(const Vec3A& a) const { return {e[0]+a.e[0], e[1]+a.e[1], e[2]+a.e[2]}; }
+    Vec3A operator-(const Vec3A& a) const { return {e[0]-a.e[0], e[1]-a.e[1], e[2]-a.e[2]}; }
+    Vec3A operator*(float s)        const { return {e[0]*s, e[1]*s, e[2]*s}; }
+    Vec3A operator/(float s)        const { return {e[0]/s, e[1]/s, e[2]/s}; }
+    Vec3A operator-()               const { return {-e[0], -e[1], -e[2]}; }
+
+    Vec3A& operator+=(const Vec3A& a) { *this = *this + a; return *this; }
+#endif
+
+    explicit operator Vec3() const { return {X(), Y(), Z()}; }
+};
+
+#ifdef RAYTRACER_VEC3A_SSE
+
+// x*x' + y*y' + z*z' broadcast to every lane (SSE2 only: no dpps, which needs SSE4.1)
+inline __m128 DotSplat(const Vec3A& a, const Vec3A& b) {
+    __m128 m = _mm_mul_ps(a.v, b.v);
+    __m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 z = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 sum = _mm_add_ss(_mm_add_ss(m, y), z);
+    return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+inline float dot(const Vec3A& a, const Vec3A& b) {
+    return _mm_cvtss_f32(DotSplat(a, b));
+}
+
+inline float length(const Vec3A& a) {
+    return _mm_cvtss_f32(_mm_sqrt_ss(DotSplat(a, a)));
+}
+
+/**
+ * Normalization by rsqrtps plus one Newton-Raphson step (relative error ~2e-7
+ * instead of the 12-bit estimate), no division. Zero vectors stay zero.
+ */
+inline Vec3A normalize(const Vec3A& a) {
+    const __m128 len2 = DotSplat(a, a);
+    const __m128 r = _mm_rsqrt_ps(len2);
+    // r' = r * (1.5 - 0.5 * len2 * r * r)
+    const __m128 refined = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f),
+                                      _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), len2), _mm_mul_ps(r, r))));
+    const __m128 nonZero = _mm_cmpgt_ps(len2, _mm_setzero_ps());
+    return Vec3A(_mm_and_ps(_mm_mul_ps(a.v, refined), nonZero));
+}
+
+#else
+
+inline float dot(const Vec3A& a, const Vec3A& b) {
+    return a.e[0]*b.e[0] + a.e[1]*b.e[1] + a.e[2]*b.e[2];
+}
+
+inline float length(const Vec3A& a) {
+    return std::sqrt(dot(a, a));
+}
+
+inline Vec3A normalize(const Vec3A& a) {
+    float L = length(a);
+    if (L == 0.0f) return {};
+    return a * (1.0f / L);
+}
+
+#endif
+
+inline Vec3A reflect(const Vec3A& d, const Vec3A& n) {
+    return d - n * (2.0f * dot(d, n));
+}
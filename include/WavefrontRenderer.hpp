@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "HitRecord.hpp"
+#include "Ray.hpp"
+#include "Image.hpp"
+#include "LightTiles.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+#include "Vec3A.hpp"
+
+/**
+ * @struct WavefrontStats
+ * @brief Counters of one wavefront render
+ */
+struct WavefrontStats {
+    long long raysTraced = 0;          // Camera and reflection rays
+    long long reflectionRays = 0;      // Rays of bounces 2 and deeper
+    long long sortedRays = 0;          // Reflection rays reordered by Morton key
+    long long terminatedPaths = 0;     // Paths stopped before maxDepth by Ray::ContinuePath
+    long long shadowRays = 0;          // Occlusion tests towards the lights ("shadows" setting)
+
+    // Consecutive reflection rays hitting different shapes (or one hitting, one escaping):
+    // in the order they were spawned vs. the order they were traced after sorting. Counted on sorted bounces only
+    long long shapeSwitchesUnsorted = 0;
+    long long shapeSwitchesTraced = 0;
+
+    double sortSeconds = 0.0;          // Time spent computing keys and reordering
+    double reflectionIntersectSeconds = 0.0;  // Intersection stage of the reflection bounces
+};
+
+/**
+ * @class WavefrontRenderer
+ * @brief Breadth-first alternative to tracing each sample's path on its own (Ray::TraceScene)
+ *
+ * Rays are processed in stages over large queues instead of one sample at a
+ * time: a band of image rows generates all its camera rays, the whole queue is
+ * intersected, then shaded, and the reflection rays it spawns form the
+ * compacted queue of the next bounce. Each stage is a tight loop over
+ * contiguous data split across threads, so the scene data and the kernels stay
+ * hot and the scattered reflection bounces are traced back to back. The
+ * threads are started once per render and take every stage in turn.
+ *
+ * The result matches the recursive pipeline: every path carries its
+ * throughput and adds its weighted surface colors to its sample, as
+ * TraceScene does for a single path. Depth and early
+ * termination come from the scene settings, with the same path seeds, so
+ * even Russian roulette makes the same decisions in both pipelines.
+ *
+ * Reflection rays leave curved surfaces in scattered directions. Optionally,
+ * before each reflection bounce the queue is sorted by direction octant, then
+ * by the Morton code of the origin in a 1024³ grid over the queue's bounds, so
+ * rays traced back to back start close together and travel the same way.
+ * WavefrontStats reports whether it paid off: the queues are spawned in
+ * scanline order, which is already coherent for the small scenes of this
+ * project, so the sort is off by default.
+ */
+class WavefrontRenderer {
+public:
+    /// Rays per batch: bands of rows are sized to roughly this many camera rays
+    static constexpr int BATCH_RAYS = 1 << 18;
+
+    /**
+     * @param scene Scene to trace against
+     * @param antiAliasing Sub-pixel grid used for the camera rays (same samples as SamplePixel)
+     * @param sortReflections Sort each reflection queue by Morton key before tracing it
+     */
+    WavefrontRenderer(const Scene& scene, const AntiAliasing& antiAliasing, bool sortReflections = false);
+
+    /**
+     * @brief Renders every pixel of the image
+     * @param image Output image, its size gives the resolution
+     * @param camOrigin Camera origin position
+     * @param lowerLeftCorner Lower-left corner of the viewport
+     * @param horizontal Horizontal viewport vector
+     * @param vertical Vertical viewport vector
+     * @param numThreads Threads used by each stage
+     * @param lightTiles Optional per-tile light lists for the camera hits; all lights otherwise
+     * @return Ray counts and reflection sorting counters
+     */
+    WavefrontStats Render(Image& image,
+                          const Vec3& camOrigin,
+                          const Vec3& lowerLeftCorner,
+                          const Vec3& horizontal,
+                          const Vec3& vertical,
+                          unsigned numThreads,
+                          const LightTiles* lightTiles = nullptr) const;
+
+private:
+    /// One path in flight: the ray to trace and what its color is worth to its sample
+    struct PathState {
+        Vec3A origin;
+        Vec3A direction;
+        float throughput;   // Product of the reflectivities along the path
+        int sample;         // Index of the sample in the batch accumulation buffer
+        RayCone cone;       // Footprint of the ray, for texture filtering
+    };
+
+    /**
+     * Reorders a reflection queue by (direction octant, Morton code of the origin).
+     * spawnOrder[i] receives the new position of the ray spawned i-th.
+     */
+    static void SortByMortonKey(std::vector<PathState>& queue, std::vector<PathState>& scratch,
+                                std::vector<std::uint32_t>& spawnOrder);
+
+    const Scene& scene_;
+    const AntiAliasing& antiAliasing_;
+    bool sortReflections_;
+};
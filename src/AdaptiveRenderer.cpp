@@ -0,0 +1,93 @@
+#include "AdaptiveRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "RowRunner.hpp"
+
+AdaptiveRenderer::AdaptiveRenderer(const Scene& scene, const AntiAliasing& antiAliasing)
+    : scene_(scene)
+    , antiAliasing_(antiAliasing)
+{
+}
+
+AdaptiveStats AdaptiveRenderer::Render(Image& image,
+                                       const Vec3& camOrigin,
+                                       const Vec3& lowerLeftCorner,
+                                       const Vec3& horizontal,
+                                       const Vec3& vertical,
+                                       unsigned numThreads,
+                                       const LightTiles* lightTiles,
+                                       std::vector<int>* sampleCounts) const
+{
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    const RenderSettings& settings = scene_.GetSettings();
+    const int totalSamples = antiAliasing_.GetTotalSamples();
+    const int batch = std::min(settings.adaptiveMinSamples, totalSamples);
+    const float thresholdSquared = settings.adaptiveThreshold * settings.adaptiveThreshold;
+    numThreads = std::max(numThreads, 1u);
+
+    std::vector<AntiAliasing::PixelSamples> pixels(static_cast<std::size_t>(width) * height);
+    std::vector<float> firstPass(pixels.size());
+    std::vector<PathStats> threadStats(numThreads);
+    std::vector<long long> threadRefined(numThreads, 0);
+
+    // Pass 1: the same small stratified set everywhere
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        PathStats* stats = &threadStats[t];
+        for (int i = 0; i < width; ++i)
+        {
+            const std::size_t index = static_cast<std::size_t>(j) * width + i;
+            antiAliasing_.AddSamples(pixels[index], batch, i, j, width, height,
+                                     camOrigin, lowerLeftCorner, horizontal, vertical, scene_, stats, lightTiles);
+            firstPass[index] = pixels[index].mean;
+        }
+    });
+
+    // Pass 2: refine where the pixel is noisy or stands out from a neighbor
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        PathStats* stats = &threadStats[t];
+        long long& refined = threadRefined[t];
+        for (int i = 0; i < width; ++i)
+        {
+            const std::size_t index = static_cast<std::size_t>(j) * width + i;
+            AntiAliasing::PixelSamples& pixel = pixels[index];
+
+            const float own = firstPass[index];
+            float contrast = 0.0f;
+            if (i > 0)          contrast = std::max(contrast, std::abs(own - firstPass[index - 1]));
+            if (i + 1 < width)  contrast = std::max(contrast, std::abs(own - firstPass[index + 1]));
+            if (j > 0)          contrast = std::max(contrast, std::abs(own - firstPass[index - width]));
+            if (j + 1 < height) contrast = std::max(contrast, std::abs(own - firstPass[index + width]));
+
+            bool refine = contrast > settings.adaptiveContrast || pixel.SquaredStandardError() > thresholdSquared;
+            if (refine && pixel.count < totalSamples)
+                ++refined;
+            while (refine && pixel.count < totalSamples)
+            {
+                antiAliasing_.AddSamples(pixel, batch, i, j, width, height,
+                                         camOrigin, lowerLeftCorner, horizontal, vertical, scene_, stats, lightTiles);
+                refine = pixel.SquaredStandardError() > thresholdSquared;
+            }
+            image.SetPixel(i, j, pixel.Average());
+        }
+    });
+
+    AdaptiveStats result;
+    for (unsigned t = 0; t < numThreads; ++t)
+    {
+        result.paths += threadStats[t];
+        result.refinedPixels += threadRefined[t];
+    }
+    if (sampleCounts)
+        sampleCounts->resize(pixels.size());
+    for (std::size_t k = 0; k < pixels.size(); ++k)
+    {
+        result.samples += pixels[k].count;
+        if (sampleCounts)
+            (*sampleCounts)[k] = pixels[k].count;
+    }
+    return result;
+}
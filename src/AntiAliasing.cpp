@@ -1,75 +1,233 @@
 #include "../include/AntiAliasing.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+
 #include "Color.hpp"
 #include "Ray.hpp"
-#include "Shape.hpp"
+#include "Scene.hpp"
 #include "Vec3.hpp"
+#include "Vec3A.hpp"
+
+namespace {
 
-AntiAliasing::AntiAliasing(int samplesPerAxis)
+// Cell centers of an n-cell axis, (k + 0.5) / n: the GridSampler offsets, computed at compile time
+template <int N>
+constexpr std::array<float, N> GridOffsets()
+{
+    std::array<float, N> offsets{};
+    for (int k = 0; k < N; ++k)
+        offsets[k] = (static_cast<float>(k) + 0.5f) * (1.0f / static_cast<float>(N));
+    return offsets;
+}
+
+} // namespace
+
+AntiAliasing::AntiAliasing(int samplesPerAxis, SamplerType samplerType, int samplesPerPixel)
     : samplesPerAxis_(samplesPerAxis)
-    , totalSamples_(samplesPerAxis * samplesPerAxis)
+    , totalSamples_(samplerType != SamplerType::Grid && samplesPerPixel > 0 ? samplesPerPixel : samplesPerAxis * samplesPerAxis)
     , invSamplesPerAxis_(1.0f / static_cast<float>(samplesPerAxis))
     , invTotalSamples_(1.0f / static_cast<float>(totalSamples_))
+    , sampleWidth_(samplerType == SamplerType::Grid ? invSamplesPerAxis_ : 1.0f / std::sqrt(static_cast<float>(totalSamples_)))
+    , sampler_(Sampler::Create(samplerType, totalSamples_))
+    , sampleOrder_(totalSamples_)
+    , samplePixel_(&AntiAliasing::SamplePixelGeneric)
 {
+    for (int i = 0; i < totalSamples_; ++i)
+        sampleOrder_[i] = i;
+    if (samplerType != SamplerType::Grid)
+        return;
+
+    // Grid specializations by samplesPerAxis, nullptr where there is none
+    static constexpr SamplePixelFn SPECIALIZATIONS[] = {
+        nullptr, &AntiAliasing::SampleGrid<1>, &AntiAliasing::SampleGrid<2>, nullptr,
+        &AntiAliasing::SampleGrid<4>, nullptr, nullptr, nullptr, &AntiAliasing::SampleGrid<8>,
+    };
+    if (samplesPerAxis_ >= 0 && samplesPerAxis_ < static_cast<int>(std::size(SPECIALIZATIONS))
+        && SPECIALIZATIONS[samplesPerAxis_] != nullptr)
+        samplePixel_ = SPECIALIZATIONS[samplesPerAxis_];
+
+    // Bayer rank of a cell: the low bits of its coordinates decide first
+    auto bayerRank = [](int x, int y) {
+        int rank = 0;
+        for (int bit = 0; bit < 15; ++bit)
+        {
+            const int xb = (x >> bit) & 1;
+            const int yb = (y >> bit) & 1;
+            rank |= (2 * (xb ^ yb) + yb) << (2 * (14 - bit));
+        }
+        return rank;
+    };
+    std::stable_sort(sampleOrder_.begin(), sampleOrder_.end(), [&](int a, int b) {
+        return bayerRank(a % samplesPerAxis_, a / samplesPerAxis_) < bayerRank(b % samplesPerAxis_, b / samplesPerAxis_);
+    });
 }
 
-Color AntiAliasing::SamplePixel(
+Radiance AntiAliasing::SamplePixelGeneric(
     int pixelX, int pixelY,
     int imageWidth, int imageHeight,
     const Vec3& camOrigin,
     const Vec3& lowerLeftCorner,
     const Vec3& horizontal,
     const Vec3& vertical,
-    const std::vector<std::unique_ptr<Shape>>& scene
+    const Scene& scene,
+    PathStats* stats,
+    const LightTiles* lightTiles
 ) const
 {
-    // Accumulate RGB values as raw floats to avoid premature clamping
-    // Color class clamps on addition, which breaks averaging
-    float r_accum = 0.0f;
-    float g_accum = 0.0f;
-    float b_accum = 0.0f;
+    // Unclamped accumulation; the tone-mapping stage handles values above 1
+    Radiance accum;
+
+    // Camera vectors in the aligned type used by the ray hot path
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+
+    // Footprint of the samples for texture filtering (none: point samples)
+    RayCone cone;
+    if (scene.GetSettings().textureFilter)
+        cone.spread = SampleSpread(imageHeight, camOrigin, lowerLeftCorner, horizontal, vertical);
+
+    // Every sample of the pixel lies in the same light tile
+    const LightSet primaryLights = lightTiles ? lightTiles->ForPixel(pixelX, pixelY) : scene.AllLights();
 
     // ==================== SUPERSAMPLING ANTI-ALIASING (SSAA) ====================
-    // Eliminates jagged edges by casting multiple rays per pixel in a regular grid
-    // Each sample is positioned at the center of its sub-pixel cell
+    // Eliminates jagged edges by casting multiple rays per pixel
+    // With the grid sampler each sample is positioned at the center of its sub-pixel cell
     //
     // Example for 4x4 grid: 16 rays evenly distributed across the pixel
     //   Offsets: 0.125, 0.375, 0.625, 0.875 (in each dimension)
     //
     // This smooths sphere edges by averaging colors at slightly different positions
-    for (int sampleY = 0; sampleY < samplesPerAxis_; ++sampleY)
+    for (int sample = 0; sample < totalSamples_; ++sample)
     {
-        for (int sampleX = 0; sampleX < samplesPerAxis_; ++sampleX)
-        {
-            // Calculate sub-pixel offset within [0, 1]
-            // Adding 0.5 centers each sample within its grid cell
-            float offsetX = (sampleX + 0.5f) * invSamplesPerAxis_;
-            float offsetY = (sampleY + 0.5f) * invSamplesPerAxis_;
+        // Sub-pixel offset within [0, 1]
+        float offsetX, offsetY;
+        SampleOffset(pixelX, pixelY, sample, offsetX, offsetY);
 
-            // Normalized screen coordinates [0, 1] with sub-pixel precision
-            float u_coord = (static_cast<float>(pixelX) + offsetX) / static_cast<float>(imageWidth - 1);
-            float v_coord = (static_cast<float>(pixelY) + offsetY) / static_cast<float>(imageHeight - 1);
+        // Normalized screen coordinates [0, 1] with sub-pixel precision
+        float u_coord = (static_cast<float>(pixelX) + offsetX) / static_cast<float>(imageWidth - 1);
+        float v_coord = (static_cast<float>(pixelY) + offsetY) / static_cast<float>(imageHeight - 1);
 
-            // Calculate point on virtual image plane
-            Vec3 pixelPos = lowerLeftCorner + horizontal * u_coord + vertical * v_coord;
+        // Calculate point on virtual image plane
+        Vec3A pixelPos = corner + horizontalA * u_coord + verticalA * v_coord;
+
+        // Ray direction from camera through this sub-pixel sample point
+        Vec3A rayDir = normalize(pixelPos - origin);
+
+        // Cast ray and accumulate color components
+        Ray ray(origin, rayDir, cone);
+        accum += ray.TraceScene(scene, PathSeed(pixelX, pixelY, imageWidth, sample), stats, &primaryLights);
+    }
+
+    // Average all samples
+    return accum * invTotalSamples_;
+}
+
+template <int SamplesPerAxis>
+Radiance AntiAliasing::SampleGrid(
+    int pixelX, int pixelY,
+    int imageWidth, int imageHeight,
+    const Vec3& camOrigin,
+    const Vec3& lowerLeftCorner,
+    const Vec3& horizontal,
+    const Vec3& vertical,
+    const Scene& scene,
+    PathStats* stats,
+    const LightTiles* lightTiles
+) const
+{
+    static constexpr std::array<float, SamplesPerAxis> OFFSETS = GridOffsets<SamplesPerAxis>();
 
-            // Ray direction from camera through this sub-pixel sample point
-            Vec3 rayDir = normalize(pixelPos - camOrigin);
+    Radiance accum;
 
-            // Cast ray and accumulate color components
-            Ray ray(camOrigin, rayDir);
-            Color sampleColor = ray.TraceScene(scene);
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
 
-            // Accumulate without clamping
-            r_accum += sampleColor.R();
-            g_accum += sampleColor.G();
-            b_accum += sampleColor.B();
+    RayCone cone;
+    if (scene.GetSettings().textureFilter)
+        cone.spread = SampleSpread(imageHeight, camOrigin, lowerLeftCorner, horizontal, vertical);
+
+    const LightSet primaryLights = lightTiles ? lightTiles->ForPixel(pixelX, pixelY) : scene.AllLights();
+
+    // The screen coordinates of a grid only take SamplesPerAxis values per axis; same expressions
+    // as the generic loop, so the rays are the same to the bit
+    std::array<float, SamplesPerAxis> u_coords, v_coords;
+    for (int k = 0; k < SamplesPerAxis; ++k)
+    {
+        u_coords[k] = (static_cast<float>(pixelX) + OFFSETS[k]) / static_cast<float>(imageWidth - 1);
+        v_coords[k] = (static_cast<float>(pixelY) + OFFSETS[k]) / static_cast<float>(imageHeight - 1);
+    }
+
+    // Row-major, the generic order: the sum and the path seeds match
+    for (int sy = 0; sy < SamplesPerAxis; ++sy)
+    {
+        for (int sx = 0; sx < SamplesPerAxis; ++sx)
+        {
+            const Vec3A rayDir = normalize(corner + horizontalA * u_coords[sx] + verticalA * v_coords[sy] - origin);
+            Ray ray(origin, rayDir, cone);
+            accum += ray.TraceScene(scene, PathSeed(pixelX, pixelY, imageWidth, sy * SamplesPerAxis + sx),
+                                    stats, &primaryLights);
         }
     }
 
-    // Average all samples and create final anti-aliased pixel color
-    // Clamping happens in Color constructor
-    return Color(r_accum * invTotalSamples_,
-                 g_accum * invTotalSamples_,
-                 b_accum * invTotalSamples_);
+    // 1 / SamplesPerAxis^2 is exact for the specialized counts, the product equals the generic one
+    return accum * (1.0f / static_cast<float>(SamplesPerAxis * SamplesPerAxis));
+}
+
+void AntiAliasing::AddSamples(
+    PixelSamples& pixel, int count,
+    int pixelX, int pixelY,
+    int imageWidth, int imageHeight,
+    const Vec3& camOrigin,
+    const Vec3& lowerLeftCorner,
+    const Vec3& horizontal,
+    const Vec3& vertical,
+    const Scene& scene,
+    PathStats* stats,
+    const LightTiles* lightTiles
+) const
+{
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+
+    RayCone cone;
+    if (scene.GetSettings().textureFilter)
+        cone.spread = SampleSpread(imageHeight, camOrigin, lowerLeftCorner, horizontal, vertical);
+
+    const LightSet primaryLights = lightTiles ? lightTiles->ForPixel(pixelX, pixelY) : scene.AllLights();
+
+    const int end = std::min(pixel.count + count, totalSamples_);
+    for (; pixel.count < end; ++pixel.count)
+    {
+        const int cell = sampleOrder_[pixel.count];
+        float offsetX, offsetY;
+        SampleOffset(pixelX, pixelY, cell, offsetX, offsetY);
+        const float u_coord = (static_cast<float>(pixelX) + offsetX) / static_cast<float>(imageWidth - 1);
+        const float v_coord = (static_cast<float>(pixelY) + offsetY) / static_cast<float>(imageHeight - 1);
+        const Vec3A rayDir = normalize(corner + horizontalA * u_coord + verticalA * v_coord - origin);
+
+        Ray ray(origin, rayDir, cone);
+        const Radiance sample = ray.TraceScene(scene, PathSeed(pixelX, pixelY, imageWidth, cell), stats, &primaryLights);
+        pixel.sum += sample;
+
+        const float luminance = std::min(0.2126f * sample.R() + 0.7152f * sample.G() + 0.0722f * sample.B(), 1.0f);
+        const float delta = luminance - pixel.mean;
+        pixel.mean += delta / static_cast<float>(pixel.count + 1);
+        pixel.m2 += delta * (luminance - pixel.mean);
+    }
+}
+
+float AntiAliasing::SampleSpread(int imageHeight, const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+                                 const Vec3& horizontal, const Vec3& vertical) const
+{
+    const float sampleSpacing = length(vertical) / static_cast<float>(imageHeight - 1) * sampleWidth_;
+    const float distance = length(lowerLeftCorner + horizontal * 0.5f + vertical * 0.5f - camOrigin);
+    return sampleSpacing / distance;
 }
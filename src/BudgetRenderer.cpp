@@ -0,0 +1,230 @@
+#include "BudgetRenderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <utility>
+#include "RowRunner.hpp"
+
+BudgetRenderer::BudgetRenderer(const Scene& scene, const AntiAliasing& antiAliasing)
+    : scene_(scene)
+    , antiAliasing_(antiAliasing)
+{
+}
+
+BudgetStats BudgetRenderer::Render(Image& image,
+                                   const Vec3& camOrigin,
+                                   const Vec3& lowerLeftCorner,
+                                   const Vec3& horizontal,
+                                   const Vec3& vertical,
+                                   unsigned numThreads,
+                                   const LightTiles* lightTiles,
+                                   std::vector<int>* sampleCounts) const
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const RenderSettings& settings = scene_.GetSettings();
+    const Clock::time_point deadline = start + std::chrono::milliseconds(settings.timeBudgetMs);
+
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    const int totalSamples = antiAliasing_.GetTotalSamples();
+    const int batch = std::min(settings.adaptiveMinSamples, totalSamples);
+    // A batch tops a pixel up to the next multiple of the batch size, where the stratified and
+    // low-discrepancy sets are balanced
+    auto batchFor = [&](int count) { return std::min(batch - count % batch, totalSamples - count); };
+    numThreads = std::max(numThreads, 1u);
+
+    std::vector<AntiAliasing::PixelSamples> pixels(static_cast<std::size_t>(width) * height);
+    std::vector<PathStats> threadStats(numThreads);
+    std::vector<long long> threadRefinements(numThreads, 0);
+
+    // Pass 1: one sample per pixel, coarse to fine in both directions so that a pass cut by the deadline still
+    // spreads over the frame: rows in bit-reversed order (0, 1/2, 1/4, 3/4, 1/8... of the height), and the
+    // pixels of each row likewise
+    auto coarseToFine = [](int count)
+    {
+        int bits = 0;
+        while ((1 << bits) < count)
+            ++bits;
+        std::vector<int> order;
+        order.reserve(count);
+        for (unsigned k = 0; k < (1u << bits); ++k)
+        {
+            unsigned reversed = 0;
+            for (int b = 0; b < bits; ++b)
+                reversed |= ((k >> b) & 1u) << (bits - 1 - b);
+            if (reversed < static_cast<unsigned>(count))
+                order.push_back(static_cast<int>(reversed));
+        }
+        return order;
+    };
+    const std::vector<int> rowOrder = coarseToFine(height);
+    const std::vector<int> columnOrder = coarseToFine(width);
+
+    RunRows(height, numThreads, [&](int r, unsigned t)
+    {
+        const int j = rowOrder[r];
+        for (int i : columnOrder)
+        {
+            if (Clock::now() >= deadline)
+                return;
+            antiAliasing_.AddSamples(pixels[static_cast<std::size_t>(j) * width + i], 1, i, j, width, height,
+                                     camOrigin, lowerLeftCorner, horizontal, vertical, scene_, &threadStats[t],
+                                     lightTiles);
+        }
+    });
+    const Clock::time_point firstPassEnd = Clock::now();
+
+    // Same tiles as the light lists
+    constexpr int TILE_SIZE = LightTiles::TILE_SIZE;
+    const int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Squared error a batch would remove from a tile; negative once every pixel is at the cap. A pixel short
+    // of one full batch has no reliable error estimate yet: its tile goes first
+    auto priority = [&](int tile)
+    {
+        const int x0 = (tile % tilesX) * TILE_SIZE;
+        const int y0 = (tile / tilesX) * TILE_SIZE;
+        float reduction = 0.0f;
+        bool open = false;
+        for (int j = y0; j < std::min(y0 + TILE_SIZE, height); ++j)
+        {
+            for (int i = x0; i < std::min(x0 + TILE_SIZE, width); ++i)
+            {
+                const AntiAliasing::PixelSamples& pixel = pixels[static_cast<std::size_t>(j) * width + i];
+                if (pixel.count >= totalSamples)
+                    continue;
+                open = true;
+                if (pixel.count < batch)
+                    return std::numeric_limits<float>::infinity();
+                const int added = batchFor(pixel.count);
+                reduction += pixel.SquaredStandardError() * static_cast<float>(added)
+                           / static_cast<float>(pixel.count + added);
+            }
+        }
+        return open ? reduction : -1.0f;
+    };
+
+    // Pass 2: worst tile first, until the deadline
+    std::priority_queue<std::pair<float, int>> queue;
+    for (int tile = 0; tile < tilesX * tilesY; ++tile)
+    {
+        const float p = priority(tile);
+        if (p >= 0.0f)
+            queue.emplace(p, tile);
+    }
+    std::mutex queueMutex;
+    RunThreads(numThreads, [&](unsigned t)
+    {
+        for (;;)
+        {
+            int tile;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (queue.empty())
+                    return;
+                tile = queue.top().second;
+                queue.pop();
+            }
+
+            const int x0 = (tile % tilesX) * TILE_SIZE;
+            const int y0 = (tile / tilesX) * TILE_SIZE;
+            for (int j = y0; j < std::min(y0 + TILE_SIZE, height); ++j)
+            {
+                for (int i = x0; i < std::min(x0 + TILE_SIZE, width); ++i)
+                {
+                    if (Clock::now() >= deadline)
+                        return;
+                    AntiAliasing::PixelSamples& pixel = pixels[static_cast<std::size_t>(j) * width + i];
+                    antiAliasing_.AddSamples(pixel, batchFor(pixel.count), i, j, width, height,
+                                             camOrigin, lowerLeftCorner, horizontal, vertical, scene_,
+                                             &threadStats[t], lightTiles);
+                }
+            }
+            ++threadRefinements[t];
+
+            // Only this thread holds the tile: its pixels are stable while the priority is computed
+            const float p = priority(tile);
+            if (p >= 0.0f)
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                queue.emplace(p, tile);
+            }
+        }
+    });
+
+    BudgetStats result;
+    for (unsigned t = 0; t < numThreads; ++t)
+    {
+        result.paths += threadStats[t];
+        result.tileRefinements += threadRefinements[t];
+    }
+
+    // Pixels the first pass did not reach show the nearest sampled pixel, found by spreading out from the
+    // sampled ones one step at a time (city-block distance); with no sample at all, the background
+    constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> shown(pixels.size(), NONE);
+    std::vector<std::size_t> frontier;
+    frontier.reserve(pixels.size());
+    for (std::size_t index = 0; index < pixels.size(); ++index)
+    {
+        if (pixels[index].count > 0)
+        {
+            shown[index] = index;
+            frontier.push_back(index);
+        }
+    }
+    for (std::size_t next = 0; next < frontier.size(); ++next)
+    {
+        const std::size_t index = frontier[next];
+        const int i = static_cast<int>(index % width);
+        const int j = static_cast<int>(index / width);
+        auto reach = [&](std::size_t neighbor)
+        {
+            if (shown[neighbor] != NONE)
+                return;
+            shown[neighbor] = shown[index];
+            frontier.push_back(neighbor);
+        };
+        if (i > 0)
+            reach(index - 1);
+        if (i + 1 < width)
+            reach(index + 1);
+        if (j > 0)
+            reach(index - width);
+        if (j + 1 < height)
+            reach(index + width);
+    }
+
+    result.tilesX = tilesX;
+    result.tilesY = tilesY;
+    result.tileSamples.assign(static_cast<std::size_t>(tilesX) * tilesY, 0.0f);
+    std::vector<int> tilePixels(result.tileSamples.size(), 0);
+    if (sampleCounts)
+        sampleCounts->resize(pixels.size());
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const std::size_t index = static_cast<std::size_t>(j) * width + i;
+            const std::size_t tile = static_cast<std::size_t>(j / TILE_SIZE) * tilesX + i / TILE_SIZE;
+            image.SetPixel(i, j, shown[index] != NONE ? pixels[shown[index]].Average() : Ray::BackgroundColor());
+            result.unsampledPixels += pixels[index].count == 0;
+            result.samples += pixels[index].count;
+            result.tileSamples[tile] += static_cast<float>(pixels[index].count);
+            ++tilePixels[tile];
+            if (sampleCounts)
+                (*sampleCounts)[index] = pixels[index].count;
+        }
+    }
+    for (std::size_t tile = 0; tile < result.tileSamples.size(); ++tile)
+        result.tileSamples[tile] /= static_cast<float>(tilePixels[tile]);
+
+    result.firstPassMs = std::chrono::duration<double, std::milli>(firstPassEnd - start).count();
+    result.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,94 @@
+#include "CpuFeatures.hpp"
+
+#include <cctype>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define RAYTRACER_HAS_CPUID 1
+#endif
+
+namespace {
+
+#ifdef RAYTRACER_HAS_CPUID
+// Register state enabled by the OS (XCR0). A CPU can advertise AVX while the
+// kernel does not save the YMM/ZMM registers, in which case AVX code faults.
+unsigned long long ReadXcr0()
+{
+    unsigned int eax = 0;
+    unsigned int edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+#endif
+
+} // namespace
+
+namespace CpuFeatures {
+
+IsaLevel DetectIsaLevel()
+{
+#ifdef RAYTRACER_HAS_CPUID
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return IsaLevel::Scalar;
+
+    const bool sse42 = (ecx & bit_SSE4_2) != 0;
+    const bool fma = (ecx & bit_FMA) != 0;
+    const bool osxsave = (ecx & bit_OSXSAVE) != 0;
+    const bool avx = (ecx & bit_AVX) != 0;
+
+    if (!sse42)
+        return IsaLevel::Scalar;
+    if (!osxsave || !avx)
+        return IsaLevel::SSE42;
+
+    const unsigned long long xcr0 = ReadXcr0();
+    const bool osYmm = (xcr0 & 0x6) == 0x6;    // XMM + YMM
+    const bool osZmm = (xcr0 & 0xe6) == 0xe6;  // XMM + YMM + opmask + ZMM
+
+    if (!osYmm || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return IsaLevel::SSE42;
+
+    const bool avx2 = (ebx & bit_AVX2) != 0;
+    const bool avx512 = (ebx & bit_AVX512F) && (ebx & bit_AVX512VL) && (ebx & bit_AVX512BW) && (ebx & bit_AVX512DQ);
+
+    if (!avx2 || !fma)
+        return IsaLevel::SSE42;
+    if (!avx512 || !osZmm)
+        return IsaLevel::AVX2;
+    return IsaLevel::AVX512;
+#else
+    return IsaLevel::Scalar;
+#endif
+}
+
+const char* IsaLevelName(IsaLevel level)
+{
+    switch (level)
+    {
+    case IsaLevel::Scalar: return "scalar";
+    case IsaLevel::SSE42:  return "sse4.2";
+    case IsaLevel::AVX2:   return "avx2";
+    case IsaLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool ParseIsaLevel(const std::string& name, IsaLevel& out)
+{
+    std::string key;
+    for (char c : name)
+    {
+        if (c != '.' && c != '-' && c != '_')
+            key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+
+    if (key == "scalar")      out = IsaLevel::Scalar;
+    else if (key == "sse42")  out = IsaLevel::SSE42;
+    else if (key == "avx2")   out = IsaLevel::AVX2;
+    else if (key == "avx512") out = IsaLevel::AVX512;
+    else return false;
+    return true;
+}
+
+} // namespace CpuFeatures
@@ -0,0 +1,211 @@
+#include "Denoiser.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "FastMath.hpp"
+#include "HitRecord.hpp"
+#include "Ray.hpp"
+#include "RowRunner.hpp"
+#include "Vec3A.hpp"
+
+namespace {
+
+// B3-spline taps, 1/16 (1 4 6 4 1)
+constexpr float KERNEL[5] = {1.0f / 16.0f, 4.0f / 16.0f, 6.0f / 16.0f, 4.0f / 16.0f, 1.0f / 16.0f};
+
+// 3x3 Gaussian taps, 1/4 (1 2 1)
+constexpr float GAUSSIAN3[3] = {0.25f, 0.5f, 0.25f};
+
+} // namespace
+
+DenoiseGuides DenoiseGuides::Trace(const Scene& scene, int width, int height,
+                                   const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+                                   const Vec3& horizontal, const Vec3& vertical,
+                                   unsigned numThreads)
+{
+    DenoiseGuides guides;
+    guides.width = width;
+    guides.height = height;
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    guides.shapes.assign(count, nullptr);
+    guides.normals.assign(count, Vec3(0.0f, 0.0f, 0.0f));
+    guides.depths.assign(count, 0.0f);
+
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+
+    RunRows(height, numThreads, [&](int j, unsigned)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const float u_coord = (static_cast<float>(i) + 0.5f) / static_cast<float>(width - 1);
+            const float v_coord = (static_cast<float>(j) + 0.5f) / static_cast<float>(height - 1);
+            const Ray ray(origin, normalize(corner + horizontalA * u_coord + verticalA * v_coord - origin));
+
+            HitRecord hit;
+            if (!ray.Intersect(scene, hit))
+                continue;
+            const std::size_t index = static_cast<std::size_t>(j) * width + i;
+            guides.shapes[index] = hit.shape;
+            guides.normals[index] = static_cast<Vec3>(hit.normal);
+            guides.depths[index] = hit.t;
+        }
+    });
+    return guides;
+}
+
+Denoiser::Denoiser(int iterations, float luminanceSigma)
+    : iterations_(iterations)
+    , luminanceSigma_(luminanceSigma)
+{
+}
+
+void Denoiser::Apply(Image& image, const DenoiseGuides& guides, const std::vector<float>& variances,
+                     unsigned numThreads) const
+{
+    const int width = guides.width;
+    const int height = guides.height;
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+
+    std::vector<Radiance> source(count);
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            source[static_cast<std::size_t>(j) * width + i] = image.GetPixel(i, j);
+    std::vector<Radiance> target(count);
+    std::vector<float> variance = variances;
+    std::vector<float> filteredVariance(count);
+    std::vector<float> deviation(count);
+    std::vector<float> luminance(count);
+
+    // Screen-space depth slope of each pixel, central differences on its own shape
+    std::vector<float> slopeX(count, 0.0f), slopeY(count, 0.0f);
+    auto slope = [&](std::size_t index, std::size_t before, std::size_t after, bool hasBefore, bool hasAfter) {
+        const Shape* shape = guides.shapes[index];
+        const bool b = hasBefore && guides.shapes[before] == shape;
+        const bool a = hasAfter && guides.shapes[after] == shape;
+        if (a && b)
+            return 0.5f * std::abs(guides.depths[after] - guides.depths[before]);
+        if (a)
+            return std::abs(guides.depths[after] - guides.depths[index]);
+        if (b)
+            return std::abs(guides.depths[index] - guides.depths[before]);
+        return 0.0f;
+    };
+    // Silhouette band: the pixels next to another shape are partly covered by it
+    std::vector<unsigned char> silhouette(count, 0);
+    RunRows(height, numThreads, [&](int j, unsigned)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const std::size_t index = static_cast<std::size_t>(j) * width + i;
+            const Shape* shape = guides.shapes[index];
+            silhouette[index] = (i > 0 && guides.shapes[index - 1] != shape)
+                             || (i + 1 < width && guides.shapes[index + 1] != shape)
+                             || (j > 0 && guides.shapes[index - width] != shape)
+                             || (j + 1 < height && guides.shapes[index + width] != shape);
+            if (shape == nullptr)
+                continue;
+            slopeX[index] = slope(index, index - 1, index + 1, i > 0, i + 1 < width);
+            slopeY[index] = slope(index, index - width, index + width, j > 0, j + 1 < height);
+        }
+    });
+
+    for (int iteration = 0; iteration < iterations_; ++iteration)
+    {
+        const int step = 1 << iteration;
+
+        // Luminance, clamped like the samples' variance: a highlight above white is not an edge against white
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const Radiance& c = source[index];
+            luminance[index] = std::min(0.2126f * c.R() + 0.7152f * c.G() + 0.0722f * c.B(), 1.0f);
+        }
+
+        // Noise level of each pixel: its variance blurred over the 3x3 neighbors on the same shape,
+        // a single sample's variance being itself noisy
+        RunRows(height, numThreads, [&](int j, unsigned)
+        {
+            for (int i = 0; i < width; ++i)
+            {
+                const std::size_t center = static_cast<std::size_t>(j) * width + i;
+                float sum = 0.0f, weightSum = 0.0f;
+                for (int y = std::max(j - 1, 0); y <= std::min(j + 1, height - 1); ++y)
+                {
+                    for (int x = std::max(i - 1, 0); x <= std::min(i + 1, width - 1); ++x)
+                    {
+                        const std::size_t tap = static_cast<std::size_t>(y) * width + x;
+                        if (guides.shapes[tap] != guides.shapes[center])
+                            continue;
+                        const float weight = GAUSSIAN3[y - j + 1] * GAUSSIAN3[x - i + 1];
+                        sum += variance[tap] * weight;
+                        weightSum += weight;
+                    }
+                }
+                deviation[center] = std::sqrt(sum / weightSum);
+            }
+        });
+
+        RunRows(height, numThreads, [&](int j, unsigned)
+        {
+            for (int i = 0; i < width; ++i)
+            {
+                const std::size_t center = static_cast<std::size_t>(j) * width + i;
+                const Shape* shape = guides.shapes[center];
+                const unsigned char band = silhouette[center];
+                const Vec3& normal = guides.normals[center];
+                const float depth = guides.depths[center];
+                const float lum = luminance[center];
+                const float invLuminanceScale = 1.0f / (luminanceSigma_ * deviation[center] + LUMINANCE_EPSILON);
+
+                Radiance sum;
+                float weightSum = 0.0f, varianceSum = 0.0f;
+                for (int ky = 0; ky < 5; ++ky)
+                {
+                    const int y = j + (ky - 2) * step;
+                    if (y < 0 || y >= height)
+                        continue;
+                    for (int kx = 0; kx < 5; ++kx)
+                    {
+                        const int x = i + (kx - 2) * step;
+                        if (x < 0 || x >= width)
+                            continue;
+                        const std::size_t tap = static_cast<std::size_t>(y) * width + x;
+                        if (guides.shapes[tap] != shape || silhouette[tap] != band)
+                            continue;
+
+                        // Every term goes into one exponent, a single FastMath::Exp2 per tap
+                        float exponent = std::abs(luminance[tap] - lum) * invLuminanceScale;
+                        float weight = KERNEL[kx] * KERNEL[ky];
+                        if (shape != nullptr)
+                        {
+                            // max(0, dot)^64 by six squarings
+                            float n = std::max(0.0f, dot(normal, guides.normals[tap]));
+                            n *= n; n *= n; n *= n; n *= n; n *= n; n *= n;
+                            weight *= n;
+                            const float expected = std::abs(static_cast<float>(x - i)) * slopeX[center]
+                                                 + std::abs(static_cast<float>(y - j)) * slopeY[center];
+                            exponent += std::abs(guides.depths[tap] - depth) / (DEPTH_SIGMA * expected + DEPTH_EPSILON * depth);
+                        }
+                        weight *= FastMath::Exp2(-exponent * 1.44269504f);
+
+                        sum += source[tap] * weight;
+                        weightSum += weight;
+                        varianceSum += weight * weight * variance[tap];
+                    }
+                }
+                // The center tap always counts, weightSum > 0
+                target[center] = sum * (1.0f / weightSum);
+                // Variance of the weighted mean: the next, wider pass sees less noise
+                filteredVariance[center] = varianceSum / (weightSum * weightSum);
+            }
+        });
+        std::swap(source, target);
+        std::swap(variance, filteredVariance);
+    }
+
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            image.SetPixel(i, j, source[static_cast<std::size_t>(j) * width + i]);
+}
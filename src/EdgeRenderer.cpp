@@ -0,0 +1,305 @@
+#include "EdgeRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "Cube.hpp"
+#include "Plane.hpp"
+#include "RowRunner.hpp"
+#include "Sphere.hpp"
+#include "Vec3A.hpp"
+
+namespace {
+
+// Reflectivity as ShadeSurface reads it, before Fresnel
+float BaseReflectivity(const Shape* shape)
+{
+    if (const Sphere* sphere = dynamic_cast<const Sphere*>(shape))
+        return sphere->GetReflectivity();
+    if (const Cube* cube = dynamic_cast<const Cube*>(shape))
+        return cube->GetReflectivity();
+    if (const Plane* plane = dynamic_cast<const Plane*>(shape))
+        return plane->reflectivity;
+    return 0.0f;
+}
+
+int CellOf(const HitRecord& hit)
+{
+    return dynamic_cast<const Plane*>(hit.shape) ? Ray::CheckerCell(static_cast<Vec3>(hit.point)) : 0;
+}
+
+// Area and centroid of the unit pixel's part on one side of g0 + gx * dx + gy * dy = 0 (Sutherland-Hodgman, shoelace)
+void ClipPixel(float g0, float gx, float gy, float side, float& area, float& cx, float& cy)
+{
+    constexpr float CORNERS[4][2] = {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}};
+    float px[8], py[8];
+    int n = 0;
+    for (int k = 0; k < 4; ++k)
+    {
+        const float* p = CORNERS[k];
+        const float* q = CORNERS[(k + 1) % 4];
+        const float gp = side * (g0 + gx * p[0] + gy * p[1]);
+        const float gq = side * (g0 + gx * q[0] + gy * q[1]);
+        if (gp >= 0.0f)
+        {
+            px[n] = p[0];
+            py[n++] = p[1];
+        }
+        if ((gp >= 0.0f) != (gq >= 0.0f))
+        {
+            const float t = gp / (gp - gq);
+            px[n] = p[0] + (q[0] - p[0]) * t;
+            py[n++] = p[1] + (q[1] - p[1]) * t;
+        }
+    }
+
+    float twiceArea = 0.0f, mx = 0.0f, my = 0.0f;
+    for (int k = 0; k < n; ++k)
+    {
+        const int l = (k + 1) % n;
+        const float cross = px[k] * py[l] - px[l] * py[k];
+        twiceArea += cross;
+        mx += (px[k] + px[l]) * cross;
+        my += (py[k] + py[l]) * cross;
+    }
+    area = 0.5f * twiceArea;
+    cx = twiceArea > 0.0f ? mx / (3.0f * twiceArea) : 0.0f;
+    cy = twiceArea > 0.0f ? my / (3.0f * twiceArea) : 0.0f;
+}
+
+} // namespace
+
+EdgeRenderer::Coverage EdgeRenderer::PixelCoverage(float g0, float gx, float gy)
+{
+    Coverage coverage;
+    float outside = 0.0f;
+    ClipPixel(g0, gx, gy, 1.0f, coverage.inside, coverage.insideX, coverage.insideY);
+    ClipPixel(g0, gx, gy, -1.0f, outside, coverage.outsideX, coverage.outsideY);
+    coverage.inside = std::clamp(coverage.inside, 0.0f, 1.0f);
+    return coverage;
+}
+
+EdgeRenderer::EdgeRenderer(const Scene& scene, const AntiAliasing& antiAliasing)
+    : scene_(scene)
+    , antiAliasing_(antiAliasing)
+{
+}
+
+EdgeStats EdgeRenderer::Render(Image& image,
+                               const Vec3& camOrigin,
+                               const Vec3& lowerLeftCorner,
+                               const Vec3& horizontal,
+                               const Vec3& vertical,
+                               unsigned numThreads,
+                               const LightTiles* lightTiles,
+                               std::vector<int>* sampleCounts) const
+{
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    const RenderSettings& settings = scene_.GetSettings();
+    numThreads = std::max(numThreads, 1u);
+
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+
+    // The center sample stands for the whole pixel: its cone is sqrt(samples) times wider
+    const float pixelSpread = antiAliasing_.SampleSpread(height, camOrigin, lowerLeftCorner, horizontal, vertical)
+                            * std::sqrt(static_cast<float>(antiAliasing_.GetTotalSamples()));
+    RayCone cone;
+    if (settings.textureFilter)
+        cone.spread = pixelSpread;
+
+    std::vector<SurfaceId> surfaces(static_cast<std::size_t>(width) * height);
+    std::vector<int> counts(surfaces.size(), 1);
+    std::vector<PathStats> threadStats(numThreads);
+    std::vector<long long> threadEdges(numThreads, 0);
+    std::vector<long long> threadCoverage(numThreads, 0);
+
+    // Pass 1: one ray through each pixel center, color and surface record
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        PathStats* stats = &threadStats[t];
+        for (int i = 0; i < width; ++i)
+        {
+            const float u_coord = (static_cast<float>(i) + 0.5f) / static_cast<float>(width - 1);
+            const float v_coord = (static_cast<float>(j) + 0.5f) / static_cast<float>(height - 1);
+            const Ray ray(origin, normalize(corner + horizontalA * u_coord + verticalA * v_coord - origin), cone);
+
+            // The path's own first hit fills the record, no second intersection
+            const LightSet primaryLights = lightTiles ? lightTiles->ForPixel(i, j) : scene_.AllLights();
+            HitRecord hit;
+            image.SetPixel(i, j, ray.TraceScene(scene_, antiAliasing_.PathSeed(i, j, width, 0), stats, &primaryLights,
+                                                &hit));
+
+            SurfaceId& surface = surfaces[static_cast<std::size_t>(j) * width + i];
+            if (!hit.shape)
+                continue;
+            surface.shape = hit.shape;
+            surface.cell = CellOf(hit);
+            surface.normal = static_cast<Vec3>(hit.normal);
+            if (dynamic_cast<const Plane*>(hit.shape))
+            {
+                // Pixel footprint on the floor, stretched at grazing angles; Nyquist: a cell needs two pixels
+                const float cosIncidence = std::max(std::abs(dot(ray.GetDirection(), hit.normal)), 0.02f);
+                surface.undersampled = pixelSpread * hit.t / cosIncidence > 0.5f * Ray::CheckerCellSize();
+            }
+
+            if (BaseReflectivity(hit.shape) > 0.0f && settings.maxDepth > 1)
+            {
+                HitRecord mirrored;
+                if (ray.Reflected(hit).Intersect(scene_, mirrored))
+                {
+                    surface.reflected = mirrored.shape;
+                    surface.reflectedCell = CellOf(mirrored);
+                }
+            }
+        }
+    });
+
+    // Ray through a point of the image, in pixels from its lower-left corner
+    auto cameraRay = [&](float x, float y)
+    {
+        const float u_coord = x / static_cast<float>(width - 1);
+        const float v_coord = y / static_cast<float>(height - 1);
+        return Ray(origin, normalize(corner + horizontalA * u_coord + verticalA * v_coord - origin), cone);
+    };
+
+    // Angle between the ray through (x, y) and the cone of directions that meet the sphere, positive inside;
+    // nearly linear in x and y, unlike the cosine
+    auto silhouette = [&](const Sphere& sphere, float x, float y)
+    {
+        const Vec3 toCenter = sphere.GetCenter() - camOrigin;
+        const float distance = length(toCenter);
+        const Vec3 axis = toCenter / distance;
+        const Vec3 direction = normalize(lowerLeftCorner + horizontal * (x / static_cast<float>(width - 1))
+                                         + vertical * (y / static_cast<float>(height - 1)) - camOrigin);
+        const float cosTheta = dot(direction, axis);
+        return std::asin(sphere.GetRadius() / distance) - std::atan2(length(direction - axis * cosTheta), cosTheta);
+    };
+
+    // Samples of pixel (i, j) spent on a lone sphere silhouette, 0 if it takes the grid
+    auto coverPixel = [&](int i, int j, PathStats* stats) -> int
+    {
+        const std::size_t index = static_cast<std::size_t>(j) * width + i;
+        int sampleCount = 0;
+        std::size_t sampleIndex[5];
+        sampleIndex[sampleCount++] = index;
+        if (i > 0) sampleIndex[sampleCount++] = index - 1;
+        if (i + 1 < width) sampleIndex[sampleCount++] = index + 1;
+        if (j > 0) sampleIndex[sampleCount++] = index - width;
+        if (j + 1 < height) sampleIndex[sampleCount++] = index + width;
+
+        for (int c = 0; c < sampleCount; ++c)
+        {
+            const Sphere* sphere = dynamic_cast<const Sphere*>(surfaces[sampleIndex[c]].shape);
+            if (!sphere || sphere->GetReflectivity() > 0.0f || length(sphere->GetCenter() - camOrigin) <= sphere->GetRadius())
+                continue;
+
+            // The samples on the sphere are inside its cone, all the others outside, each side one surface
+            const SurfaceId* onSphere = nullptr;
+            const SurfaceId* behind = nullptr;
+            bool split = true;
+            for (int k = 0; k < sampleCount && split; ++k)
+            {
+                const std::size_t s = sampleIndex[k];
+                const SurfaceId& surface = surfaces[s];
+                const bool inside = surface.shape == sphere;
+                const float g = silhouette(*sphere, static_cast<float>(s % width) + 0.5f,
+                                           static_cast<float>(s / width) + 0.5f);
+                const SurfaceId*& side = inside ? onSphere : behind;
+                split = (g > 0.0f) == inside && !surface.undersampled && (!side || !side->DiffersFrom(surface));
+                if (!side)
+                    side = &surface;
+            }
+            if (!split || !behind)
+                continue;
+
+            // Straight across the pixel: the center agrees with the corners
+            const float x = static_cast<float>(i) + 0.5f;
+            const float y = static_cast<float>(j) + 0.5f;
+            const float g0 = silhouette(*sphere, x, y);
+            const float g00 = silhouette(*sphere, x - 0.5f, y - 0.5f);
+            const float g10 = silhouette(*sphere, x + 0.5f, y - 0.5f);
+            const float g01 = silhouette(*sphere, x - 0.5f, y + 0.5f);
+            const float g11 = silhouette(*sphere, x + 0.5f, y + 0.5f);
+            const float gx = 0.5f * (g10 + g11 - g00 - g01);
+            const float gy = 0.5f * (g01 + g11 - g00 - g10);
+            const float gradient = std::sqrt(gx * gx + gy * gy);
+            if (gradient <= 0.0f
+                || std::abs(0.25f * (g00 + g10 + g01 + g11) - g0) > MAX_BEND * gradient
+                || std::abs(0.25f * (g00 - g10 - g01 + g11)) > MAX_BEND * gradient)
+                return 0;
+
+            const Coverage coverage = PixelCoverage(g0, gx, gy);
+            const bool centerInside = surfaces[index].shape == sphere;
+            const float centerShare = centerInside ? coverage.inside : 1.0f - coverage.inside;
+            if (centerShare >= 1.0f - MIN_COVERAGE)
+                return 1;
+
+            // One ray at the centroid of the other side, which must see that side's surface; checked with a bare
+            // intersection so that a pixel sent back to the grid has not paid for a whole path
+            const Ray other = centerInside ? cameraRay(x + coverage.outsideX, y + coverage.outsideY)
+                                           : cameraRay(x + coverage.insideX, y + coverage.insideY);
+            HitRecord hit;
+            const bool hits = other.Intersect(scene_, hit);
+            const SurfaceId& expected = centerInside ? *behind : *onSphere;
+            if ((hits ? hit.shape : nullptr) != expected.shape || (hits && CellOf(hit) != expected.cell))
+                return 0;
+
+            const LightSet primaryLights = lightTiles ? lightTiles->ForPixel(i, j) : scene_.AllLights();
+            const Radiance otherColor = other.TraceScene(scene_, antiAliasing_.PathSeed(i, j, width, 1), stats,
+                                                         &primaryLights);
+            image.SetPixel(i, j, image.GetPixel(i, j) * centerShare + otherColor * (1.0f - centerShare));
+            return 2;
+        }
+        return 0;
+    };
+
+    // Pass 2: full grid where a neighbor sees something else
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        PathStats* stats = &threadStats[t];
+        long long& edges = threadEdges[t];
+        long long& covered = threadCoverage[t];
+        for (int i = 0; i < width; ++i)
+        {
+            const std::size_t index = static_cast<std::size_t>(j) * width + i;
+            const SurfaceId& surface = surfaces[index];
+            const bool edge = (i > 0 && surface.DiffersFrom(surfaces[index - 1]))
+                           || (i + 1 < width && surface.DiffersFrom(surfaces[index + 1]))
+                           || (j > 0 && surface.DiffersFrom(surfaces[index - width]))
+                           || (j + 1 < height && surface.DiffersFrom(surfaces[index + width]));
+            if (!edge)
+                continue;
+
+            if (settings.coverageAA)
+            {
+                if (const int samples = coverPixel(i, j, stats))
+                {
+                    counts[index] = samples;
+                    ++covered;
+                    continue;
+                }
+            }
+
+            image.SetPixel(i, j, antiAliasing_.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                           horizontal, vertical, scene_, stats, lightTiles));
+            counts[index] = 1 + antiAliasing_.GetTotalSamples();
+            ++edges;
+        }
+    });
+
+    EdgeStats result;
+    for (unsigned t = 0; t < numThreads; ++t)
+    {
+        result.paths += threadStats[t];
+        result.edgePixels += threadEdges[t];
+        result.coveragePixels += threadCoverage[t];
+    }
+    for (int count : counts)
+        result.samples += count;
+    if (sampleCounts)
+        *sampleCounts = std::move(counts);
+    return result;
+}
@@ -0,0 +1,172 @@
+#include "Film.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Mitchell-Netravali parameters recommended by the paper
+constexpr float MITCHELL_B = 1.0f / 3.0f;
+constexpr float MITCHELL_C = 1.0f / 3.0f;
+
+constexpr float GAUSSIAN_SIGMA = 0.5f;
+
+// Pixels a splat can reach along one axis: 2 * MAX_RADIUS + 1, one more for the rounding
+constexpr int MAX_FOOTPRINT = static_cast<int>(2.0f * ReconstructionFilter::MAX_RADIUS) + 2;
+
+} // namespace
+
+ReconstructionFilter::ReconstructionFilter(PixelFilter type, float radius)
+    : type_(type)
+    , radius_(radius > 0.0f ? radius : DefaultRadius(type))
+{
+    if (radius < 0.0f || radius > MAX_RADIUS)
+        throw std::invalid_argument("The filter radius must be in [0, 8] pixels");
+    invRadius_ = 1.0f / radius_;
+    gaussianFloor_ = std::exp(-radius_ * radius_ / (2.0f * GAUSSIAN_SIGMA * GAUSSIAN_SIGMA));
+    tableScale_ = static_cast<float>(TABLE_SIZE) / radius_;
+    for (int k = 0; k <= TABLE_SIZE; ++k)
+        table_[k] = Evaluate1D(static_cast<float>(k) / tableScale_);
+}
+
+float ReconstructionFilter::DefaultRadius(PixelFilter type)
+{
+    switch (type)
+    {
+    case PixelFilter::Box:
+        return 0.5f;
+    case PixelFilter::Gaussian:
+        return 1.5f;
+    case PixelFilter::Mitchell:
+    case PixelFilter::BlackmanHarris:
+        return 2.0f;
+    }
+    return 0.5f;
+}
+
+float ReconstructionFilter::Evaluate1D(float dx) const
+{
+    dx = std::abs(dx);
+    if (dx > radius_)
+        return 0.0f;
+
+    switch (type_)
+    {
+    case PixelFilter::Box:
+        return 1.0f;
+    case PixelFilter::Gaussian:
+        return std::max(0.0f, std::exp(-dx * dx / (2.0f * GAUSSIAN_SIGMA * GAUSSIAN_SIGMA)) - gaussianFloor_);
+    case PixelFilter::Mitchell:
+    {
+        // The cubic spans [-2, 2]: stretch it over the radius
+        const float x = 2.0f * dx * invRadius_;
+        constexpr float B = MITCHELL_B, C = MITCHELL_C;
+        if (x > 1.0f)
+            return ((-B - 6.0f * C) * x * x * x + (6.0f * B + 30.0f * C) * x * x
+                    + (-12.0f * B - 48.0f * C) * x + (8.0f * B + 24.0f * C)) * (1.0f / 6.0f);
+        return ((12.0f - 9.0f * B - 6.0f * C) * x * x * x + (-18.0f + 12.0f * B + 6.0f * C) * x * x
+                + (6.0f - 2.0f * B)) * (1.0f / 6.0f);
+    }
+    case PixelFilter::BlackmanHarris:
+    {
+        // Window centered on the sample, 1 at 0 and about 6e-5 at the radius
+        const float t = static_cast<float>(M_PI) * dx * invRadius_;
+        return 0.35875f + 0.48829f * std::cos(t) + 0.14128f * std::cos(2.0f * t) + 0.01168f * std::cos(3.0f * t);
+    }
+    }
+    return 0.0f;
+}
+
+FilmTile::FilmTile(int x0, int y0, int x1, int y1, const ReconstructionFilter& filter, int width, int height)
+    : filter_(filter)
+{
+    // Pixel p (center p + 0.5) is reached by samples within the radius of its center
+    const float radius = filter.GetRadius();
+    bufferX0_ = std::max(0, static_cast<int>(std::floor(static_cast<float>(x0) - 0.5f - radius)));
+    bufferY0_ = std::max(0, static_cast<int>(std::floor(static_cast<float>(y0) - 0.5f - radius)));
+    const int bufferX1 = std::min(width, static_cast<int>(std::floor(static_cast<float>(x1) - 0.5f + radius)) + 1);
+    const int bufferY1 = std::min(height, static_cast<int>(std::floor(static_cast<float>(y1) - 0.5f + radius)) + 1);
+    bufferWidth_ = bufferX1 - bufferX0_;
+    bufferHeight_ = bufferY1 - bufferY0_;
+    sums_.resize(static_cast<std::size_t>(bufferWidth_) * bufferHeight_);
+    weights_.resize(sums_.size(), 0.0f);
+}
+
+void FilmTile::AddSample(float filmX, float filmY, const Radiance& radiance)
+{
+    const float radius = filter_.GetRadius();
+    const int px0 = std::max(bufferX0_, static_cast<int>(std::ceil(filmX - 0.5f - radius)));
+    const int py0 = std::max(bufferY0_, static_cast<int>(std::ceil(filmY - 0.5f - radius)));
+    const int px1 = std::min(bufferX0_ + bufferWidth_ - 1, static_cast<int>(std::floor(filmX - 0.5f + radius)));
+    const int py1 = std::min(bufferY0_ + bufferHeight_ - 1, static_cast<int>(std::floor(filmY - 0.5f + radius)));
+    if (px0 > px1 || py0 > py1)
+        return;
+
+    // Separable: one weight per column and per row of the footprint
+    std::array<float, MAX_FOOTPRINT> weightsX, weightsY;
+    for (int px = px0; px <= px1; ++px)
+        weightsX[px - px0] = filter_.Weight1D(static_cast<float>(px) + 0.5f - filmX);
+    for (int py = py0; py <= py1; ++py)
+        weightsY[py - py0] = filter_.Weight1D(static_cast<float>(py) + 0.5f - filmY);
+
+    for (int py = py0; py <= py1; ++py)
+    {
+        const std::size_t row = static_cast<std::size_t>(py - bufferY0_) * bufferWidth_;
+        for (int px = px0; px <= px1; ++px)
+        {
+            const float weight = weightsX[px - px0] * weightsY[py - py0];
+            const std::size_t index = row + (px - bufferX0_);
+            sums_[index] += radiance * weight;
+            weights_[index] += weight;
+        }
+    }
+}
+
+Film::Film(int width, int height, const ReconstructionFilter& filter)
+    : width_(width)
+    , height_(height)
+    , filter_(filter)
+    , sums_(static_cast<std::size_t>(width) * height)
+    , weights_(sums_.size(), 0.0f)
+{
+}
+
+FilmTile Film::MakeTile(int x0, int y0, int x1, int y1) const
+{
+    return FilmTile(x0, y0, x1, y1, filter_, width_, height_);
+}
+
+void Film::MergeTile(const FilmTile& tile)
+{
+    for (int j = 0; j < tile.bufferHeight_; ++j)
+    {
+        const std::size_t source = static_cast<std::size_t>(j) * tile.bufferWidth_;
+        const std::size_t target = static_cast<std::size_t>(tile.bufferY0_ + j) * width_ + tile.bufferX0_;
+        for (int i = 0; i < tile.bufferWidth_; ++i)
+        {
+            sums_[target + i] += tile.sums_[source + i];
+            weights_[target + i] += tile.weights_[source + i];
+        }
+    }
+}
+
+void Film::Resolve(Image& image) const
+{
+    for (int j = 0; j < height_; ++j)
+    {
+        for (int i = 0; i < width_; ++i)
+        {
+            const std::size_t index = static_cast<std::size_t>(j) * width_ + i;
+            // Mitchell's negative lobes can leave a pixel without positive weight; nothing to show then
+            if (weights_[index] <= 0.0f)
+            {
+                image.SetPixel(i, j, Radiance());
+                continue;
+            }
+            const Radiance value = sums_[index] * (1.0f / weights_[index]);
+            image.SetPixel(i, j, Radiance(std::max(value.R(), 0.0f), std::max(value.G(), 0.0f), std::max(value.B(), 0.0f)));
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include "FilmRenderer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "RowRunner.hpp"
+#include "Vec3A.hpp"
+
+FilmRenderer::FilmRenderer(const Scene& scene, const AntiAliasing& antiAliasing, const ReconstructionFilter& filter)
+    : scene_(scene)
+    , antiAliasing_(antiAliasing)
+    , filter_(filter)
+{
+}
+
+FilmStats FilmRenderer::Render(Image& image,
+                               const Vec3& camOrigin,
+                               const Vec3& lowerLeftCorner,
+                               const Vec3& horizontal,
+                               const Vec3& vertical,
+                               unsigned numThreads,
+                               const LightTiles* lightTiles) const
+{
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    const int totalSamples = antiAliasing_.GetTotalSamples();
+    numThreads = std::max(numThreads, 1u);
+
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+
+    RayCone cone;
+    if (scene_.GetSettings().textureFilter)
+        cone.spread = antiAliasing_.SampleSpread(height, camOrigin, lowerLeftCorner, horizontal, vertical);
+
+    // Same tiles as the light lists: one list per tile
+    constexpr int TILE_SIZE = LightTiles::TILE_SIZE;
+    const int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const int tileCount = tilesX * tilesY;
+
+    Film film(width, height, filter_);
+    std::vector<PathStats> threadStats(numThreads);
+
+    // Finished tiles waiting for an earlier one, and the next tile to merge
+    std::vector<std::unique_ptr<FilmTile>> pending(tileCount);
+    int nextMerge = 0;
+    std::mutex mergeMutex;
+
+    RunRows(tileCount, numThreads, [&](int tile, unsigned t)
+    {
+        const int x0 = (tile % tilesX) * TILE_SIZE;
+        const int y0 = (tile / tilesX) * TILE_SIZE;
+        const int x1 = std::min(x0 + TILE_SIZE, width);
+        const int y1 = std::min(y0 + TILE_SIZE, height);
+        auto filmTile = std::make_unique<FilmTile>(film.MakeTile(x0, y0, x1, y1));
+        const LightSet primaryLights = lightTiles ? lightTiles->ForPixel(x0, y0) : scene_.AllLights();
+
+        for (int j = y0; j < y1; ++j)
+        {
+            for (int i = x0; i < x1; ++i)
+            {
+                for (int sample = 0; sample < totalSamples; ++sample)
+                {
+                    float offsetX, offsetY;
+                    antiAliasing_.SampleOffset(i, j, sample, offsetX, offsetY);
+                    const float u_coord = (static_cast<float>(i) + offsetX) / static_cast<float>(width - 1);
+                    const float v_coord = (static_cast<float>(j) + offsetY) / static_cast<float>(height - 1);
+                    const Ray ray(origin, normalize(corner + horizontalA * u_coord + verticalA * v_coord - origin), cone);
+                    const Radiance radiance = ray.TraceScene(scene_, antiAliasing_.PathSeed(i, j, width, sample),
+                                                             &threadStats[t], &primaryLights);
+                    filmTile->AddSample(static_cast<float>(i) + offsetX, static_cast<float>(j) + offsetY, radiance);
+                }
+            }
+        }
+
+        // Merged as soon as every tile before it is, always in tile order: the sums are reproducible and
+        // only the tiles waiting for a slower one stay in memory
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        pending[tile] = std::move(filmTile);
+        for (; nextMerge < tileCount && pending[nextMerge]; ++nextMerge)
+        {
+            film.MergeTile(*pending[nextMerge]);
+            pending[nextMerge].reset();
+        }
+    });
+    film.Resolve(image);
+
+    FilmStats result;
+    for (const PathStats& stats : threadStats)
+        result.paths += stats;
+    result.samples = static_cast<long long>(width) * height * totalSamples;
+    result.tiles = tileCount;
+    return result;
+}
@@ -1,6 +1,10 @@
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <thread>
 #include "Image.hpp"
+#include "Kernels.hpp"
+#include "MathUtils.hpp"
 #include "lodepng.h"
 
 Image::Image(unsigned int w, unsigned int h) : width(w), height(h)
@@ -8,11 +12,11 @@ Image::Image(unsigned int w, unsigned int h) : width(w), height(h)
     buffer.resize(width * height);
     for (auto &i : buffer)
     {
-        i = Color();
+        i = Radiance();
     }
 }
 
-Image::Image(unsigned int w, unsigned int h, Color c) : width(w), height(h)
+Image::Image(unsigned int w, unsigned int h, Radiance c) : width(w), height(h)
 {
     buffer.resize(width * height);
     for (auto &i : buffer)
@@ -23,7 +27,7 @@ Image::Image(unsigned int w, unsigned int h, Color c) : width(w), height(h)
 
 Image::~Image() = default;
 
-void Image::SetPixel(unsigned int x, unsigned int y, Color color)
+void Image::SetPixel(unsigned int x, unsigned int y, Radiance color)
 {
     unsigned int index = (y * width) + x;
 
@@ -34,7 +38,7 @@ void Image::SetPixel(unsigned int x, unsigned int y, Color color)
     buffer[index] = color;
 }
 
-Color Image::GetPixel(unsigned int x, unsigned int y)
+Radiance Image::GetPixel(unsigned int x, unsigned int y) const
 {
     unsigned int index = (y * width) + x;
 
@@ -55,22 +59,111 @@ int Image::GetHeight()
     return height;
 }
 
-void Image::WriteFile(const char *filename) const
+namespace
 {
-    std::vector<unsigned char> image;
-    image.resize(width * height * 4);
-    for (unsigned index = 0; index < buffer.size(); index++)
+    // Table 12 bits -> 8 bits pour une courbe de transfert, construite une seule fois.
+    // Erreur max : 0.5 LSB d'arrondi + l'écart entre deux entrées (< 0.8 LSB pour sRGB près de 0).
+    const unsigned char *TransferLut(TransferCurve curve)
     {
-        Color pixel = buffer[index];
-        int offset = index * 4;
+        auto build = [](float (*encode)(float))
+        {
+            std::vector<unsigned char> lut(TRANSFER_LUT_SIZE);
+            for (int i = 0; i < TRANSFER_LUT_SIZE; ++i)
+            {
+                float v = encode(static_cast<float>(i) / (TRANSFER_LUT_SIZE - 1));
+                lut[i] = static_cast<unsigned char>(std::lround(MathUtils::clamp01(v) * 255.0f));
+            }
+            return lut;
+        };
 
-        image[offset] = static_cast<unsigned int>(floor(pixel.R() * 255));
-        image[offset + 1] = static_cast<unsigned int>(floor(pixel.G() * 255));
-        image[offset + 2] = static_cast<unsigned int>(floor(pixel.B() * 255));
-        image[offset + 3] = 255; // Alpha
+        static const std::vector<unsigned char> srgb = build([](float v)
+            { return v <= 0.0031308f ? 12.92f * v : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f; });
+        static const std::vector<unsigned char> gamma22 = build([](float v)
+            { return std::pow(v, 1.0f / 2.2f); });
+
+        switch (curve)
+        {
+        case TransferCurve::SRGB:    return srgb.data();
+        case TransferCurve::Gamma22: return gamma22.data();
+        default:                     return nullptr;
+        }
+    }
+
+    // Tone mapping d'une suite de canaux ; boucles simples que le compilateur vectorise
+    void ApplyToneMap(const float *in, float *out, size_t count, ToneMapOperator op)
+    {
+        switch (op)
+        {
+        case ToneMapOperator::Reinhard:
+            for (size_t i = 0; i < count; ++i)
+            {
+                float v = std::max(in[i], 0.0f);
+                out[i] = v / (1.0f + v);
+            }
+            break;
+        case ToneMapOperator::ACES:
+            for (size_t i = 0; i < count; ++i)
+            {
+                float v = std::max(in[i], 0.0f);
+                out[i] = (v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f);
+            }
+            break;
+        default:
+            std::copy(in, in + count, out);
+            break;
+        }
+    }
+}
+
+void Image::WriteFile(const char *filename, TransferCurve curve, ToneMapOperator toneMap) const
+{
+    // Radiance is three packed floats, so the buffer can be handed to the kernel as interleaved RGB
+    static_assert(sizeof(Radiance) == 3 * sizeof(float), "Radiance must stay a packed RGB float triple");
+
+    const float *values = reinterpret_cast<const float *>(buffer.data());
+    const unsigned char *lut = TransferLut(curve);
+    const KernelTable &kernels = Kernels::Active();
+    const size_t rowValues = static_cast<size_t>(width) * 3;
+
+    // No alpha channel: the encoder gets RGB directly
+    std::vector<unsigned char> image(rowValues * height);
+
+    auto convertRows = [&](unsigned int y_start, unsigned int y_end)
+    {
+        if (toneMap == ToneMapOperator::Clamp)
+        {
+            // The quantization kernel clamps on its own
+            kernels.quantizeChannels(values + y_start * rowValues, image.data() + y_start * rowValues,
+                                     (y_end - y_start) * rowValues, lut);
+            return;
+        }
+
+        std::vector<float> mapped(rowValues);
+        for (unsigned int y = y_start; y < y_end; ++y)
+        {
+            ApplyToneMap(values + y * rowValues, mapped.data(), rowValues, toneMap);
+            kernels.quantizeChannels(mapped.data(), image.data() + y * rowValues, rowValues, lut);
+        }
+    };
+
+    // Same row split as the renderer; small images are not worth the threads
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 2;
+    numThreads = std::min(numThreads, std::max(1u, height / 64));
+
+    std::vector<std::thread> threads;
+    unsigned int chunkHeight = height / numThreads;
+    for (unsigned int t = 1; t < numThreads; ++t)
+    {
+        unsigned int y_end = (t == numThreads - 1) ? height : (t + 1) * chunkHeight;
+        threads.emplace_back(convertRows, t * chunkHeight, y_end);
     }
+    convertRows(0, numThreads > 1 ? chunkHeight : height);
+    for (auto &t : threads)
+        t.join();
 
     // if there's an error, display it
-    if (unsigned error = lodepng::encode(filename, image, width, height))
+    if (unsigned error = lodepng::encode(filename, image, width, height, LCT_RGB, 8))
         std::cout << "encoder error " << error << ": " << lodepng_error_text(error) << std::endl;
 }
@@ -0,0 +1,82 @@
+#include "LightTiles.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+} // namespace
+
+LightTiles::LightTiles(const std::vector<Light>& lights, int width, int height,
+                       const Vec3& camOrigin, const Vec3& lowerLeftCorner,
+                       const Vec3& horizontal, const Vec3& vertical)
+    : tilesX_((width + TILE_SIZE - 1) / TILE_SIZE)
+    , tilesY_((height + TILE_SIZE - 1) / TILE_SIZE)
+    , lightCount_(static_cast<int>(lights.size()))
+{
+    offsets_.reserve(static_cast<std::size_t>(tilesX_) * tilesY_ + 1);
+    offsets_.push_back(0);
+
+    // Same mapping as the camera rays: u = (x + offset) / (width - 1), offset in [0, 1]
+    const float invWidth = 1.0f / static_cast<float>(std::max(1, width - 1));
+    const float invHeight = 1.0f / static_cast<float>(std::max(1, height - 1));
+    const Vec3 forward = normalize(lowerLeftCorner + horizontal * 0.5f + vertical * 0.5f - camOrigin);
+
+    for (int tileY = 0; tileY < tilesY_; ++tileY)
+    {
+        for (int tileX = 0; tileX < tilesX_; ++tileX)
+        {
+            const float u0 = static_cast<float>(tileX * TILE_SIZE) * invWidth;
+            const float u1 = static_cast<float>(std::min(width, (tileX + 1) * TILE_SIZE)) * invWidth;
+            const float v0 = static_cast<float>(tileY * TILE_SIZE) * invHeight;
+            const float v1 = static_cast<float>(std::min(height, (tileY + 1) * TILE_SIZE)) * invHeight;
+
+            // Corner directions, in order around the tile
+            const Vec3 corners[4] = {
+                lowerLeftCorner + horizontal * u0 + vertical * v0 - camOrigin,
+                lowerLeftCorner + horizontal * u1 + vertical * v0 - camOrigin,
+                lowerLeftCorner + horizontal * u1 + vertical * v1 - camOrigin,
+                lowerLeftCorner + horizontal * u0 + vertical * v1 - camOrigin,
+            };
+            const Vec3 center = (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f;
+
+            // Side planes through the camera origin, normals pointing into the pyramid
+            Vec3 sides[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                Vec3 n = normalize(Cross(corners[k], corners[(k + 1) % 4]));
+                sides[k] = dot(n, center) < 0.0f ? -n : n;
+            }
+
+            for (int index = 0; index < lightCount_; ++index)
+            {
+                const Light& light = lights[index];
+                bool reaches = true;
+
+                if (light.type == LightType::Point && light.range != std::numeric_limits<float>::infinity())
+                {
+                    // Sphere of influence against the four sides and the camera plane
+                    const Vec3 toLight = light.position - camOrigin;
+                    reaches = dot(toLight, forward) > -light.range;
+                    for (int k = 0; k < 4 && reaches; ++k)
+                        reaches = dot(toLight, sides[k]) > -light.range;
+                }
+
+                if (reaches)
+                    indices_.push_back(index);
+            }
+            offsets_.push_back(static_cast<int>(indices_.size()));
+        }
+    }
+}
+
+double LightTiles::AverageLightsPerTile() const
+{
+    const int tiles = tilesX_ * tilesY_;
+    return tiles > 0 ? static_cast<double>(indices_.size()) / tiles : 0.0;
+}
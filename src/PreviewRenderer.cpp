@@ -0,0 +1,164 @@
+#include "PreviewRenderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "HitRecord.hpp"
+#include "Plane.hpp"
+#include "RowRunner.hpp"
+#include "Vec3A.hpp"
+
+namespace {
+
+// Offsets of the traced neighbor pairs across a missing pixel
+struct NeighborPair { int dx, dy; };   // The pair is (x - dx, y - dy) and (x + dx, y + dy)
+constexpr NeighborPair CHECKERBOARD_PAIRS[] = {{1, 0}, {0, 1}};
+constexpr NeighborPair INTERLACED_PAIRS[] = {{0, 1}, {1, 1}, {-1, 1}};
+
+// What a pixel center sees: the shape and, on the floor, the checker cell
+struct SurfaceKey {
+    const Shape* shape = nullptr;
+    int cell = 0;
+
+    bool operator==(const SurfaceKey&) const = default;
+};
+
+} // namespace
+
+PreviewRenderer::PreviewRenderer(const Scene& scene, const AntiAliasing& antiAliasing, PreviewPattern pattern)
+    : scene_(scene)
+    , antiAliasing_(antiAliasing)
+    , pattern_(pattern)
+{
+}
+
+PreviewStats PreviewRenderer::Render(Image& image,
+                                     const Vec3& camOrigin,
+                                     const Vec3& lowerLeftCorner,
+                                     const Vec3& horizontal,
+                                     const Vec3& vertical,
+                                     unsigned numThreads,
+                                     const LightTiles* lightTiles) const
+{
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    numThreads = std::max(numThreads, 1u);
+
+    std::vector<PathStats> threadStats(numThreads);
+    std::vector<long long> threadTraced(numThreads, 0);
+    std::vector<long long> threadFallbacks(numThreads, 0);
+
+    auto tracePixel = [&](int i, int j, unsigned t)
+    {
+        image.SetPixel(i, j, antiAliasing_.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                       horizontal, vertical, scene_, &threadStats[t], lightTiles));
+        ++threadTraced[t];
+    };
+
+    // Pass 1: shape and floor cell seen through each pixel center, intersection only
+    const auto guideStart = std::chrono::steady_clock::now();
+    std::vector<SurfaceKey> keys(static_cast<std::size_t>(width) * height);
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+    RunRows(height, numThreads, [&](int j, unsigned)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const float u_coord = (static_cast<float>(i) + 0.5f) / static_cast<float>(width - 1);
+            const float v_coord = (static_cast<float>(j) + 0.5f) / static_cast<float>(height - 1);
+            const Ray ray(origin, normalize(corner + horizontalA * u_coord + verticalA * v_coord - origin));
+            HitRecord hit;
+            if (!ray.Intersect(scene_, hit))
+                continue;
+            SurfaceKey& key = keys[static_cast<std::size_t>(j) * width + i];
+            key.shape = hit.shape;
+            if (dynamic_cast<const Plane*>(hit.shape))
+                key.cell = Ray::CheckerCell(static_cast<Vec3>(hit.point));
+        }
+    });
+    const double guideMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - guideStart).count();
+
+    // Pass 2: the pixels of the pattern
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            if (IsTraced(pattern_, i, j))
+                tracePixel(i, j, t);
+        }
+    });
+
+    // Pass 3: the others, which only read traced pixels
+    const NeighborPair* pairs = pattern_ == PreviewPattern::Interlaced ? INTERLACED_PAIRS : CHECKERBOARD_PAIRS;
+    const int pairCount = pattern_ == PreviewPattern::Interlaced ? 3 : 2;
+    auto luminance = [](const Radiance& c) { return 0.2126f * c.R() + 0.7152f * c.G() + 0.0722f * c.B(); };
+
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            if (IsTraced(pattern_, i, j))
+                continue;
+            const SurfaceKey& key = keys[static_cast<std::size_t>(j) * width + i];
+            auto sameSurface = [&](int x, int y)
+            {
+                return x >= 0 && x < width && y >= 0 && y < height
+                    && keys[static_cast<std::size_t>(y) * width + x] == key;
+            };
+
+            // The pair on the pixel's surface that varies least runs along the edge
+            float bestDifference = INFINITY;
+            Radiance best;
+            Radiance singles;
+            int singleCount = 0;
+            for (int p = 0; p < pairCount; ++p)
+            {
+                const int ax = i - pairs[p].dx, ay = j - pairs[p].dy;
+                const int bx = i + pairs[p].dx, by = j + pairs[p].dy;
+                const bool a = sameSurface(ax, ay), b = sameSurface(bx, by);
+                if (a)
+                {
+                    singles += image.GetPixel(ax, ay);
+                    ++singleCount;
+                }
+                if (b)
+                {
+                    singles += image.GetPixel(bx, by);
+                    ++singleCount;
+                }
+                if (!a || !b)
+                    continue;
+                const Radiance ca = image.GetPixel(ax, ay), cb = image.GetPixel(bx, by);
+                const float difference = std::abs(luminance(ca) - luminance(cb));
+                if (difference < bestDifference)
+                {
+                    bestDifference = difference;
+                    best = (ca + cb) * 0.5f;
+                }
+            }
+
+            if (bestDifference < INFINITY)
+                image.SetPixel(i, j, best);
+            else if (singleCount > 0)
+                image.SetPixel(i, j, singles * (1.0f / static_cast<float>(singleCount)));
+            else
+            {
+                tracePixel(i, j, t);
+                ++threadFallbacks[t];
+            }
+        }
+    });
+
+    PreviewStats result;
+    for (unsigned t = 0; t < numThreads; ++t)
+    {
+        result.paths += threadStats[t];
+        result.tracedPixels += threadTraced[t];
+        result.fallbackPixels += threadFallbacks[t];
+    }
+    result.interpolatedPixels = static_cast<long long>(width) * height - result.tracedPixels;
+    result.guideMs = guideMs;
+    return result;
+}
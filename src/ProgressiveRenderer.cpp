@@ -0,0 +1,134 @@
+#include "ProgressiveRenderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include "RowRunner.hpp"
+
+ProgressiveRenderer::ProgressiveRenderer(const Scene& scene, const AntiAliasing& antiAliasing)
+    : scene_(scene)
+    , antiAliasing_(antiAliasing)
+{
+}
+
+std::vector<int> ProgressiveRenderer::PassSamples(int totalSamples)
+{
+    std::vector<int> passes;
+    for (int samples = 1; samples < totalSamples; samples *= 4)
+        passes.push_back(samples);
+    passes.push_back(totalSamples);
+    return passes;
+}
+
+ProgressiveStats ProgressiveRenderer::Render(Image& image,
+                                             const Vec3& camOrigin,
+                                             const Vec3& lowerLeftCorner,
+                                             const Vec3& horizontal,
+                                             const Vec3& vertical,
+                                             unsigned numThreads,
+                                             const std::string& snapshotFile,
+                                             const LightTiles* lightTiles) const
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const RenderSettings& settings = scene_.GetSettings();
+    const auto interval = std::chrono::duration<double>(settings.progressiveDumpSeconds);
+
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    numThreads = std::max(numThreads, 1u);
+
+    std::vector<AntiAliasing::PixelSamples> pixels(static_cast<std::size_t>(width) * height);
+    std::vector<PathStats> threadStats(numThreads);
+    // Row each thread traces, copied to the preview at once
+    std::vector<std::vector<Radiance>> threadRows(numThreads, std::vector<Radiance>(width));
+
+    // Image as of the last finished row of each pass, and what guards it
+    Image preview(width, height);
+    std::mutex previewMutex;
+    std::mutex writeMutex;
+    Clock::time_point nextSnapshot = start + std::chrono::duration_cast<Clock::duration>(interval);
+    int snapshots = 0;
+
+    // Copies the preview and writes it over the snapshot file; one writer at a time
+    auto writeSnapshot = [&]()
+    {
+        Image copy(width, height);
+        {
+            std::lock_guard<std::mutex> lock(previewMutex);
+            copy = preview;
+        }
+        const std::filesystem::path target(snapshotFile);
+        std::filesystem::path temporary = target;
+        temporary.replace_filename(target.stem().string() + ".tmp" + target.extension().string());
+        copy.WriteFile(temporary.string().c_str(), settings.transfer, settings.toneMap);
+
+        // A snapshot that cannot be written (disk full, no write access) is skipped, the render goes on
+        std::error_code error;
+        std::filesystem::rename(temporary, target, error);
+        if (error)
+        {
+            std::cerr << "Image intermédiaire non écrite dans " << target.string() << " : " << error.message()
+                      << std::endl;
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+        ++snapshots;
+    };
+
+    ProgressiveStats result;
+    for (int passSamples : PassSamples(antiAliasing_.GetTotalSamples()))
+    {
+        RunRows(height, numThreads, [&](int j, unsigned t)
+        {
+            std::vector<Radiance>& row = threadRows[t];
+            for (int i = 0; i < width; ++i)
+            {
+                AntiAliasing::PixelSamples& pixel = pixels[static_cast<std::size_t>(j) * width + i];
+                antiAliasing_.AddSamples(pixel, passSamples - pixel.count, i, j, width, height, camOrigin,
+                                         lowerLeftCorner, horizontal, vertical, scene_, &threadStats[t], lightTiles);
+                row[i] = pixel.Average();
+            }
+            if (snapshotFile.empty())
+                return;
+            {
+                std::lock_guard<std::mutex> lock(previewMutex);
+                for (int i = 0; i < width; ++i)
+                    preview.SetPixel(i, j, row[i]);
+            }
+
+            // Timed snapshots: the thread that finds one due writes it, the others keep tracing
+            if (interval.count() > 0.0 && writeMutex.try_lock())
+            {
+                std::lock_guard<std::mutex> lock(writeMutex, std::adopt_lock);
+                if (Clock::now() >= nextSnapshot)
+                {
+                    writeSnapshot();
+                    nextSnapshot = Clock::now() + std::chrono::duration_cast<Clock::duration>(interval);
+                }
+            }
+        });
+
+        result.passSamples.push_back(passSamples);
+        result.passMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+        // Snapshot after each pass but the last, which the caller writes as the final image
+        const bool last = passSamples == antiAliasing_.GetTotalSamples();
+        if (!snapshotFile.empty() && interval.count() == 0.0 && !last)
+            writeSnapshot();
+    }
+
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            image.SetPixel(i, j, pixels[static_cast<std::size_t>(j) * width + i].Average());
+
+    for (const PathStats& stats : threadStats)
+        result.paths += stats;
+    for (const AntiAliasing::PixelSamples& pixel : pixels)
+        result.samples += pixel.count;
+    result.snapshots = snapshots;
+    return result;
+}
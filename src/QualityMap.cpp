@@ -0,0 +1,76 @@
+#include "QualityMap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "lodepng.h"
+
+namespace {
+
+// round(quality * full), kept in [1, full]
+int Scaled(float quality, int full)
+{
+    return std::clamp(static_cast<int>(std::lround(quality * static_cast<float>(full))), 1, std::max(full, 1));
+}
+
+} // namespace
+
+QualityMap::QualityMap(int width, int height, float quality)
+    : width_(width)
+    , height_(height)
+    , quality_(static_cast<std::size_t>(width) * height, std::clamp(quality, 0.0f, 1.0f))
+{
+}
+
+QualityMap QualityMap::Build(int width, int height, const std::string& mapFile,
+                             const std::vector<QualityRegion>& regions, float defaultQuality)
+{
+    QualityMap map(width, height, defaultQuality);
+
+    if (!mapFile.empty())
+    {
+        std::vector<unsigned char> gray;
+        unsigned mapWidth = 0, mapHeight = 0;
+        if (lodepng::decode(gray, mapWidth, mapHeight, mapFile, LCT_GREY, 8) != 0 || mapWidth == 0 || mapHeight == 0)
+            throw std::runtime_error("Cannot read the quality map: " + mapFile);
+
+        // Nearest map pixel under each image pixel center
+        for (int j = 0; j < height; ++j)
+        {
+            const unsigned my = std::min(static_cast<unsigned>((j + 0.5f) * mapHeight / height), mapHeight - 1);
+            for (int i = 0; i < width; ++i)
+            {
+                const unsigned mx = std::min(static_cast<unsigned>((i + 0.5f) * mapWidth / width), mapWidth - 1);
+                map.quality_[static_cast<std::size_t>(j) * width + i] = gray[my * mapWidth + mx] / 255.0f;
+            }
+        }
+    }
+
+    for (const QualityRegion& region : regions)
+        map.Paint(region);
+    return map;
+}
+
+void QualityMap::Paint(const QualityRegion& region)
+{
+    // Pixel i is inside when its center (i + 0.5) / width lies in [x, x + width)
+    const int x0 = std::max(0, static_cast<int>(std::ceil(region.x * width_ - 0.5f)));
+    const int x1 = std::min(width_, static_cast<int>(std::ceil((region.x + region.width) * width_ - 0.5f)));
+    const int y0 = std::max(0, static_cast<int>(std::ceil(region.y * height_ - 0.5f)));
+    const int y1 = std::min(height_, static_cast<int>(std::ceil((region.y + region.height) * height_ - 0.5f)));
+    if (x0 >= x1)
+        return;
+    const float quality = std::clamp(region.quality, 0.0f, 1.0f);
+    for (int j = y0; j < y1; ++j)
+        std::fill_n(quality_.begin() + static_cast<std::ptrdiff_t>(j) * width_ + x0, x1 - x0, quality);
+}
+
+int QualityMap::Samples(int x, int y, int totalSamples) const
+{
+    return Scaled(At(x, y), totalSamples);
+}
+
+int QualityMap::Depth(int x, int y, int maxDepth) const
+{
+    return Scaled(At(x, y), maxDepth);
+}
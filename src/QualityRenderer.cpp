@@ -0,0 +1,64 @@
+#include "QualityRenderer.hpp"
+
+#include <algorithm>
+#include "RowRunner.hpp"
+
+QualityRenderer::QualityRenderer(const std::vector<const Scene*>& depthViews, const AntiAliasing& antiAliasing,
+                                 const QualityMap& map)
+    : depthViews_(depthViews)
+    , antiAliasing_(antiAliasing)
+    , map_(map)
+{
+}
+
+QualityStats QualityRenderer::Render(Image& image,
+                                     const Vec3& camOrigin,
+                                     const Vec3& lowerLeftCorner,
+                                     const Vec3& horizontal,
+                                     const Vec3& vertical,
+                                     unsigned numThreads,
+                                     const LightTiles* lightTiles,
+                                     std::vector<int>* sampleCounts) const
+{
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    const int totalSamples = antiAliasing_.GetTotalSamples();
+    const int maxDepth = static_cast<int>(depthViews_.size());
+    numThreads = std::max(numThreads, 1u);
+
+    std::vector<QualityStats> threadStats(numThreads);
+    if (sampleCounts)
+        sampleCounts->assign(static_cast<std::size_t>(width) * height, 0);
+
+    RunRows(height, numThreads, [&](int j, unsigned t)
+    {
+        QualityStats& stats = threadStats[t];
+        for (int i = 0; i < width; ++i)
+        {
+            const int samples = map_.Samples(i, j, totalSamples);
+            const Scene& view = *depthViews_[map_.Depth(i, j, maxDepth) - 1];
+
+            PathStats pixelPaths;
+            AntiAliasing::PixelSamples pixel;
+            antiAliasing_.AddSamples(pixel, samples, i, j, width, height, camOrigin, lowerLeftCorner,
+                                     horizontal, vertical, view, &pixelPaths, lightTiles);
+            image.SetPixel(i, j, pixel.Average());
+
+            stats.paths += pixelPaths;
+            stats.samples += pixel.count;
+            stats.uniformRays += pixelPaths.rays * totalSamples / pixel.count;
+            if (sampleCounts)
+                (*sampleCounts)[static_cast<std::size_t>(j) * width + i] = pixel.count;
+        }
+    });
+
+    QualityStats result;
+    for (const QualityStats& stats : threadStats)
+    {
+        result.paths += stats.paths;
+        result.samples += stats.samples;
+        result.uniformRays += stats.uniformRays;
+    }
+    result.uniformSamples = static_cast<long long>(width) * height * totalSamples;
+    return result;
+}
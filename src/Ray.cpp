@@ -5,8 +5,8 @@
 #include "Vec3.hpp"
 #include <algorithm>
 
-Ray::Ray(const Vec3& origin, const Vec3& direction)
-    : _origin(origin), _direction(direction) {
+Ray::Ray(const Vec3A& origin, const Vec3A& direction, const RayCone& cone)
+    : _origin(origin), _direction(direction), _cone(cone) {
 }
 
 // Schlick's approximation of Fresnel reflectance for metals
@@ -21,139 +21,351 @@ static float FresnelSchlick(float cosTheta, float baseReflectivity) {
     return r0 + (1.0f - r0) * oneMinusCos5;
 }
 
-Color Ray::TraceScene(const std::vector<std::unique_ptr<Shape>>& scene, int depth) const {
-    Color defaultColor = Color(0.5f,0.4f,0.5f);
+bool Ray::Intersect(const Scene& scene, HitRecord& hit) const {
+    hit.shape = scene.ClosestHit(_origin, _direction, hit.t);
+    if (! hit.shape) {
+        return false;
+    }
 
-    if (depth <= 0) return defaultColor;
+    hit.point = PointAt(hit.t);
 
-    float closest_t = 1e30f;
-    const Shape* hit_shape = nullptr;
+    hit.curvature = 0.0f;
+    if (const Sphere* sphere = dynamic_cast<const Sphere*>(hit.shape)) {
+        hit.normal = normalize(hit.point - Vec3A(sphere->GetCenter()));
+        hit.curvature = 1.0f / sphere->GetRadius();
+    }
+    else if (const Cube* cube = dynamic_cast<const Cube*>(hit.shape)) {
+        // Compute cube face normal - SAME METHOD AS GetShadedColor
+        float half = cube->GetSize() / 2.0f;
+        Vec3 local = static_cast<Vec3>(hit.point - Vec3A(cube->GetCenter()));
 
-    // Trouver la forme la plus proche intersectée
-    for (const auto& shape : scene) {
-        float t;
-        if (shape->Intersect(_origin, _direction, t)) {
-            if (t < closest_t) {
-                closest_t = t;
-                hit_shape = shape.get();
-            }
+        float distX = half - std::abs(local.x);
+        float distY = half - std::abs(local.y);
+        float distZ = half - std::abs(local.z);
+
+        if (distX < distY && distX < distZ) {
+            hit.normal = Vec3A((local.x > 0) ? 1.0f : -1.0f, 0.0f, 0.0f);
+        } else if (distY < distZ) {
+            hit.normal = Vec3A(0.0f, (local.y > 0) ? 1.0f : -1.0f, 0.0f);
+        } else {
+            hit.normal = Vec3A(0.0f, 0.0f, (local.z > 0) ? 1.0f : -1.0f);
+        }
+    }
+    else if (const Plane* plane = dynamic_cast<const Plane*>(hit.shape)) {
+        hit.normal = Vec3A(plane->normal);
+    }
+    else {
+        hit.normal = Vec3A();
+    }
+
+    // Empreinte sur la surface : s'allonge en incidence rasante (bornée à 1 / 0.02)
+    hit.footprint = 0.0f;
+    if (_cone.spread > 0.0f || _cone.width > 0.0f) {
+        const float cosIncidence = std::max(std::abs(dot(_direction, hit.normal)), 0.02f);
+        hit.footprint = _cone.WidthAt(hit.t) / cosIncidence;
+    }
+    return true;
+}
+
+Ray Ray::Reflected(const HitRecord& hit) const {
+    RayCone cone;
+    cone.width = _cone.WidthAt(hit.t);
+    cone.spread = _cone.spread + 2.0f * cone.width * hit.curvature;
+    return Ray(hit.point + hit.normal * 1e-4f, reflect(_direction, hit.normal), cone);
+}
+
+Radiance Ray::BackgroundColor() {
+    return Radiance(0.5f, 0.4f, 0.5f);
+}
+
+// Shadow ray from just above the surface, on the side of hit.normal
+static bool InShadow(const Scene& scene, const HitRecord& hit, const Vec3& toLight, float distance, PathStats* stats) {
+    if (stats) {
+        stats->shadowRays++;
+    }
+    return scene.Occluded(hit.point + hit.normal * 1e-4f, Vec3A(toLight), distance);
+}
+
+// Ambient + Blinn-Phong summed over the lights, with the frame constants of the
+// shading context. With a single white light and no shadows this is exactly the
+// historical hard-coded lighting of Sphere and Cube.
+static Radiance BlinnPhong(const Scene& scene, const HitRecord& hit, const Vec3& normal,
+                           const Radiance& albedo, const Radiance& specularColor,
+                           const LightSet& lights, PathStats* stats) {
+    const ShadingContext& shading = scene.GetShading();
+    const Vec3 point = static_cast<Vec3>(hit.point);
+
+    // Light reaching the point, weighted by Lambert and by the highlight
+    Radiance diffuse;
+    Radiance specular;
+
+    for (int k = 0; k < lights.count; ++k) {
+        const ShadingContext::LightUniforms& light = shading.lights[lights.indices[k]];
+        Vec3 lightDir;
+        float distance;
+        Radiance incoming;
+        if (! light.Incident(point, lightDir, distance, incoming)) {
+            continue;
+        }
+
+        float nDotL = dot(normal, lightDir);
+        // Une surface qui tourne le dos à la lumière est dans sa propre ombre : pas de rayon
+        if (shading.shadows && (nDotL <= 0.0f || InShadow(scene, hit, lightDir, distance, stats))) {
+            continue;
+        }
+
+        // Vecteur demi-angle précalculé pour les lumières directionnelles
+        const Vec3 halfwayDir = light.type == LightType::Directional ? light.halfway : normalize(lightDir + shading.viewDir);
+        float diff = std::max(0.0f, nDotL);
+        float spec = FastMath::PowInt<ShadingContext::SHININESS>(std::max(0.0f, dot(normal, halfwayDir)), shading.math);
+
+        diffuse += incoming * diff;
+        specular += incoming * spec;
+    }
+
+    const float ambient = shading.ambient;
+    const float kd = shading.diffuseStrength;
+    const float ks = shading.specularStrength;
+    return Radiance(
+        albedo.R() * (ambient + kd * diffuse.R()) + specularColor.R() * (ks * specular.R()),
+        albedo.G() * (ambient + kd * diffuse.G()) + specularColor.G() * (ks * specular.G()),
+        albedo.B() * (ambient + kd * diffuse.B()) + specularColor.B() * (ks * specular.B())
+    );
+}
+
+// Cases du damier du sol : 1 / CHECKER_SCALE unités de côté
+static constexpr float CHECKER_SCALE = 0.001f;
+
+float Ray::CheckerCellSize() {
+    return 1.0f / CHECKER_SCALE;
+}
+
+int Ray::CheckerCell(const Vec3& point) {
+    return (static_cast<int>(std::floor(point.x * CHECKER_SCALE)) + static_cast<int>(std::floor(point.z * CHECKER_SCALE))) & 1;
+}
+
+// Integral of the square wave s(u) = +1 / -1 on even / odd cells of the floor(u) checker,
+// from 0 to x: a triangle wave of period 2
+static float SquareWaveIntegral(float x) {
+    return 1.0f - 2.0f * std::abs(x * 0.5f - std::floor(x * 0.5f) - 0.5f);
+}
+
+// Mean of the square wave over [x - width / 2, x + width / 2]
+static float FilteredSquareWave(float x, float width) {
+    if (width < 1e-4f) {
+        return (static_cast<int>(std::floor(x)) & 1) ? -1.0f : 1.0f;
+    }
+    return (SquareWaveIntegral(x + 0.5f * width) - SquareWaveIntegral(x - 0.5f * width)) / width;
+}
+
+// Share of light cells of the checker under a box of size (width.x, width.z) centered on (x, z):
+// the checker is (1 - sx * sz) / 2 and the box filter is separable, so the mean is exact
+static float FilteredChecker(float x, float z, const Vec3& width) {
+    return 0.5f - 0.5f * FilteredSquareWave(x, width.x) * FilteredSquareWave(z, width.z);
+}
+
+// Axis-aligned box, in checker cells, around the ray cone footprint on the floor:
+// the cone width across the ray, stretched by 1 / cos along its direction on the plane
+static Vec3 FootprintBox(const HitRecord& hit, const Vec3& direction, float scale) {
+    const float across = hit.footprint * std::max(std::abs(dot(direction, static_cast<Vec3>(hit.normal))), 0.02f);
+    const float along = hit.footprint;
+    const float planar = std::sqrt(direction.x * direction.x + direction.z * direction.z);
+    if (planar < 1e-6f) {
+        return Vec3(along * scale, 0.0f, along * scale);
+    }
+    const float tx = std::abs(direction.x) / planar;
+    const float tz = std::abs(direction.z) / planar;
+    return Vec3((tx * along + tz * across) * scale, 0.0f, (tz * along + tx * across) * scale);
+}
+
+// The checkerboard is not lit; in shadow it darkens towards the ambient level,
+// by the share of the facing lights (weighted by Lambert) that is occluded
+static float PlaneShadowFactor(const Scene& scene, const HitRecord& hit, const LightSet& lights, PathStats* stats) {
+    const ShadingContext& shading = scene.GetShading();
+    const Vec3 point = static_cast<Vec3>(hit.point);
+    const Vec3 normal = static_cast<Vec3>(hit.normal);
+
+    float total = 0.0f;
+    float visible = 0.0f;
+    for (int k = 0; k < lights.count; ++k) {
+        Vec3 lightDir;
+        float distance;
+        Radiance incoming;
+        if (! shading.lights[lights.indices[k]].Incident(point, lightDir, distance, incoming)) {
+            continue;
+        }
+
+        float nDotL = dot(normal, lightDir);
+        if (nDotL <= 0.0f) {
+            continue;
+        }
+        float weight = (incoming.R() + incoming.G() + incoming.B()) * nDotL;
+        total += weight;
+        if (! InShadow(scene, hit, lightDir, distance, stats)) {
+            visible += weight;
         }
     }
 
-    if (! hit_shape) {
-        return defaultColor;
+    if (total <= 0.0f) {
+        return 1.0f;
     }
+    return shading.ambient + (1.0f - shading.ambient) * (visible / total);
+}
 
-    // Si intersection trouvée, calculer la couleur avec ombrage
-    Vec3 hitPoint = PointAt(closest_t);
+Radiance Ray::ShadeSurface(const Scene& scene, const HitRecord& hit, const Vec3A& direction,
+                           const LightSet& lights, float& outReflectivity, PathStats* stats) {
+    const Vec3 hitPoint = static_cast<Vec3>(hit.point);
+    const ShadingContext& shading = scene.GetShading();
+    outReflectivity = 0.0f;
 
-    if (const Sphere* hit_sphere = dynamic_cast<const Sphere*>(hit_shape)) {
-        Color surfaceColor = hit_sphere->GetShadedColor(hitPoint);
+    if (const Sphere* hit_sphere = dynamic_cast<const Sphere*>(hit.shape)) {
         float baseReflectivity = hit_sphere->GetReflectivity();
 
         if (baseReflectivity > 0.0f) {
-            Vec3 normal = normalize(hitPoint - hit_sphere->GetCenter());
-
             // Apply Fresnel effect: reflectivity increases at grazing angles
             // This creates realistic metallic appearance where edges are more reflective
-            float cosTheta = std::abs(dot(normalize(-GetDirection()), normal));
-            float fresnelReflectivity = FresnelSchlick(cosTheta, baseReflectivity);
+            float cosTheta = std::abs(dot(normalize(-direction), hit.normal));
 
             // Cap maximum reflectivity to ensure sphere surface remains visible
             // Even at 1.0f base reflectivity, we keep at least 10% of surface color
             // This allows the sphere's color and shading to remain visible
             const float maxReflectivity = 0.90f;
-            fresnelReflectivity = std::min(fresnelReflectivity, maxReflectivity);
-
-            // Cast reflection ray
-            Vec3 reflectDir = reflect(GetDirection(), normal);
-            Ray reflectedRay(hitPoint + normal * 1e-4f, reflectDir);
-            Color reflectionColor = reflectedRay.TraceScene(scene, depth - 1);
-
-            // Mix surface color and reflection using raw floats to avoid premature clamping
-            // Color class clamps on multiplication and addition, which breaks color mixing
-            // Working with raw floats preserves precision and eliminates pixelization artifacts
-            float surfaceWeight = 1.0f - fresnelReflectivity;
-            float reflectionWeight = fresnelReflectivity;
-
-            return Color(
-                surfaceColor.R() * surfaceWeight + reflectionColor.R() * reflectionWeight,
-                surfaceColor.G() * surfaceWeight + reflectionColor.G() * reflectionWeight,
-                surfaceColor.B() * surfaceWeight + reflectionColor.B() * reflectionWeight
-            );
+            outReflectivity = std::min(FresnelSchlick(cosTheta, baseReflectivity), maxReflectivity);
         }
-        return surfaceColor;
+        // Normale recalculée en Vec3 comme l'ancien éclairage, pour un rendu identique
+        const Vec3 normal = normalize(hitPoint - hit_sphere->GetCenter());
+        return BlinnPhong(scene, hit, normal, hit_sphere->GetAlbedo(hitPoint, normal, hit.footprint, shading.math),
+                          Radiance(hit_sphere->GetColor()), lights, stats);
     }
 
     // === Cube shading and reflection ===
-    if (const Cube *hit_cube = dynamic_cast<const Cube *>(hit_shape))
-    {
-        Color surfaceColor = hit_cube->GetShadedColor(hitPoint);
+    if (const Cube *hit_cube = dynamic_cast<const Cube *>(hit.shape)) {
         float baseReflectivity = hit_cube->GetReflectivity();
 
-        if (baseReflectivity > 0.0f)
-        {
-            // Compute cube face normal - SAME METHOD AS GetShadedColor
-            Vec3 half = Vec3{hit_cube->GetSize() / 2.0f, hit_cube->GetSize() / 2.0f, hit_cube->GetSize() / 2.0f};
-            Vec3 local = hitPoint - hit_cube->GetCenter();
-
-            float distX = half.x - std::abs(local.x);
-            float distY = half.y - std::abs(local.y);
-            float distZ = half.z - std::abs(local.z);
-
-            Vec3 normal;
-            if (distX < distY && distX < distZ) {
-                normal = Vec3((local.x > 0) ? 1.0f : -1.0f, 0.0f, 0.0f);
-            } else if (distY < distZ) {
-                normal = Vec3(0.0f, (local.y > 0) ? 1.0f : -1.0f, 0.0f);
-            } else {
-                normal = Vec3(0.0f, 0.0f, (local.z > 0) ? 1.0f : -1.0f);
+        if (baseReflectivity > 0.0f) {
+            float cosTheta = std::abs(dot(normalize(-direction), hit.normal));
+            outReflectivity = std::min(FresnelSchlick(cosTheta, baseReflectivity), 0.9f);
+        }
+        const Radiance color(hit_cube->GetColor());
+        return BlinnPhong(scene, hit, static_cast<Vec3>(hit.normal), color, color, lights, stats);
+    }
+
+    if (const Plane* hit_plane = dynamic_cast<const Plane*>(hit.shape)) {
+        // --- Checkerboard Pattern for the plane ---
+        const float scale = CHECKER_SCALE;
+        int check = CheckerCell(hitPoint);
+        outReflectivity = hit_plane->reflectivity;
+        Radiance checker = check ? Radiance(1.0f, 1.0f, 1.0f) : Radiance(0.2f, 0.2f, 0.2f);
+        if (hit.footprint > 0.0f) {
+            // Damier filtré exactement sur l'empreinte : part des cases claires sous la boîte
+            const float light = FilteredChecker(hitPoint.x * scale, hitPoint.z * scale,
+                                                FootprintBox(hit, static_cast<Vec3>(direction), scale));
+            checker = Radiance(0.2f, 0.2f, 0.2f) + Radiance(0.8f, 0.8f, 0.8f) * light;
+        }
+        if (shading.shadows) {
+            // Côté du plan vu par le rayon
+            HitRecord facing = hit;
+            if (dot(hit.normal, direction) > 0.0f) {
+                facing.normal = -hit.normal;
             }
+            checker = checker * PlaneShadowFactor(scene, facing, lights, stats);
+        }
+        return checker;
+    }
 
-            float cosTheta = std::abs(dot(normalize(-GetDirection()), normal));
-            float fresnelReflectivity = std::min(FresnelSchlick(cosTheta, baseReflectivity), 0.9f);
+    return BackgroundColor();
+}
 
-            Vec3 reflectDir = reflect(GetDirection(), normal);
-            Ray reflectedRay(hitPoint + normal * 1e-4f, reflectDir);
-            Color reflectionColor = reflectedRay.TraceScene(scene, depth - 1);
+// Uniform float in [0, 1) from a path seed and bounce index (integer hash, deterministic across threads)
+static float PathRandom(std::uint32_t pathSeed, int bounce) {
+    std::uint32_t h = pathSeed * 0x9e3779b1u ^ static_cast<std::uint32_t>(bounce) * 0x85ebca77u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+}
 
-            float surfaceWeight = 1.0f - fresnelReflectivity;
-            float reflectionWeight = fresnelReflectivity;
+bool Ray::ContinuePath(const RenderSettings& settings, float& throughput, std::uint32_t pathSeed, int bounce) {
+    if (throughput <= 0.0f) {
+        return false;
+    }
 
-            return Color(
-                surfaceColor.R() * surfaceWeight + reflectionColor.R() * reflectionWeight,
-                surfaceColor.G() * surfaceWeight + reflectionColor.G() * reflectionWeight,
-                surfaceColor.B() * surfaceWeight + reflectionColor.B() * reflectionWeight);
-        }
+    switch (settings.termination) {
+    case PathTermination::Fixed:
+        return true;
+
+    case PathTermination::Cutoff:
+        return throughput > settings.minThroughput;
 
-        return surfaceColor;
+    case PathTermination::RussianRoulette:
+        if (throughput < settings.rouletteThreshold) {
+            const float survival = throughput / settings.rouletteThreshold;
+            if (PathRandom(pathSeed, bounce) >= survival) {
+                throughput = 0.0f;
+                return false;
+            }
+            throughput = settings.rouletteThreshold;
+        }
+        return true;
     }
+    return true;
+}
 
-    if (const Plane* hit_plane = dynamic_cast<const Plane*>(hit_shape)) {
-        // --- Checkerboard Pattern for the plane ---
-        float scale = 0.001f;
-        int check = (static_cast<int>(std::floor(hitPoint.x * scale)) + static_cast<int>(std::floor(hitPoint.z * scale))) & 1;
-        Color surfaceColor = check ? Color(1.0f, 1.0f, 1.0f) : Color(0.2f, 0.2f, 0.2f);
-
-        float reflectivity = hit_plane->reflectivity;
-        if (reflectivity > 0.0f) {
-            Vec3 normal = hit_plane->normal;
-            Vec3 reflectDir = reflect(GetDirection(), normal);
-            Ray reflectedRay(hitPoint + normal * 1e-4f, reflectDir);
-            Color reflectionColor = reflectedRay.TraceScene(scene, depth - 1);
-
-            // Mix surface color and reflection using raw floats to avoid premature clamping
-            float surfaceWeight = 1.0f - reflectivity;
-            float reflectionWeight = reflectivity;
-
-            return Color(
-                surfaceColor.R() * surfaceWeight + reflectionColor.R() * reflectionWeight,
-                surfaceColor.G() * surfaceWeight + reflectionColor.G() * reflectionWeight,
-                surfaceColor.B() * surfaceWeight + reflectionColor.B() * reflectionWeight
-            );
+Radiance Ray::TraceScene(const Scene& scene, std::uint32_t pathSeed, PathStats* stats,
+                         const LightSet* primaryLights, HitRecord* firstHit) const {
+    const RenderSettings& settings = scene.GetSettings();
+    // Radiance accumulée sans clamp ; le poids du chemin est le produit des réflectivités
+    Radiance radiance;
+    float throughput = 1.0f;
+    Ray ray = *this;
+    int depth = 0;
+
+    while (depth < settings.maxDepth) {
+        ++depth;
+
+        // Trouver la forme la plus proche intersectée
+        HitRecord hit;
+        const bool hits = ray.Intersect(scene, hit);
+        if (depth == 1 && firstHit) {
+            *firstHit = hit;
+        }
+        if (! hits) {
+            break;
+        }
+
+        // Tri des lumières par tuile valable pour le premier impact seulement
+        const LightSet lights = (depth == 1 && primaryLights) ? *primaryLights : scene.AllLights();
+
+        float reflectivity;
+        Radiance surface = ShadeSurface(scene, hit, ray._direction, lights, reflectivity, stats);
+
+        // La surface garde 1 - reflectivity, le reste part dans le rayon réfléchi
+        radiance += surface * (throughput * (1.0f - reflectivity));
+
+        throughput *= reflectivity;
+        if (depth == settings.maxDepth) {
+            break;
+        }
+        if (! ContinuePath(settings, throughput, pathSeed, depth)) {
+            // Chemin coupé (le fond estime le reste) ou tué par la roulette (poids nul)
+            if (stats && reflectivity > 0.0f) {
+                stats->terminated++;
+            }
+            break;
         }
-        return surfaceColor;
+
+        ray = ray.Reflected(hit);
     }
 
-    return defaultColor;
+    if (stats) {
+        stats->rays += depth;
+    }
+
+    // Rayon échappé, profondeur épuisée ou chemin coupé
+    radiance += BackgroundColor() * throughput;
+
+    // Pas de clamp : le tone mapping de Image::WriteFile ramène dans [0, 1]
+    return radiance;
 }
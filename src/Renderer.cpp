@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <cmath>
@@ -11,19 +12,263 @@
 #include "Image.hpp"
 #include "Plane.hpp"
 #include "Shape.hpp"
+#include "Scene.hpp"
 #include "Vec3.hpp"
 #include "Renderer.hpp"
 #include "ShapeGenerator.hpp"
 #include "AntiAliasing.hpp"
+#include "WavefrontRenderer.hpp"
+#include "AdaptiveRenderer.hpp"
+#include "BudgetRenderer.hpp"
+#include "ProgressiveRenderer.hpp"
+#include "QualityRenderer.hpp"
+#include "PreviewRenderer.hpp"
+#include "EdgeRenderer.hpp"
+#include "FilmRenderer.hpp"
+#include "Denoiser.hpp"
+#include "LightTiles.hpp"
+#include "TextureCache.hpp"
 #include "SceneLoader.hpp"
+#include "RenderSettings.hpp"
 #include "DNAgenerator.hpp"
 #include "Timer.hpp"
 
-void render_scene(int width, int height, float screenZ, const char *outputFile)
+namespace
+{
+    // What every renderer needs to trace one image of a view
+    struct RenderJob
+    {
+        Image &target;
+        const Scene &view;
+        const std::vector<std::unique_ptr<Shape>> &shapes; // For renderers that build views of their own
+        const std::vector<Light> &lights;
+        const AntiAliasing &antiAliasing;
+        const Vec3 &camOrigin;
+        const Vec3 &lowerLeftCorner;
+        const Vec3 &horizontal;
+        const Vec3 &vertical;
+        unsigned numThreads;
+        const LightTiles &lightTiles;
+        std::vector<int> *sampleCounts; // Samples per pixel, for the renderers that vary them
+    };
+
+    PathStats RenderWavefront(const RenderJob &job)
+    {
+        WavefrontRenderer wavefront(job.view, job.antiAliasing, job.view.GetSettings().sortReflections);
+        WavefrontStats stats = wavefront.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal,
+                                                job.vertical, job.numThreads, &job.lightTiles);
+        std::cout << "Pipeline wavefront : " << stats.raysTraced << " rayons tracés, dont "
+                  << stats.reflectionRays << " réflexions." << std::endl;
+        if (stats.sortedRays > 0)
+        {
+            std::cout << "Tri des réflexions : " << stats.sortedRays << " rayons triés en "
+                      << stats.sortSeconds * 1000.0 << " ms ; changements de forme entre rayons voisins "
+                      << stats.shapeSwitchesUnsorted << " -> " << stats.shapeSwitchesTraced
+                      << " ; intersection des réflexions " << stats.reflectionIntersectSeconds * 1000.0
+                      << " ms." << std::endl;
+        }
+        PathStats total;
+        total.rays = stats.raysTraced;
+        total.terminated = stats.terminatedPaths;
+        total.shadowRays = stats.shadowRays;
+        return total;
+    }
+
+    PathStats RenderAdaptive(const RenderJob &job)
+    {
+        const int width = job.target.GetWidth(), height = job.target.GetHeight();
+        AdaptiveRenderer adaptive(job.view, job.antiAliasing);
+        AdaptiveStats stats = adaptive.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal,
+                                              job.vertical, job.numThreads, &job.lightTiles, job.sampleCounts);
+        std::cout << "Échantillonnage adaptatif : " << stats.samples << " rayons primaires, "
+                  << static_cast<double>(stats.samples) / (static_cast<double>(width) * height)
+                  << " par pixel sur " << job.antiAliasing.GetTotalSamples() << " ; "
+                  << stats.refinedPixels << " pixels raffinés." << std::endl;
+        return stats.paths;
+    }
+
+    PathStats RenderBudget(const RenderJob &job)
+    {
+        const int width = job.target.GetWidth(), height = job.target.GetHeight();
+        BudgetRenderer budget(job.view, job.antiAliasing);
+        BudgetStats stats = budget.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal, job.vertical,
+                                          job.numThreads, &job.lightTiles, job.sampleCounts);
+        std::vector<float> perTile = stats.tileSamples;
+        std::sort(perTile.begin(), perTile.end());
+        std::cout << "Budget de temps : " << stats.elapsedMs << " ms sur " << job.view.GetSettings().timeBudgetMs
+                  << " (première passe " << stats.firstPassMs << " ms) ; " << stats.samples
+                  << " rayons primaires, " << static_cast<double>(stats.samples) / (static_cast<double>(width) * height)
+                  << " par pixel sur " << job.antiAliasing.GetTotalSamples() << " ; " << stats.tileRefinements
+                  << " lots par tuile." << std::endl;
+        if (stats.unsampledPixels > 0)
+            std::cout << "Budget dépassé pendant la première passe : " << stats.unsampledPixels
+                      << " pixels sans échantillon, remplis par le pixel tracé le plus proche."
+                      << std::endl;
+        std::cout << "Échantillons par pixel des " << perTile.size() << " tuiles de " << LightTiles::TILE_SIZE
+                  << "x" << LightTiles::TILE_SIZE << " : min " << perTile.front() << ", médiane "
+                  << perTile[perTile.size() / 2] << ", max " << perTile.back() << "." << std::endl;
+        return stats.paths;
+    }
+
+    PathStats RenderProgressive(const RenderJob &job, const std::filesystem::path &progressFile)
+    {
+        ProgressiveRenderer progressive(job.view, job.antiAliasing);
+        ProgressiveStats stats = progressive.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal,
+                                                    job.vertical, job.numThreads, progressFile.string(),
+                                                    &job.lightTiles);
+        std::cout << "Rendu progressif :";
+        for (std::size_t pass = 0; pass < stats.passSamples.size(); ++pass)
+            std::cout << (pass ? ", " : " ") << stats.passSamples[pass] << " spp à " << stats.passMs[pass] << " ms";
+        std::cout << " ; " << stats.snapshots << " image(s) intermédiaire(s) dans " << progressFile.string()
+                  << "." << std::endl;
+        return stats.paths;
+    }
+
+    PathStats RenderQuality(const RenderJob &job)
+    {
+        // Une vue par profondeur de réflexion, la dernière est la scène entière
+        const RenderSettings &viewSettings = job.view.GetSettings();
+        const QualityMap map = QualityMap::Build(job.target.GetWidth(), job.target.GetHeight(), viewSettings.qualityMap,
+                                                 viewSettings.qualityRegions, viewSettings.qualityDefault);
+        std::vector<std::unique_ptr<Scene>> shallowViews;
+        std::vector<const Scene *> depthViews;
+        for (int depth = 1; depth < viewSettings.maxDepth; ++depth)
+        {
+            RenderSettings shallow = viewSettings;
+            shallow.maxDepth = depth;
+            shallowViews.push_back(std::make_unique<Scene>(job.shapes, shallow, job.lights));
+            depthViews.push_back(shallowViews.back().get());
+        }
+        depthViews.push_back(&job.view);
+
+        QualityRenderer renderer(depthViews, job.antiAliasing, map);
+        QualityStats stats = renderer.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal,
+                                             job.vertical, job.numThreads, &job.lightTiles, job.sampleCounts);
+        const long long savedRays = stats.uniformRays - stats.paths.rays;
+        std::cout << "Carte de qualité : " << stats.samples << " rayons primaires sur " << stats.uniformSamples
+                  << " en uniforme (" << 100.0 * static_cast<double>(stats.uniformSamples - stats.samples)
+                                         / static_cast<double>(stats.uniformSamples)
+                  << " % économisés) ; " << stats.paths.rays << " segments, au moins " << savedRays
+                  << " économisés (" << 100.0 * static_cast<double>(savedRays)
+                                        / static_cast<double>(std::max(stats.uniformRays, 1LL))
+                  << " %)." << std::endl;
+        return stats.paths;
+    }
+
+    PathStats RenderPreview(const RenderJob &job)
+    {
+        const PreviewPattern pattern = job.view.GetSettings().previewPattern;
+        PreviewRenderer preview(job.view, job.antiAliasing, pattern);
+        PreviewStats stats = preview.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal,
+                                            job.vertical, job.numThreads, &job.lightTiles);
+        std::cout << "Aperçu " << (pattern == PreviewPattern::Checkerboard ? "en damier" : "entrelacé")
+                  << " : " << stats.tracedPixels << " pixels tracés, dont " << stats.fallbackPixels
+                  << " isolés sur leur surface ; " << stats.interpolatedPixels << " interpolés ; passe des formes "
+                  << stats.guideMs << " ms." << std::endl;
+        return stats.paths;
+    }
+
+    PathStats RenderEdges(const RenderJob &job)
+    {
+        const int width = job.target.GetWidth(), height = job.target.GetHeight();
+        EdgeRenderer edges(job.view, job.antiAliasing);
+        EdgeStats stats = edges.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal, job.vertical,
+                                       job.numThreads, &job.lightTiles, job.sampleCounts);
+        std::cout << "Anticrénelage par détection de bords : " << stats.edgePixels << " pixels de bord sur "
+                  << static_cast<long long>(width) * height;
+        if (job.view.GetSettings().coverageAA)
+            std::cout << ", plus " << stats.coveragePixels << " par couverture des silhouettes de sphères";
+        std::cout << " ; " << stats.samples << " rayons primaires, "
+                  << static_cast<double>(stats.samples) / (static_cast<double>(width) * height)
+                  << " par pixel." << std::endl;
+        return stats.paths;
+    }
+
+    PathStats RenderFilm(const RenderJob &job)
+    {
+        const RenderSettings &viewSettings = job.view.GetSettings();
+        const ReconstructionFilter filter(viewSettings.pixelFilter, viewSettings.pixelFilterRadius);
+        FilmRenderer filmRenderer(job.view, job.antiAliasing, filter);
+        FilmStats stats = filmRenderer.Render(job.target, job.camOrigin, job.lowerLeftCorner, job.horizontal,
+                                              job.vertical, job.numThreads, &job.lightTiles);
+        std::cout << "Filtre de reconstruction : rayon " << filter.GetRadius() << " pixel(s), "
+                  << stats.samples << " échantillons répartis sur " << stats.tiles << " tuiles." << std::endl;
+        return stats.paths;
+    }
+
+    // Every pixel at the full sample count; variances, when asked for, get the spread of each pixel's samples
+    PathStats RenderStandard(const RenderJob &job, std::vector<float> *variances)
+    {
+        const int width = job.target.GetWidth(), height = job.target.GetHeight();
+        const int numThreads = static_cast<int>(job.numThreads);
+        std::vector<std::thread> threads;
+        std::vector<PathStats> threadStats(numThreads);
+        int chunkHeight = height / numThreads;
+        if (variances)
+            variances->assign(static_cast<std::size_t>(width) * height, 0.0f);
+
+        auto renderChunk = [&](int j_start, int j_end, PathStats *stats)
+        {
+            // Raytracing avec projection perspective uniforme
+            for (int j = j_start; j < j_end; ++j) // Each thread works on a subset of 'j'
+            {
+                for (int i = 0; i < width; ++i)
+                {
+                    if (variances)
+                    {
+                        // Same samples, with the spread of their luminance for the denoiser
+                        AntiAliasing::PixelSamples samples;
+                        job.antiAliasing.AddSamples(samples, job.antiAliasing.GetTotalSamples(), i, j, width, height,
+                                                    job.camOrigin, job.lowerLeftCorner, job.horizontal, job.vertical,
+                                                    job.view, stats, &job.lightTiles);
+                        job.target.SetPixel(i, j, samples.Average());
+                        (*variances)[static_cast<std::size_t>(j) * width + i] = samples.SquaredStandardError();
+                        continue;
+                    }
+
+                    Radiance pixelColor = job.antiAliasing.SamplePixel(
+                        i, j, width, height,
+                        job.camOrigin, job.lowerLeftCorner, job.horizontal, job.vertical,
+                        job.view, stats, &job.lightTiles);
+
+                    // SetPixel is thread-safe here because no two threads
+                    // will ever write to the same 'j' row.
+                    job.target.SetPixel(i, j, pixelColor);
+                }
+            }
+        };
+
+        // Launch threads
+        for (int t = 0; t < numThreads; ++t)
+        {
+            int j_start = t * chunkHeight;
+            // Ensure the last thread covers all remaining rows
+            int j_end = (t == numThreads - 1) ? height : (t + 1) * chunkHeight;
+
+            threads.emplace_back(renderChunk, j_start, j_end, &threadStats[t]);
+        }
+
+        // Wait for all threads to finish
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+
+        PathStats total;
+        for (const PathStats &stats : threadStats)
+            total += stats;
+        return total;
+    }
+}
+
+void render_scene(int width, int height, float screenZ, const char *outputFile,
+                  const RenderSettings &baseSettings)
 {
     Image image(width, height);
 
     std::vector<std::unique_ptr<Shape>> scene;
+    std::vector<Light> lights = Light::Defaults();
+    RenderSettings settings = baseSettings;
 
     std::cout << "Choisir un mode:\n";
     std::cout << "1. Générer une scène JSON\n";
@@ -40,8 +285,10 @@ void render_scene(int width, int height, float screenZ, const char *outputFile)
             std::string outputPath = "../scene_boules.json";
 
             // charge la scène générée
-            auto loadedScene = SceneLoader::LoadFromFile(outputPath);
+            auto loadedScene = SceneLoader::LoadFromFile(outputPath, settings);
             std::cout << "Loaded " << loadedScene.shapes.size() << " shapes.\n";
+            settings = loadedScene.settings;
+            lights = loadedScene.lights;
 
             // Keep your default plane, append loaded shapes
             for (auto &s : loadedScene.shapes)
@@ -84,6 +331,9 @@ void render_scene(int width, int height, float screenZ, const char *outputFile)
             return;
         }
 
+        // Packed view used by the intersection kernels (selects the ISA variant on first use)
+        const Scene sceneView(scene, settings, lights);
+
         // Configuration caméra (at Y = 0, same level as spheres)
         Vec3 camOrigin = {width / 2.0f, 0.0f, -2500.0f};
 
@@ -108,60 +358,156 @@ void render_scene(int width, int height, float screenZ, const char *outputFile)
         // ==================== ANTI-ALIASING CONFIGURATION ====================
         // Higher values = smoother edges but slower rendering
         // samplesPerAxis = 2 → 4 rays/pixel (2x2 grid)   - Fast, noticeable improvement
-        // samplesPerAxis = 4 → 16 rays/pixel (4x4 grid)  - High quality, recommended
+        // samplesPerAxis = 4 → 16 rays/pixel (4x4 grid)  - High quality, recommended (default)
         // samplesPerAxis = 8 → 64 rays/pixel (8x8 grid)  - Ultra quality, very slow
-        AntiAliasing antiAliasing(4);
+        // With "textureFilter", 2 is usually enough: the textures no longer alias
+        // "sampler" / "samplesPerPixel" replace the grid by any number of jittered or low-discrepancy samples
+        AntiAliasing antiAliasing(settings.samplesPerAxis, settings.sampler, settings.samplesPerPixel);
 
-        // ==================== Timer ====================
-        Timer renderTimer;
-
-        // ----- 2. REPLACED: Original loop is now multithreaded -----
+        // Lights that can reach the camera hits of each 16x16 tile
+        const LightTiles lightTiles(lights, width, height, camOrigin, lowerLeftCorner, horizontal, vertical);
+        std::cout << lights.size() << " lumière(s), " << lightTiles.AverageLightsPerTile()
+                  << " par tuile en moyenne ; ombres " << (settings.shadows ? "activées" : "désactivées") << "." << std::endl;
 
         // Get number of available threads
         unsigned int numThreads = std::thread::hardware_concurrency();
         if (numThreads == 0)
             numThreads = 2; // Fallback
+
+        // Textures précalculées, résolution selon la taille des sphères à l'écran
+        if (settings.textureCache)
+        {
+            const TextureBakeStats bake = BakeSphereTextures(
+                scene, camOrigin, static_cast<float>(height) / length(vertical),
+                static_cast<std::size_t>(settings.textureCacheMB) * 1024 * 1024, numThreads);
+            std::cout << "Textures précalculées : " << bake.baked << " sphère(s), "
+                      << bake.bytes / (1024.0 * 1024.0) << " Mo en " << bake.seconds * 1000.0 << " ms ; "
+                      << bake.analytic << " laissée(s) analytique(s) par la limite mémoire." << std::endl;
+        }
+
+        // ==================== Timer ====================
+        Timer renderTimer;
+
+        // ----- 2. REPLACED: Original loop is now multithreaded -----
+
         std::cout << "Rendu avec " << numThreads << " threads." << std::endl;
 
-        std::vector<std::thread> threads;
-        int chunkHeight = height / numThreads;
+        // Image intermédiaire du rendu progressif, à côté de la sortie, supprimée une fois l'image finale écrite
+        std::filesystem::path progressFile(outputFile);
+        progressFile.replace_filename(progressFile.stem().string() + "_progress" + progressFile.extension().string());
 
-        auto renderChunk = [&](int j_start, int j_end)
+        // Renders one image with the pipeline and renderer of the view; returns the path counters
+        auto renderImage = [&](Image &target, const Scene &view, std::vector<int> *sampleCounts = nullptr,
+                               std::vector<float> *variances = nullptr) -> PathStats
         {
-            // Raytracing avec projection perspective uniforme
-            for (int j = j_start; j < j_end; ++j) // Each thread works on a subset of 'j'
+            const RenderJob job{target, view, scene, lights, antiAliasing, camOrigin, lowerLeftCorner, horizontal,
+                                vertical, numThreads, lightTiles, sampleCounts};
+            if (view.GetSettings().pipeline == RenderPipeline::Wavefront)
+                return RenderWavefront(job);
+
+            switch (view.GetSettings().renderer)
+            {
+            case RendererType::Adaptive:
+                return RenderAdaptive(job);
+            case RendererType::Budget:
+                return RenderBudget(job);
+            case RendererType::Progressive:
+                return RenderProgressive(job, progressFile);
+            case RendererType::Quality:
+                return RenderQuality(job);
+            case RendererType::Preview:
+                return RenderPreview(job);
+            case RendererType::Edge:
+                return RenderEdges(job);
+            case RendererType::Film:
+                return RenderFilm(job);
+            case RendererType::Standard:
+            case RendererType::Denoise:
+                break;
+            }
+            return RenderStandard(job, variances);
+        };
+
+        std::vector<int> sampleCounts;
+        std::vector<float> variances;
+        const bool denoise = settings.renderer == RendererType::Denoise;
+        PathStats pathStats = renderImage(image, sceneView, &sampleCounts, denoise ? &variances : nullptr);
+        std::cout << "Profondeur max " << settings.maxDepth << " : " << pathStats.rays << " rayons, "
+                  << pathStats.terminated << " chemins arrêtés avant la profondeur max." << std::endl;
+        if (settings.shadows)
+            std::cout << "Rayons d'ombre : " << pathStats.shadowRays << std::endl;
+
+        if (!sampleCounts.empty())
+        {
+            // Carte du nombre d'échantillons par pixel : noir = le moins échantillonné, blanc = le plus
+            Image sampleMap(width, height);
+            const auto [fewest, most] = std::minmax_element(sampleCounts.begin(), sampleCounts.end());
+            const float minSamples = static_cast<float>(*fewest);
+            const float range = std::max(1.0f, static_cast<float>(*most) - minSamples);
+            for (int j = 0; j < height; ++j)
             {
                 for (int i = 0; i < width; ++i)
                 {
-                    Color pixelColor = antiAliasing.SamplePixel(
-                        i, j, width, height,
-                        camOrigin, lowerLeftCorner, horizontal, vertical,
-                        scene);
-
-                    // SetPixel is thread-safe here because no two threads
-                    // will ever write to the same 'j' row.
-                    image.SetPixel(i, j, pixelColor);
+                    const float level = (static_cast<float>(sampleCounts[static_cast<std::size_t>(j) * width + i]) - minSamples) / range;
+                    sampleMap.SetPixel(i, j, Radiance(level, level, level));
                 }
             }
-        };
+            std::filesystem::path samplesFile(outputFile);
+            samplesFile.replace_filename(samplesFile.stem().string() + "_samples" + samplesFile.extension().string());
+            sampleMap.WriteFile(samplesFile.string().c_str());
+            std::cout << "Carte des échantillons : " << samplesFile.string() << std::endl;
+        }
 
-        // Launch threads
-        for (int t = 0; t < numThreads; ++t)
+        if (settings.depthStats)
         {
-            int j_start = t * chunkHeight;
-            // Ensure the last thread covers all remaining rows
-            int j_end = (t == numThreads - 1) ? height : (t + 1) * chunkHeight;
+            // Reference: same render with a fixed depth, no early termination
+            RenderSettings referenceSettings = settings;
+            referenceSettings.termination = PathTermination::Fixed;
+            const Scene referenceView(scene, referenceSettings, lights);
+            Image reference(width, height);
+            PathStats referenceStats = renderImage(reference, referenceView);
 
-            threads.emplace_back(renderChunk, j_start, j_end);
+            double squaredError = 0.0;
+            float maxError = 0.0f;
+            for (int j = 0; j < height; ++j)
+            {
+                for (int i = 0; i < width; ++i)
+                {
+                    Radiance a = image.GetPixel(i, j);
+                    Radiance b = reference.GetPixel(i, j);
+                    for (float e : {a.R() - b.R(), a.G() - b.G(), a.B() - b.B()})
+                    {
+                        squaredError += static_cast<double>(e) * e;
+                        maxError = std::max(maxError, std::abs(e));
+                    }
+                }
+            }
+            const double saved = referenceStats.rays > 0
+                ? 100.0 * static_cast<double>(referenceStats.rays - pathStats.rays) / static_cast<double>(referenceStats.rays)
+                : 0.0;
+            std::cout << "Référence profondeur fixe : " << referenceStats.rays << " rayons ; économisés "
+                      << referenceStats.rays - pathStats.rays << " (" << saved << " %) ; erreur RMS "
+                      << std::sqrt(squaredError / (3.0 * width * height)) << ", max " << maxError << std::endl;
         }
 
-        // Wait for all threads to finish
-        for (auto &t : threads)
+        if (denoise)
         {
-            t.join();
+            // Débruitage guidé par les normales, la profondeur et la forme vue, chronométré à part
+            Timer denoiseTimer;
+            const DenoiseGuides guides = DenoiseGuides::Trace(sceneView, width, height, camOrigin, lowerLeftCorner,
+                                                              horizontal, vertical, numThreads);
+            const long long guidesMs = denoiseTimer.ElapsedMilliseconds();
+            Denoiser(settings.denoiseIterations, settings.denoiseLuminanceSigma).Apply(image, guides, variances, numThreads);
+            std::cout << "Débruitage : " << denoiseTimer.ElapsedMilliseconds() << " ms, dont " << guidesMs
+                      << " ms de tampons auxiliaires ; " << settings.denoiseIterations << " passes à-trous." << std::endl;
         }
 
-        image.WriteFile(outputFile);
+        image.WriteFile(outputFile, settings.transfer, settings.toneMap);
+        if (settings.renderer == RendererType::Progressive)
+        {
+            std::error_code error;
+            std::filesystem::remove(progressFile, error);
+        }
 
         renderTimer.PrintElapsed("Temps de rendu");
     }
@@ -0,0 +1,234 @@
+#include "Sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// 24 high bits to a float in [0, 1): never rounds up to 1
+float ToUnitFloat(std::uint32_t bits)
+{
+    return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f);
+}
+
+float Fract(float x)
+{
+    return x - std::floor(x);
+}
+
+std::uint32_t ReverseBits(std::uint32_t x)
+{
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+// Kensler's permutation of [0, length) indexed by pattern: a bijection for any length
+std::uint32_t Permute(std::uint32_t i, std::uint32_t length, std::uint32_t pattern)
+{
+    std::uint32_t w = length - 1;
+    w |= w >> 1; w |= w >> 2; w |= w >> 4; w |= w >> 8; w |= w >> 16;
+    do
+    {
+        i ^= pattern;               i *= 0xe170893du;
+        i ^= pattern >> 16;         i ^= (i & w) >> 4;
+        i ^= pattern >> 8;          i *= 0x0929eb3fu;
+        i ^= pattern >> 23;         i ^= (i & w) >> 1;
+        i *= 1 | pattern >> 27;     i *= 0x6935fa69u;
+        i ^= (i & w) >> 11;         i *= 0x74dcb303u;
+        i ^= (i & w) >> 2;          i *= 0x9e501cc3u;
+        i ^= (i & w) >> 2;          i *= 0xc860a3dfu;
+        i &= w;                     i ^= i >> 5;
+    } while (i >= length);
+    return (i + pattern) % length;
+}
+
+// Kensler's hashed jitter in [0, 1)
+float RandomFloat(std::uint32_t i, std::uint32_t pattern)
+{
+    i ^= pattern;
+    i ^= i >> 17; i ^= i >> 10; i *= 0xb36534e5u;
+    i ^= i >> 12; i ^= i >> 21; i *= 0x93fc4795u;
+    i ^= 0xdf6e307fu; i ^= i >> 17; i *= 1 | pattern >> 18;
+    return ToUnitFloat(i);
+}
+
+// Laine-Karras style hash: each output bit depends only on the input bits below it
+std::uint32_t LaineKarrasPermutation(std::uint32_t x, std::uint32_t seed)
+{
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+// Owen scrambling of a 32-bit fraction: random flips of every subtree of the binary digits
+std::uint32_t NestedUniformScramble(std::uint32_t x, std::uint32_t seed)
+{
+    return ReverseBits(LaineKarrasPermutation(ReverseBits(x), seed));
+}
+
+// First two dimensions of the Sobol sequence: van der Corput, then the (0,2) companion
+std::uint32_t Sobol0(std::uint32_t index)
+{
+    return ReverseBits(index);
+}
+
+std::uint32_t Sobol1(std::uint32_t index)
+{
+    std::uint32_t result = 0;
+    for (std::uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1)
+    {
+        if (index & 1u)
+            result ^= v;
+    }
+    return result;
+}
+
+} // namespace
+
+std::uint32_t Sampler::HashPixel(int pixelX, int pixelY, std::uint32_t salt)
+{
+    // PCG-style output permutation over the packed coordinates
+    std::uint32_t h = static_cast<std::uint32_t>(pixelX) * 0x8da6b343u
+                    ^ static_cast<std::uint32_t>(pixelY) * 0xd8163841u
+                    ^ salt * 0xcb1ab31fu;
+    h ^= h >> 16; h *= 0x7feb352du;
+    h ^= h >> 15; h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+std::unique_ptr<Sampler> Sampler::Create(SamplerType type, int sampleCount)
+{
+    switch (type)
+    {
+    case SamplerType::Grid:
+    {
+        const int samplesPerAxis = static_cast<int>(std::lround(std::sqrt(static_cast<double>(sampleCount))));
+        if (samplesPerAxis * samplesPerAxis != sampleCount)
+            throw std::invalid_argument("The grid sampler needs a perfect square sample count");
+        return std::make_unique<GridSampler>(samplesPerAxis);
+    }
+    case SamplerType::Stratified:
+        return std::make_unique<StratifiedSampler>(sampleCount);
+    case SamplerType::Sobol:
+        return std::make_unique<SobolSampler>(sampleCount);
+    case SamplerType::R2:
+        return std::make_unique<R2Sampler>(sampleCount);
+    case SamplerType::BlueNoise:
+        return std::make_unique<BlueNoiseSampler>(sampleCount);
+    }
+    return nullptr;
+}
+
+GridSampler::GridSampler(int samplesPerAxis)
+    : Sampler(samplesPerAxis * samplesPerAxis)
+    , samplesPerAxis_(samplesPerAxis)
+    , invSamplesPerAxis_(1.0f / static_cast<float>(samplesPerAxis))
+{
+}
+
+void GridSampler::Offset(int, int, int index, float& outX, float& outY) const
+{
+    // Center of the cell, row-major
+    outX = (index % samplesPerAxis_ + 0.5f) * invSamplesPerAxis_;
+    outY = (index / samplesPerAxis_ + 0.5f) * invSamplesPerAxis_;
+}
+
+StratifiedSampler::StratifiedSampler(int sampleCount)
+    : Sampler(sampleCount)
+    , columns_(std::max(1, static_cast<int>(std::sqrt(static_cast<float>(sampleCount)))))
+    , rows_((sampleCount + columns_ - 1) / columns_)
+{
+}
+
+void StratifiedSampler::Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const
+{
+    // Correlated multi-jittered sampling: one sample per column and per row of the
+    // columns_ x rows_ strata, and one per each of the sampleCount_ fine rows (n-rooks)
+    const std::uint32_t pattern = HashPixel(pixelX, pixelY, 0x2b4c1f5du);
+    const std::uint32_t s = Permute(static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(sampleCount_), pattern * 0x51633e2du);
+    const std::uint32_t sx = Permute(s % columns_, static_cast<std::uint32_t>(columns_), pattern * 0x68bc21ebu);
+    const std::uint32_t sy = Permute(s / columns_, static_cast<std::uint32_t>(rows_), pattern * 0x02e5be93u);
+    const float jx = RandomFloat(s, pattern * 0x967a889bu);
+    const float jy = RandomFloat(s, pattern * 0x368cc8b7u);
+    outX = std::min((static_cast<float>(sx) + (static_cast<float>(sy) + jx) / static_cast<float>(rows_)) / static_cast<float>(columns_), 0.99999994f);
+    outY = std::min((static_cast<float>(s) + jy) / static_cast<float>(sampleCount_), 0.99999994f);
+}
+
+void SobolSampler::Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const
+{
+    // Burley 2020: shuffle the sequence, then Owen-scramble each dimension with its own seed
+    const std::uint32_t seed = HashPixel(pixelX, pixelY, 0x5f3759dfu);
+    const std::uint32_t shuffled = NestedUniformScramble(static_cast<std::uint32_t>(index), seed);
+    outX = ToUnitFloat(NestedUniformScramble(Sobol0(shuffled), HashPixel(pixelX, pixelY, seed ^ 0xa511e9b3u)));
+    outY = ToUnitFloat(NestedUniformScramble(Sobol1(shuffled), HashPixel(pixelX, pixelY, seed ^ 0x63d83595u)));
+}
+
+void R2Sampler::Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const
+{
+    // Generalized golden ratio g, root of x³ = x + 1: steps 1 / g and 1 / g² fill the square evenly
+    constexpr double g = 1.32471795724474602596;
+    const float shiftX = ToUnitFloat(HashPixel(pixelX, pixelY, 0x1b873593u));
+    const float shiftY = ToUnitFloat(HashPixel(pixelX, pixelY, 0xe6546b64u));
+    // Steps accumulated in double so long sequences keep their precision
+    outX = Fract(static_cast<float>(std::fmod(0.5 + index / g, 1.0)) + shiftX);
+    outY = Fract(static_cast<float>(std::fmod(0.5 + index / (g * g), 1.0)) + shiftY);
+    outX = std::min(outX, 0.99999994f);
+    outY = std::min(outY, 0.99999994f);
+}
+
+BlueNoiseSampler::BlueNoiseSampler(int sampleCount)
+    : Sampler(sampleCount)
+    , points_(static_cast<std::size_t>(PATTERN_COUNT) * sampleCount * 2)
+{
+    // Mitchell's best candidate on the torus, progressive: every prefix of a set is
+    // spread out too. Candidates per point grow with the set, capped to bound the cost
+    auto toroidalDistance2 = [](float ax, float ay, float bx, float by) {
+        float dx = std::abs(ax - bx), dy = std::abs(ay - by);
+        dx = std::min(dx, 1.0f - dx);
+        dy = std::min(dy, 1.0f - dy);
+        return dx * dx + dy * dy;
+    };
+
+    for (int pattern = 0; pattern < PATTERN_COUNT; ++pattern)
+    {
+        float* set = &points_[static_cast<std::size_t>(pattern) * sampleCount * 2];
+        std::uint32_t counter = 0;
+        for (int k = 0; k < sampleCount; ++k)
+        {
+            const int candidates = std::min(8 * k + 1, 64);
+            float bestDistance = -1.0f;
+            for (int c = 0; c < candidates; ++c)
+            {
+                const float x = ToUnitFloat(HashPixel(pattern, static_cast<int>(counter), 0x9e3779b9u));
+                const float y = ToUnitFloat(HashPixel(pattern, static_cast<int>(counter), 0x7f4a7c15u));
+                ++counter;
+                float nearest = 2.0f;
+                for (int other = 0; other < k; ++other)
+                    nearest = std::min(nearest, toroidalDistance2(x, y, set[2 * other], set[2 * other + 1]));
+                if (nearest > bestDistance)
+                {
+                    bestDistance = nearest;
+                    set[2 * k] = x;
+                    set[2 * k + 1] = y;
+                }
+            }
+        }
+    }
+}
+
+void BlueNoiseSampler::Offset(int pixelX, int pixelY, int index, float& outX, float& outY) const
+{
+    // A set per pixel, shifted on the torus so that pixels sharing a set still differ
+    const std::uint32_t hash = HashPixel(pixelX, pixelY, 0x3c6ef372u);
+    const float* set = &points_[static_cast<std::size_t>(hash % PATTERN_COUNT) * sampleCount_ * 2];
+    outX = std::min(Fract(set[2 * index] + ToUnitFloat(hash * 0x9e3779b9u)), 0.99999994f);
+    outY = std::min(Fract(set[2 * index + 1] + ToUnitFloat(hash * 0x85ebca6bu)), 0.99999994f);
+}
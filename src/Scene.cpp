@@ -0,0 +1,147 @@
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Cube.hpp"
+#include "Plane.hpp"
+
+#include <limits>
+#include <utility>
+
+Scene::Scene(const std::vector<std::unique_ptr<Shape>>& shapes, const RenderSettings& settings,
+             std::vector<Light> lights)
+    : _kernels(Kernels::Active()), _settings(settings), _lights(std::move(lights)), _shading(_lights, _settings)
+{
+    for (int i = 0; i < static_cast<int>(_lights.size()); ++i)
+        _allLights.push_back(i);
+
+    _shapes.reserve(shapes.size());
+
+    for (const auto& shape : shapes)
+    {
+        int index = static_cast<int>(_shapes.size());
+        _shapes.push_back(shape.get());
+
+        if (const Sphere* sphere = dynamic_cast<const Sphere*>(shape.get()))
+        {
+            _sphereCx.push_back(sphere->GetCenter().x);
+            _sphereCy.push_back(sphere->GetCenter().y);
+            _sphereCz.push_back(sphere->GetCenter().z);
+            _sphereRadius2.push_back(sphere->GetRadius() * sphere->GetRadius());
+            _sphereShape.push_back(index);
+        }
+        else if (const Cube* cube = dynamic_cast<const Cube*>(shape.get()))
+        {
+            float half = cube->GetSize() / 2.0f;
+            _boxMinX.push_back(cube->GetCenter().x - half);
+            _boxMinY.push_back(cube->GetCenter().y - half);
+            _boxMinZ.push_back(cube->GetCenter().z - half);
+            _boxMaxX.push_back(cube->GetCenter().x + half);
+            _boxMaxY.push_back(cube->GetCenter().y + half);
+            _boxMaxZ.push_back(cube->GetCenter().z + half);
+            _boxShape.push_back(index);
+        }
+        else if (const Plane* plane = dynamic_cast<const Plane*>(shape.get()))
+        {
+            _planePx.push_back(plane->point.x);
+            _planePy.push_back(plane->point.y);
+            _planePz.push_back(plane->point.z);
+            _planeNx.push_back(plane->normal.x);
+            _planeNy.push_back(plane->normal.y);
+            _planeNz.push_back(plane->normal.z);
+            _planeShape.push_back(index);
+        }
+        else
+        {
+            _otherShapes.push_back(index);
+        }
+    }
+
+    // Pad spheres so kernels always load full vectors; -inf radius² can never produce a hit
+    int sphereCount = static_cast<int>(_sphereShape.size());
+    int paddedCount = (sphereCount + LANE_PADDING - 1) / LANE_PADDING * LANE_PADDING;
+    _sphereCx.resize(paddedCount, 0.0f);
+    _sphereCy.resize(paddedCount, 0.0f);
+    _sphereCz.resize(paddedCount, 0.0f);
+    _sphereRadius2.resize(paddedCount, -std::numeric_limits<float>::infinity());
+    _sphereShape.resize(paddedCount, -1);
+
+    _geometry.spheres = {_sphereCx.data(), _sphereCy.data(), _sphereCz.data(), _sphereRadius2.data(),
+                         _sphereShape.data(), sphereCount, paddedCount};
+    _geometry.boxes = {_boxMinX.data(), _boxMinY.data(), _boxMinZ.data(),
+                       _boxMaxX.data(), _boxMaxY.data(), _boxMaxZ.data(),
+                       _boxShape.data(), static_cast<int>(_boxShape.size())};
+    _geometry.planes = {_planePx.data(), _planePy.data(), _planePz.data(),
+                        _planeNx.data(), _planeNy.data(), _planeNz.data(),
+                        _planeShape.data(), static_cast<int>(_planeShape.size())};
+}
+
+const Shape* Scene::ClosestHit(const Vec3& o, const Vec3& d, float& out_t) const
+{
+    const float origin[3] = {o.x, o.y, o.z};
+    const float direction[3] = {d.x, d.y, d.z};
+    return ClosestHit(origin, direction, out_t);
+}
+
+const Shape* Scene::ClosestHit(const Vec3A& o, const Vec3A& d, float& out_t) const
+{
+    alignas(16) float origin[4];
+    alignas(16) float direction[4];
+    o.Store(origin);
+    d.Store(direction);
+    return ClosestHit(origin, direction, out_t);
+}
+
+const Shape* Scene::ClosestHit(const float origin[3], const float direction[3], float& out_t) const
+{
+    float closest_t = 1e30f;
+    const Shape* hit_shape = nullptr;
+
+    float t;
+    int index = _kernels.closestHit(_geometry, origin, direction, t);
+    if (index >= 0 && t < closest_t)
+    {
+        closest_t = t;
+        hit_shape = _shapes[index];
+    }
+
+    if (!_otherShapes.empty())
+    {
+        const Vec3 o(origin[0], origin[1], origin[2]);
+        const Vec3 d(direction[0], direction[1], direction[2]);
+        for (int other : _otherShapes)
+        {
+            if (_shapes[other]->Intersect(o, d, t) && t < closest_t)
+            {
+                closest_t = t;
+                hit_shape = _shapes[other];
+            }
+        }
+    }
+
+    if (hit_shape)
+        out_t = closest_t;
+    return hit_shape;
+}
+
+bool Scene::Occluded(const Vec3A& o, const Vec3A& d, float maxDistance) const
+{
+    alignas(16) float origin[4];
+    alignas(16) float direction[4];
+    o.Store(origin);
+    d.Store(direction);
+
+    if (_kernels.anyHit(_geometry, origin, direction, maxDistance))
+        return true;
+
+    if (!_otherShapes.empty())
+    {
+        const Vec3 ov(origin[0], origin[1], origin[2]);
+        const Vec3 dv(direction[0], direction[1], direction[2]);
+        float t;
+        for (int other : _otherShapes)
+        {
+            if (_shapes[other]->Intersect(ov, dv, t) && t < maxDistance)
+                return true;
+        }
+    }
+    return false;
+}
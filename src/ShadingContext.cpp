@@ -0,0 +1,25 @@
+#include "ShadingContext.hpp"
+
+ShadingContext::ShadingContext(const std::vector<Light>& sceneLights, const RenderSettings& settings)
+    : viewDir(normalize(Vec3(0.0f, 0.0f, -1.0f)))
+    , math(settings.math)
+    , shadows(settings.shadows)
+{
+    lights.reserve(sceneLights.size());
+
+    for (const Light& light : sceneLights)
+    {
+        LightUniforms uniforms;
+        uniforms.type = light.type;
+        uniforms.emission = light.emission;
+        uniforms.position = light.position;
+        uniforms.invRange = light.range == std::numeric_limits<float>::infinity() ? 0.0f : 1.0f / light.range;
+
+        if (light.type == LightType::Directional)
+        {
+            uniforms.toLight = -light.direction;
+            uniforms.halfway = normalize(uniforms.toLight + viewDir);
+        }
+        lights.push_back(uniforms);
+    }
+}
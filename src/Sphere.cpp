@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <cmath>
 #include "MathUtils.hpp"
+#include "TextureCache.hpp"
 #include <random>
 
 Sphere::Sphere(const Vec3& center, float radius, const Color& color, float reflectivity)
@@ -37,57 +38,73 @@ bool Sphere::Intersect(const Vec3 &o, const Vec3 &d, float &out_t)
 }
 
 
-Color Sphere::GetShadedColor(const Vec3& hitPoint) const {
-    Vec3 normal = normalize(hitPoint - _center);
-    Vec3 lightDir = normalize(Vec3(0.0f, -1.0f, 0.3f));
-    Vec3 viewDir = normalize(Vec3(0.0f, 0.0f, -1.0f));
+// Mean of sin(a + x) for x spread uniformly over [-halfPhase, halfPhase], as a factor
+// on sin(a): sinc(halfPhase), cut at its first zero so a wider footprint never flips the sign
+static float BoxAttenuation(float halfPhase, MathMode mathMode) {
+    constexpr float pi = 3.14159265f;
+    if (halfPhase < 1e-4f)
+        return 1.0f;
+    if (halfPhase >= pi)
+        return 0.0f;
+    return FastMath::Sin(halfPhase, mathMode) / halfPhase;
+}
 
-    // === BASE LIGHTING ===
-    const float ambient = 0.15f;
-    float diff = std::max(0.0f, dot(normal, lightDir));
-    Vec3 halfwayDir = normalize(lightDir + viewDir);
-    const float shininess = 64.0f;
-    float spec = std::pow(std::max(0.0f, dot(normal, halfwayDir)), shininess);
-    const float specularStrength = 0.7f;
+Radiance Sphere::GetAlbedo(const Vec3& hitPoint, const Vec3& normal, float footprint, MathMode mathMode) const {
+    // Texture précalculée : valable tant que l'empreinte ne dépasse pas un texel (2r / taille au centre d'une face)
+    float pattern;
+    if (_textureCache && footprint * _textureCache->GetSize() <= 2.0f * _radius)
+        pattern = _textureCache->Sample(normal);
+    else
+        pattern = EvaluatePattern(hitPoint, normal, footprint, mathMode);
 
+    // === APPLY TEXTURE TO BASE COLOR ===
+    return Radiance(_color.R() * pattern, _color.G() * pattern, _color.B() * pattern);
+}
+
+float Sphere::EvaluatePattern(const Vec3& hitPoint, const Vec3& normal, float footprint, MathMode mathMode) const {
     // === TEXTURE SELECTION ===
     float pattern = 1.0f;
-    Vec3 local = hitPoint * 0.02f + Vec3(_textureSeed * 0.001f);
+    constexpr float textureScale = 0.02f;
+    Vec3 local = hitPoint * textureScale + Vec3(_textureSeed * 0.001f);
 
     switch (_textureType)
 {
     case TextureType::Gradient:
-        // dégradé vertical + contraste
+        // dégradé vertical + contraste (basse fréquence, jamais filtré)
         pattern = MathUtils::clamp01(0.3f + 0.7f * normal.y);
         break;
 
     case TextureType::Marble:
         // marbre 
-        pattern = 0.5f + 0.5f * std::sin(local.x * 6.0f + std::sin(local.y * 4.0f) * 3.0f + _textureSeed);
-        pattern = std::pow(pattern, 1.4f); 
+        if (footprint > 0.0f) {
+            // Phase parcourue sur l'empreinte : |gradient de l'argument| * largeur
+            const float inner = FastMath::Sin(local.y * 4.0f, mathMode) * BoxAttenuation(0.5f * footprint * textureScale * 4.0f, mathMode);
+            const float slopeY = 3.0f * 4.0f * FastMath::Cos(local.y * 4.0f, mathMode);
+            const float gradient = textureScale * std::sqrt(6.0f * 6.0f + slopeY * slopeY);
+            pattern = 0.5f + 0.5f * FastMath::Sin(local.x * 6.0f + inner * 3.0f + _textureSeed, mathMode)
+                                  * BoxAttenuation(0.5f * footprint * gradient, mathMode);
+        }
+        else {
+            pattern = 0.5f + 0.5f * FastMath::Sin(local.x * 6.0f + FastMath::Sin(local.y * 4.0f, mathMode) * 3.0f + _textureSeed, mathMode);
+        }
+        pattern = FastMath::Pow(pattern, 1.4f, mathMode);
         break;
 
     case TextureType::Noise:
         
-        pattern = std::fabs(std::sin(local.x * 4.5f + std::cos(local.z * 3.7f) + local.y * 1.5f + _textureSeed));
-        pattern = std::pow(pattern, 0.6f); 
+        pattern = std::fabs(FastMath::Sin(local.x * 4.5f + FastMath::Cos(local.z * 3.7f, mathMode) + local.y * 1.5f + _textureSeed, mathMode));
+        if (footprint > 0.0f) {
+            // |sin| oscille deux fois plus vite que sin, autour de sa moyenne 2 / pi
+            constexpr float mean = 0.63661977f;
+            const float slopeZ = 3.7f * FastMath::Sin(local.z * 3.7f, mathMode);
+            const float gradient = textureScale * std::sqrt(4.5f * 4.5f + 1.5f * 1.5f + slopeZ * slopeZ);
+            pattern = mean + (pattern - mean) * BoxAttenuation(footprint * gradient, mathMode);
+        }
+        pattern = FastMath::Pow(pattern, 0.6f, mathMode);
         break;
 }
 
-    // === APPLY TEXTURE TO BASE COLOR ===
-    float r = _color.R() * pattern;
-    float g = _color.G() * pattern;
-    float b = _color.B() * pattern;
-
-    // === COMBINE LIGHTING ===
-    float diffuseIntensity = ambient + 0.5f * diff;
-    float specularIntensity = specularStrength * spec;
-
-    return Color(
-        MathUtils::clamp01(r * diffuseIntensity + _color.R() * specularIntensity),
-        MathUtils::clamp01(g * diffuseIntensity + _color.G() * specularIntensity),
-        MathUtils::clamp01(b * diffuseIntensity + _color.B() * specularIntensity)
-    );
+    return pattern;
 }
 
 void Sphere::RandomizeTexture() {
@@ -99,4 +116,5 @@ void Sphere::RandomizeTexture() {
     _textureType = static_cast<TextureType>(distType(gen));
     _reflectivity = distReflect(gen);
     _textureSeed = static_cast<float>(rd() % 10000);
+    _textureCache.reset();
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "Sphere.hpp"
+#include "Timer.hpp"
+
+// Faces: 0 +x, 1 -x, 2 +y, 3 -y, 4 +z, 5 -z. On the x faces (u, v) = (y, z) / |x|,
+// on the y faces (x, z) / |y|, on the z faces (x, y) / |z|.
+float SphereTextureCache::Sample(const Vec3& direction) const
+{
+    const float ax = std::fabs(direction.x), ay = std::fabs(direction.y), az = std::fabs(direction.z);
+    int face;
+    float u, v, major;
+    if (ax >= ay && ax >= az)
+    {
+        face = direction.x >= 0.0f ? 0 : 1;
+        u = direction.y; v = direction.z; major = ax;
+    }
+    else if (ay >= az)
+    {
+        face = direction.y >= 0.0f ? 2 : 3;
+        u = direction.x; v = direction.z; major = ay;
+    }
+    else
+    {
+        face = direction.z >= 0.0f ? 4 : 5;
+        u = direction.x; v = direction.y; major = az;
+    }
+    if (major == 0.0f)
+        return texels_[0];
+
+    // Texel i is centered on u = (i + 0.5) / size * 2 - 1
+    const float scale = 0.5f * static_cast<float>(size_) / major;
+    const float x = std::clamp(u * scale + 0.5f * size_ - 0.5f, 0.0f, static_cast<float>(size_ - 1));
+    const float y = std::clamp(v * scale + 0.5f * size_ - 0.5f, 0.0f, static_cast<float>(size_ - 1));
+    const int i0 = static_cast<int>(x), j0 = static_cast<int>(y);
+    const int i1 = std::min(i0 + 1, size_ - 1), j1 = std::min(j0 + 1, size_ - 1);
+    const float fx = x - static_cast<float>(i0), fy = y - static_cast<float>(j0);
+
+    const float bottom = texels_[Index(face, i0, j0)] + (texels_[Index(face, i1, j0)] - texels_[Index(face, i0, j0)]) * fx;
+    const float top = texels_[Index(face, i0, j1)] + (texels_[Index(face, i1, j1)] - texels_[Index(face, i0, j1)]) * fx;
+    return bottom + (top - bottom) * fy;
+}
+
+Vec3 SphereTextureCache::TexelDirection(int face, int i, int j) const
+{
+    const float u = (static_cast<float>(i) + 0.5f) / static_cast<float>(size_) * 2.0f - 1.0f;
+    const float v = (static_cast<float>(j) + 0.5f) / static_cast<float>(size_) * 2.0f - 1.0f;
+    const float sign = (face & 1) ? -1.0f : 1.0f;
+    switch (face >> 1)
+    {
+    case 0:  return normalize(Vec3(sign, u, v));
+    case 1:  return normalize(Vec3(u, sign, v));
+    default: return normalize(Vec3(u, v, sign));
+    }
+}
+
+TextureBakeStats BakeSphereTextures(const std::vector<std::unique_ptr<Shape>>& shapes,
+                                    const Vec3& camOrigin, float pixelsPerUnit,
+                                    std::size_t memoryCapBytes, unsigned numThreads)
+{
+    Timer timer;
+    TextureBakeStats stats;
+
+    struct Job {
+        Sphere* sphere;
+        float projectedRadius;
+        int size;
+    };
+    std::vector<Job> jobs;
+    for (const auto& shape : shapes)
+    {
+        Sphere* sphere = dynamic_cast<Sphere*>(shape.get());
+        if (sphere == nullptr || sphere->GetTextureType() == Sphere::TextureType::Gradient)
+            continue;
+        const float distance = std::max(length(sphere->GetCenter() - camOrigin), sphere->GetRadius());
+        jobs.push_back({sphere, sphere->GetRadius() * pixelsPerUnit / distance, 0});
+    }
+
+    // Largest on screen first, so the memory cap drops the spheres that matter least
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const Job& a, const Job& b) { return a.projectedRadius > b.projectedRadius; });
+
+    std::vector<Job> accepted;
+    for (Job& job : jobs)
+    {
+        job.size = std::clamp(static_cast<int>(std::ceil(job.projectedRadius * 1.5f)), MIN_CACHE_SIZE, MAX_CACHE_SIZE);
+        const std::size_t bytes = SphereTextureCache::BytesFor(job.size);
+        if (stats.bytes + bytes > memoryCapBytes)
+        {
+            job.sphere->SetTextureCache(nullptr);
+            ++stats.analytic;
+            continue;
+        }
+        stats.bytes += bytes;
+        accepted.push_back(job);
+    }
+    stats.baked = static_cast<int>(accepted.size());
+
+    // One sphere at a time per thread; the biggest caches are taken first
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]()
+    {
+        for (std::size_t k = next++; k < accepted.size(); k = next++)
+        {
+            Sphere* sphere = accepted[k].sphere;
+            const Vec3 center = sphere->GetCenter();
+            const float radius = sphere->GetRadius();
+            sphere->SetTextureCache(std::make_shared<const SphereTextureCache>(
+                accepted[k].size, [&](const Vec3& direction) {
+                    return sphere->EvaluatePattern(center + direction * radius, direction);
+                }));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const unsigned count = std::max(1u, std::min<unsigned>(numThreads, static_cast<unsigned>(accepted.size())));
+    for (unsigned t = 1; t < count; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    stats.seconds = timer.ElapsedSeconds();
+    return stats;
+}
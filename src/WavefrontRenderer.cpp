@@ -0,0 +1,391 @@
+#include "WavefrontRenderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Radiance.hpp"
+#include "Ray.hpp"
+
+namespace {
+
+// Below this many items per thread, handing out a stage costs more than the stage itself
+constexpr std::size_t MIN_ITEMS_PER_THREAD = 4096;
+
+/**
+ * Worker threads started once per render and handed every stage in turn, so a
+ * bounce costs no thread start-up. The calling thread works as chunk 0.
+ */
+class StageWorkers
+{
+public:
+    explicit StageWorkers(unsigned numThreads)
+    {
+        for (unsigned w = 1; w < numThreads; ++w)
+            threads_.emplace_back(&StageWorkers::Work, this, w);
+    }
+
+    ~StageWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (std::thread& thread : threads_)
+            thread.join();
+    }
+
+    StageWorkers(const StageWorkers&) = delete;
+    StageWorkers& operator=(const StageWorkers&) = delete;
+
+    /**
+     * Runs fn(begin, end, chunk) over contiguous chunks of [0, count), one per thread.
+     * Returns the number of chunks used (chunk indices are 0..n-1).
+     */
+    template <typename Fn>
+    unsigned ParallelFor(std::size_t count, Fn&& fn)
+    {
+        if (count == 0)
+            return 0;
+
+        const std::size_t threadCount = threads_.size() + 1;
+        unsigned chunks = static_cast<unsigned>(std::min<std::size_t>(threadCount, (count + MIN_ITEMS_PER_THREAD - 1) / MIN_ITEMS_PER_THREAD));
+        chunks = std::max(chunks, 1u);
+        const std::size_t chunkSize = (count + chunks - 1) / chunks;
+        auto runChunk = [&](unsigned c)
+        {
+            const std::size_t begin = std::min(count, c * chunkSize);
+            fn(begin, std::min(count, begin + chunkSize), c);
+        };
+        if (chunks == 1)
+        {
+            runChunk(0);
+            return 1;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stage_ = runChunk;
+            chunks_ = chunks;
+            pending_ = chunks - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+        runChunk(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return pending_ == 0; });
+        stage_ = nullptr;
+        return chunks;
+    }
+
+private:
+    void Work(unsigned index)
+    {
+        unsigned seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+            seen = generation_;
+            if (index >= chunks_)
+                continue;
+
+            lock.unlock();
+            stage_(index);
+            lock.lock();
+            if (--pending_ == 0)
+                done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    std::function<void(unsigned)> stage_;
+    unsigned chunks_ = 0;
+    unsigned pending_ = 0;
+    unsigned generation_ = 0;
+    bool stop_ = false;
+};
+
+// Spreads the low 10 bits of v so two zero bits separate each of them
+std::uint32_t Part1By2(std::uint32_t v)
+{
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Adjacent entries whose hit shape differs, visiting hits in their own order
+long long CountShapeSwitches(const std::vector<HitRecord>& hits)
+{
+    long long switches = 0;
+    for (std::size_t k = 1; k < hits.size(); ++k)
+        switches += hits[k].shape != hits[k - 1].shape;
+    return switches;
+}
+
+// Same, visiting hits in the given order
+long long CountShapeSwitches(const std::vector<HitRecord>& hits, const std::vector<std::uint32_t>& order)
+{
+    long long switches = 0;
+    for (std::size_t k = 1; k < order.size(); ++k)
+        switches += hits[order[k]].shape != hits[order[k - 1]].shape;
+    return switches;
+}
+
+} // namespace
+
+WavefrontRenderer::WavefrontRenderer(const Scene& scene, const AntiAliasing& antiAliasing, bool sortReflections)
+    : scene_(scene), antiAliasing_(antiAliasing), sortReflections_(sortReflections)
+{
+}
+
+void WavefrontRenderer::SortByMortonKey(std::vector<PathState>& queue, std::vector<PathState>& scratch,
+                                        std::vector<std::uint32_t>& spawnOrder)
+{
+    // Grid over the bounds of this queue's origins
+    Vec3 lo(1e30f), hi(-1e30f);
+    for (const PathState& path : queue)
+    {
+        const Vec3 o = static_cast<Vec3>(path.origin);
+        lo = Vec3(std::min(lo.x, o.x), std::min(lo.y, o.y), std::min(lo.z, o.z));
+        hi = Vec3(std::max(hi.x, o.x), std::max(hi.y, o.y), std::max(hi.z, o.z));
+    }
+    auto cellScale = [](float extent) { return extent > 0.0f ? 1023.0f / extent : 0.0f; };
+    const Vec3 scale(cellScale(hi.x - lo.x), cellScale(hi.y - lo.y), cellScale(hi.z - lo.z));
+
+    // Key: direction octant (3 bits) above the 30-bit Morton code of the origin cell,
+    // low 32 bits: position in the spawned queue (unique keys, deterministic order)
+    std::vector<std::uint64_t> keys(queue.size());
+    for (std::size_t r = 0; r < queue.size(); ++r)
+    {
+        const Vec3 o = static_cast<Vec3>(queue[r].origin);
+        const Vec3 d = static_cast<Vec3>(queue[r].direction);
+        const std::uint32_t octant = (d.x < 0.0f ? 4u : 0u) | (d.y < 0.0f ? 2u : 0u) | (d.z < 0.0f ? 1u : 0u);
+        const std::uint32_t morton = (Part1By2(static_cast<std::uint32_t>((o.x - lo.x) * scale.x)) << 2)
+                                   | (Part1By2(static_cast<std::uint32_t>((o.y - lo.y) * scale.y)) << 1)
+                                   | Part1By2(static_cast<std::uint32_t>((o.z - lo.z) * scale.z));
+        keys[r] = (static_cast<std::uint64_t>(octant << 30 | morton) << 32) | r;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    scratch.resize(queue.size());
+    spawnOrder.resize(queue.size());
+    for (std::size_t k = 0; k < keys.size(); ++k)
+    {
+        const std::uint32_t from = static_cast<std::uint32_t>(keys[k]);
+        scratch[k] = queue[from];
+        spawnOrder[from] = static_cast<std::uint32_t>(k);
+    }
+    queue.swap(scratch);
+}
+
+WavefrontStats WavefrontRenderer::Render(Image& image,
+                                         const Vec3& camOrigin,
+                                         const Vec3& lowerLeftCorner,
+                                         const Vec3& horizontal,
+                                         const Vec3& vertical,
+                                         unsigned numThreads,
+                                         const LightTiles* lightTiles) const
+{
+    const int width = image.GetWidth();
+    const int height = image.GetHeight();
+    const int samplesPerPixel = antiAliasing_.GetTotalSamples();
+    const float invSamplesPerPixel = 1.0f / static_cast<float>(samplesPerPixel);
+    numThreads = std::max(numThreads, 1u);
+    const RenderSettings& settings = scene_.GetSettings();
+
+    const Vec3A origin(camOrigin);
+    const Vec3A corner(lowerLeftCorner);
+    const Vec3A horizontalA(horizontal);
+    const Vec3A verticalA(vertical);
+    const Radiance background = Ray::BackgroundColor();
+
+    // Same cones as SamplePixel
+    RayCone cameraCone;
+    if (settings.textureFilter)
+        cameraCone.spread = antiAliasing_.SampleSpread(height, camOrigin, lowerLeftCorner, horizontal, vertical);
+
+    const int rowsPerBatch = std::max(1, BATCH_RAYS / std::max(1, width * samplesPerPixel));
+
+    std::vector<PathState> queue;
+    std::vector<HitRecord> hits;
+    std::vector<std::vector<PathState>> spawned(numThreads);
+    std::vector<PathState> scratch;
+    std::vector<std::uint32_t> spawnOrder;   // spawnOrder[i]: queue position of the i-th spawned ray
+    std::vector<Radiance> sampleRadiance;
+    std::vector<PathStats> chunkStats;       // Early terminations and shadow rays per chunk of the shading stage
+    WavefrontStats stats;
+    StageWorkers workers(numThreads);
+
+    for (int rowBegin = 0; rowBegin < height; rowBegin += rowsPerBatch)
+    {
+        const int rowEnd = std::min(height, rowBegin + rowsPerBatch);
+        const std::size_t pixelCount = static_cast<std::size_t>(rowEnd - rowBegin) * width;
+        const std::size_t sampleCount = pixelCount * samplesPerPixel;
+        // Path seeds continue across batches: same seeds as AntiAliasing::PathSeed
+        const std::uint32_t seedBase = antiAliasing_.PathSeed(0, rowBegin, width, 0);
+
+        sampleRadiance.assign(sampleCount, Radiance());
+
+        // === Stage 1: camera rays, in the sample order of AntiAliasing::SamplePixel ===
+        queue.resize(sampleCount);
+        workers.ParallelFor(pixelCount, [&](std::size_t begin, std::size_t end, unsigned)
+        {
+            for (std::size_t p = begin; p < end; ++p)
+            {
+                const int i = static_cast<int>(p % width);
+                const int j = rowBegin + static_cast<int>(p / width);
+
+                for (int s = 0; s < samplesPerPixel; ++s)
+                {
+                    float offsetX, offsetY;
+                    antiAliasing_.SampleOffset(i, j, s, offsetX, offsetY);
+                    float u_coord = (static_cast<float>(i) + offsetX) / static_cast<float>(width - 1);
+                    float v_coord = (static_cast<float>(j) + offsetY) / static_cast<float>(height - 1);
+
+                    Vec3A pixelPos = corner + horizontalA * u_coord + verticalA * v_coord;
+
+                    const int sample = static_cast<int>(p) * samplesPerPixel + s;
+                    queue[sample] = {origin, normalize(pixelPos - origin), 1.0f, sample, cameraCone};
+                }
+            }
+        });
+
+        // === Bounce loop: intersect the whole queue, shade it, keep the reflection rays ===
+        // Every ray of the queue is the bounce-th reflection of its path (0: camera ray)
+        for (int bounce = 0; !queue.empty() && bounce < settings.maxDepth; ++bounce)
+        {
+            stats.raysTraced += static_cast<long long>(queue.size());
+
+            const bool sorted = bounce > 0 && sortReflections_ && queue.size() > 1;
+            if (sorted)
+            {
+                const auto sortStart = std::chrono::steady_clock::now();
+                SortByMortonKey(queue, scratch, spawnOrder);
+                stats.sortSeconds += SecondsSince(sortStart);
+                stats.sortedRays += static_cast<long long>(queue.size());
+            }
+
+            // Stage 2: closest hits
+            const auto intersectStart = std::chrono::steady_clock::now();
+            hits.resize(queue.size());
+            workers.ParallelFor(queue.size(), [&](std::size_t begin, std::size_t end, unsigned)
+            {
+                for (std::size_t r = begin; r < end; ++r)
+                    Ray(queue[r].origin, queue[r].direction, queue[r].cone).Intersect(scene_, hits[r]);
+            });
+
+            if (bounce > 0)
+            {
+                stats.reflectionIntersectSeconds += SecondsSince(intersectStart);
+                stats.reflectionRays += static_cast<long long>(queue.size());
+            }
+            if (sorted)
+            {
+                // Coherence of the traced order against the spawn order
+                stats.shapeSwitchesTraced += CountShapeSwitches(hits);
+                stats.shapeSwitchesUnsorted += CountShapeSwitches(hits, spawnOrder);
+            }
+
+            // Stage 3: shading and reflection spawn; each path owns its sample, so no write is shared
+            const bool lastBounce = bounce + 1 == settings.maxDepth;
+            chunkStats.assign(numThreads, PathStats());
+            const unsigned chunks = workers.ParallelFor(queue.size(), [&](std::size_t begin, std::size_t end, unsigned chunk)
+            {
+                std::vector<PathState>& out = spawned[chunk];
+                out.clear();
+
+                for (std::size_t r = begin; r < end; ++r)
+                {
+                    const PathState& path = queue[r];
+                    const HitRecord& hit = hits[r];
+                    Radiance& sample = sampleRadiance[path.sample];
+
+                    if (!hit.shape)
+                    {
+                        sample += background * path.throughput;
+                        continue;
+                    }
+
+                    // Camera hits use the light list of their pixel's tile, as SamplePixel
+                    LightSet lights = scene_.AllLights();
+                    if (bounce == 0 && lightTiles)
+                    {
+                        const int pixel = path.sample / samplesPerPixel;
+                        lights = lightTiles->ForPixel(pixel % width, rowBegin + pixel / width);
+                    }
+
+                    float reflectivity;
+                    const Radiance surface = Ray::ShadeSurface(scene_, hit, path.direction, lights, reflectivity,
+                                                               &chunkStats[chunk]);
+                    sample += surface * (path.throughput * (1.0f - reflectivity));
+
+                    // Same termination as TraceScene: the remaining weight goes to the background
+                    float reflectionWeight = path.throughput * reflectivity;
+                    bool continues = !lastBounce;
+                    if (continues && !Ray::ContinuePath(settings, reflectionWeight, seedBase + path.sample, bounce + 1))
+                    {
+                        continues = false;
+                        chunkStats[chunk].terminated += reflectivity > 0.0f;
+                    }
+                    if (!continues)
+                    {
+                        sample += background * reflectionWeight;
+                        continue;
+                    }
+
+                    const Ray reflected = Ray(path.origin, path.direction, path.cone).Reflected(hit);
+                    out.push_back({reflected.GetOrigin(), reflected.GetDirection(), reflectionWeight, path.sample,
+                                   reflected.GetCone()});
+                }
+            });
+
+            for (const PathStats& chunk : chunkStats)
+            {
+                stats.terminatedPaths += chunk.terminated;
+                stats.shadowRays += chunk.shadowRays;
+            }
+
+            // Stage 4: compact the spawned rays into the next queue, in chunk order
+            queue.clear();
+            for (unsigned c = 0; c < chunks; ++c)
+                queue.insert(queue.end(), spawned[c].begin(), spawned[c].end());
+        }
+
+        // Paths still queued when maxDepth is 0, as TraceScene: background only
+        for (const PathState& path : queue)
+            sampleRadiance[path.sample] += background * path.throughput;
+        queue.clear();
+
+        // === Resolve: average the samples of each pixel ===
+        for (std::size_t p = 0; p < pixelCount; ++p)
+        {
+            Radiance sum;
+            for (int s = 0; s < samplesPerPixel; ++s)
+                sum += sampleRadiance[p * samplesPerPixel + s];
+            image.SetPixel(static_cast<unsigned>(p % width), static_cast<unsigned>(rowBegin + p / width),
+                           sum * invSamplesPerPixel);
+        }
+    }
+
+    return stats;
+}
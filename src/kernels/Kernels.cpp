@@ -0,0 +1,82 @@
+#include "Kernels.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+extern const KernelTable KERNELS_SCALAR;
+#ifdef RAYTRACER_X86_KERNELS
+extern const KernelTable KERNELS_SSE42;
+extern const KernelTable KERNELS_AVX2;
+extern const KernelTable KERNELS_AVX512;
+#endif
+
+namespace {
+
+const KernelTable& SelectTable()
+{
+    const IsaLevel detected = CpuFeatures::DetectIsaLevel();
+    IsaLevel wanted = detected;
+    bool forced = false;
+
+    if (const char* env = std::getenv("RAYTRACER_ISA"))
+    {
+        IsaLevel requested;
+        if (!CpuFeatures::ParseIsaLevel(env, requested))
+        {
+            std::cerr << "Warning: unknown RAYTRACER_ISA \"" << env << "\", using detected level\n";
+        }
+        else if (requested > detected)
+        {
+            std::cerr << "Warning: RAYTRACER_ISA=" << env << " is not supported by this CPU, using "
+                      << CpuFeatures::IsaLevelName(detected) << "\n";
+        }
+        else
+        {
+            wanted = requested;
+            forced = true;
+        }
+    }
+
+    // Widest variant built into this binary that does not exceed the wanted level
+    const KernelTable* table = &KERNELS_SCALAR;
+    for (int level = static_cast<int>(wanted); level > 0; --level)
+    {
+        if (const KernelTable* candidate = Kernels::ForLevel(static_cast<IsaLevel>(level)))
+        {
+            table = candidate;
+            break;
+        }
+    }
+
+    std::cout << "Kernels: " << CpuFeatures::IsaLevelName(table->level)
+              << " (CPU: " << CpuFeatures::IsaLevelName(detected)
+              << (forced ? ", forced by RAYTRACER_ISA" : "") << ")" << std::endl;
+    return *table;
+}
+
+} // namespace
+
+namespace Kernels {
+
+const KernelTable& Active()
+{
+    static const KernelTable& table = SelectTable();
+    return table;
+}
+
+const KernelTable* ForLevel(IsaLevel level)
+{
+    switch (level)
+    {
+    case IsaLevel::Scalar: return &KERNELS_SCALAR;
+#ifdef RAYTRACER_X86_KERNELS
+    case IsaLevel::SSE42:  return &KERNELS_SSE42;
+    case IsaLevel::AVX2:   return &KERNELS_AVX2;
+    case IsaLevel::AVX512: return &KERNELS_AVX512;
+#endif
+    default:               return nullptr;
+    }
+}
+
+} // namespace Kernels
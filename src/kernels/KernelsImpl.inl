@@ -0,0 +1,464 @@
+// Kernel bodies shared by every ISA variant.
+//
+// Included once per Kernels_<isa>.cpp, each compiled with its own -m flags and
+// defining one of KERNEL_ISA_SCALAR / KERNEL_ISA_SSE42 / KERNEL_ISA_AVX2 /
+// KERNEL_ISA_AVX512 plus KERNEL_TABLE_NAME.
+//
+// Rules for code in this file:
+// - everything lives in an anonymous namespace (one private copy per variant);
+// - no calls into inline code from other headers (Vec3, <cmath>, <algorithm>,
+//   STL containers): an out-of-line copy compiled here with AVX-512 could be
+//   the one the linker keeps for the whole program. Use __builtin_sqrtf and
+//   friends instead.
+
+#include "Kernels.hpp"
+
+#if !defined(KERNEL_ISA_SCALAR)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr float KERNEL_INF = __builtin_inff();
+
+// Thin per-ISA wrapper over one register of float lanes
+#if defined(KERNEL_ISA_AVX512)
+
+struct Lanes {
+    static constexpr int WIDTH = 16;
+    using F = __m512;
+    using M = __mmask16;
+
+    static F Load(const float* p) { return _mm512_loadu_ps(p); }
+    static F Set(float v) { return _mm512_set1_ps(v); }
+    static void Store(float* p, F v) { _mm512_storeu_ps(p, v); }
+    static F Add(F a, F b) { return _mm512_add_ps(a, b); }
+    static F Sub(F a, F b) { return _mm512_sub_ps(a, b); }
+    static F Mul(F a, F b) { return _mm512_mul_ps(a, b); }
+    static F MulAdd(F a, F b, F c) { return _mm512_fmadd_ps(a, b, c); }
+    static F Sqrt(F a) { return _mm512_sqrt_ps(a); }
+    static F Max(F a, F b) { return _mm512_max_ps(a, b); }
+    static F Min(F a, F b) { return _mm512_min_ps(a, b); }
+    static M Less(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static M GreaterEq(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static M And(M a, M b) { return static_cast<M>(a & b); }
+    static bool Any(M m) { return m != 0; }
+    // m ? a : b
+    static F Select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+    // Truncating conversions; byte stores expect lanes already clamped to [0, 255]
+    static void StoreInt32(int* p, F v) { _mm512_storeu_si512(p, _mm512_cvttps_epi32(v)); }
+    static void StoreBytes(unsigned char* p, F v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(_mm512_cvttps_epi32(v)));
+    }
+};
+
+#elif defined(KERNEL_ISA_AVX2)
+
+struct Lanes {
+    static constexpr int WIDTH = 8;
+    using F = __m256;
+    using M = __m256;
+
+    static F Load(const float* p) { return _mm256_loadu_ps(p); }
+    static F Set(float v) { return _mm256_set1_ps(v); }
+    static void Store(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F MulAdd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+    static F Sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static F Max(F a, F b) { return _mm256_max_ps(a, b); }
+    static F Min(F a, F b) { return _mm256_min_ps(a, b); }
+    static M Less(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M GreaterEq(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static M And(M a, M b) { return _mm256_and_ps(a, b); }
+    static bool Any(M m) { return _mm256_movemask_ps(m) != 0; }
+    static F Select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+    static void StoreInt32(int* p, F v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_cvttps_epi32(v)); }
+    static void StoreBytes(unsigned char* p, F v)
+    {
+        __m256i i32 = _mm256_cvttps_epi32(v);
+        __m128i i16 = _mm_packus_epi32(_mm256_castsi256_si128(i32), _mm256_extracti128_si256(i32, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(i16, i16));
+    }
+};
+
+#elif defined(KERNEL_ISA_SSE42)
+
+struct Lanes {
+    static constexpr int WIDTH = 4;
+    using F = __m128;
+    using M = __m128;
+
+    static F Load(const float* p) { return _mm_loadu_ps(p); }
+    static F Set(float v) { return _mm_set1_ps(v); }
+    static void Store(float* p, F v) { _mm_storeu_ps(p, v); }
+    static F Add(F a, F b) { return _mm_add_ps(a, b); }
+    static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F MulAdd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static F Sqrt(F a) { return _mm_sqrt_ps(a); }
+    static F Max(F a, F b) { return _mm_max_ps(a, b); }
+    static F Min(F a, F b) { return _mm_min_ps(a, b); }
+    static M Less(F a, F b) { return _mm_cmplt_ps(a, b); }
+    static M GreaterEq(F a, F b) { return _mm_cmpge_ps(a, b); }
+    static M And(M a, M b) { return _mm_and_ps(a, b); }
+    static bool Any(M m) { return _mm_movemask_ps(m) != 0; }
+    static F Select(M m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+    static void StoreInt32(int* p, F v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvttps_epi32(v)); }
+    static void StoreBytes(unsigned char* p, F v)
+    {
+        __m128i i32 = _mm_cvttps_epi32(v);
+        __m128i i16 = _mm_packus_epi32(i32, i32);
+        int packed = _mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+        __builtin_memcpy(p, &packed, 4);
+    }
+};
+
+#else
+
+struct Lanes {
+    static constexpr int WIDTH = 1;
+    using F = float;
+    using M = bool;
+
+    static F Load(const float* p) { return *p; }
+    static F Set(float v) { return v; }
+    static void Store(float* p, F v) { *p = v; }
+    static F Add(F a, F b) { return a + b; }
+    static F Sub(F a, F b) { return a - b; }
+    static F Mul(F a, F b) { return a * b; }
+    static F MulAdd(F a, F b, F c) { return a * b + c; }
+    static F Sqrt(F a) { return __builtin_sqrtf(a); }
+    static F Max(F a, F b) { return a > b ? a : b; }
+    static F Min(F a, F b) { return a < b ? a : b; }
+    static M Less(F a, F b) { return a < b; }
+    static M GreaterEq(F a, F b) { return a >= b; }
+    static M And(M a, M b) { return a && b; }
+    static bool Any(M m) { return m; }
+    static F Select(M m, F a, F b) { return m ? a : b; }
+    static void StoreInt32(int* p, F v) { *p = static_cast<int>(v); }
+    static void StoreBytes(unsigned char* p, F v) { *p = static_cast<unsigned char>(static_cast<int>(v)); }
+};
+
+#endif
+
+alignas(64) constexpr float LANE_OFFSETS[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+// Same test as Sphere::Intersect, Lanes::WIDTH spheres at a time.
+// Returns the packed sphere slot of the closest hit closer than best_t, or -1.
+int ClosestSphere(const PackedSpheres& s, const float o[3], const float d[3], float& best_t)
+{
+    using F = Lanes::F;
+    using M = Lanes::M;
+
+    const F ox = Lanes::Set(o[0]), oy = Lanes::Set(o[1]), oz = Lanes::Set(o[2]);
+    const F dx = Lanes::Set(d[0]), dy = Lanes::Set(d[1]), dz = Lanes::Set(d[2]);
+    const F zero = Lanes::Set(0.0f);
+    const F laneOffsets = Lanes::Load(LANE_OFFSETS);
+
+    F bestT = Lanes::Set(best_t);
+    F bestSlot = Lanes::Set(-1.0f);
+    bool found = false;
+
+    // Whole vectors only; the padding up to paddedCount guarantees the loads stay in bounds
+    const int end = (s.count + Lanes::WIDTH - 1) / Lanes::WIDTH * Lanes::WIDTH;
+
+    for (int i = 0; i < end; i += Lanes::WIDTH)
+    {
+        // oc = o - center; with |d| = 1 the quadratic reduces to t^2 + 2*hb*t + c = 0
+        F ocx = Lanes::Sub(ox, Lanes::Load(s.cx + i));
+        F ocy = Lanes::Sub(oy, Lanes::Load(s.cy + i));
+        F ocz = Lanes::Sub(oz, Lanes::Load(s.cz + i));
+
+        F hb = Lanes::MulAdd(dx, ocx, Lanes::MulAdd(dy, ocy, Lanes::Mul(dz, ocz)));
+        F c = Lanes::Sub(Lanes::MulAdd(ocx, ocx, Lanes::MulAdd(ocy, ocy, Lanes::Mul(ocz, ocz))),
+                         Lanes::Load(s.radius2 + i));
+        F disc = Lanes::Sub(Lanes::Mul(hb, hb), c);
+
+        M hit = Lanes::GreaterEq(disc, zero);
+        if (!Lanes::Any(hit))
+            continue;
+
+        F sq = Lanes::Sqrt(Lanes::Max(disc, zero));
+        F t0 = Lanes::Sub(Lanes::Sub(zero, hb), sq);
+        F t1 = Lanes::Add(Lanes::Sub(zero, hb), sq);
+        F t = Lanes::Select(Lanes::Less(t0, zero), t1, t0);
+
+        hit = Lanes::And(hit, Lanes::GreaterEq(t, zero));
+        M closer = Lanes::And(hit, Lanes::Less(t, bestT));
+        if (!Lanes::Any(closer))
+            continue;
+
+        found = true;
+        bestT = Lanes::Select(closer, t, bestT);
+        bestSlot = Lanes::Select(closer, Lanes::Add(Lanes::Set(static_cast<float>(i)), laneOffsets), bestSlot);
+    }
+
+    if (!found)
+        return -1;
+
+    // Horizontal reduction; on equal distances the lowest slot wins, as in a scalar scan
+    alignas(64) float laneT[Lanes::WIDTH];
+    alignas(64) float laneSlot[Lanes::WIDTH];
+    Lanes::Store(laneT, bestT);
+    Lanes::Store(laneSlot, bestSlot);
+
+    int slot = -1;
+    for (int lane = 0; lane < Lanes::WIDTH; ++lane)
+    {
+        if (laneSlot[lane] < 0.0f)
+            continue;
+        int laneSlotIndex = static_cast<int>(laneSlot[lane]);
+        if (laneT[lane] < best_t || (laneT[lane] == best_t && slot >= 0 && laneSlotIndex < slot))
+        {
+            best_t = laneT[lane];
+            slot = laneSlotIndex;
+        }
+    }
+    return slot;
+}
+
+// Early-exit counterpart of ClosestSphere: true as soon as one lane hits in [0, max_t)
+bool AnySphere(const PackedSpheres& s, const float o[3], const float d[3], float max_t)
+{
+    using F = Lanes::F;
+    using M = Lanes::M;
+
+    const F ox = Lanes::Set(o[0]), oy = Lanes::Set(o[1]), oz = Lanes::Set(o[2]);
+    const F dx = Lanes::Set(d[0]), dy = Lanes::Set(d[1]), dz = Lanes::Set(d[2]);
+    const F zero = Lanes::Set(0.0f);
+    const F maxT = Lanes::Set(max_t);
+
+    const int end = (s.count + Lanes::WIDTH - 1) / Lanes::WIDTH * Lanes::WIDTH;
+
+    for (int i = 0; i < end; i += Lanes::WIDTH)
+    {
+        F ocx = Lanes::Sub(ox, Lanes::Load(s.cx + i));
+        F ocy = Lanes::Sub(oy, Lanes::Load(s.cy + i));
+        F ocz = Lanes::Sub(oz, Lanes::Load(s.cz + i));
+
+        F hb = Lanes::MulAdd(dx, ocx, Lanes::MulAdd(dy, ocy, Lanes::Mul(dz, ocz)));
+        F c = Lanes::Sub(Lanes::MulAdd(ocx, ocx, Lanes::MulAdd(ocy, ocy, Lanes::Mul(ocz, ocz))),
+                         Lanes::Load(s.radius2 + i));
+        F disc = Lanes::Sub(Lanes::Mul(hb, hb), c);
+
+        M hit = Lanes::GreaterEq(disc, zero);
+        if (!Lanes::Any(hit))
+            continue;
+
+        F sq = Lanes::Sqrt(Lanes::Max(disc, zero));
+        F t0 = Lanes::Sub(Lanes::Sub(zero, hb), sq);
+        F t1 = Lanes::Add(Lanes::Sub(zero, hb), sq);
+        F t = Lanes::Select(Lanes::Less(t0, zero), t1, t0);
+
+        hit = Lanes::And(hit, Lanes::And(Lanes::GreaterEq(t, zero), Lanes::Less(t, maxT)));
+        if (Lanes::Any(hit))
+            return true;
+    }
+    return false;
+}
+
+// One axis of the slab test in Cube::Intersect
+inline bool Slab(float o, float inv, bool parallel, float mn, float mx, float& tmin, float& tmax)
+{
+    if (parallel)
+    {
+        // Ray parallel to this axis: must be inside slab
+        return !(o < mn || o > mx);
+    }
+    float t1 = (mn - o) * inv;
+    float t2 = (mx - o) * inv;
+    if (t1 > t2)
+    {
+        float tmp = t1;
+        t1 = t2;
+        t2 = tmp;
+    }
+    tmin = t1 > tmin ? t1 : tmin;
+    tmax = t2 < tmax ? t2 : tmax;
+    return tmax >= tmin;
+}
+
+// Same slab test as Cube::Intersect, with the per-ray divisions hoisted out of the loop
+int ClosestBox(const PackedBoxes& b, const float o[3], const float d[3], float& best_t)
+{
+    if (b.count == 0)
+        return -1;
+
+    const float EPS = 1e-8f;
+    bool parallel[3];
+    float inv[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        parallel[axis] = __builtin_fabsf(d[axis]) < EPS;
+        inv[axis] = parallel[axis] ? 0.0f : 1.0f / d[axis];
+    }
+
+    int slot = -1;
+    for (int i = 0; i < b.count; ++i)
+    {
+        float tmin = -KERNEL_INF;
+        float tmax = KERNEL_INF;
+
+        if (!Slab(o[0], inv[0], parallel[0], b.minX[i], b.maxX[i], tmin, tmax) ||
+            !Slab(o[1], inv[1], parallel[1], b.minY[i], b.maxY[i], tmin, tmax) ||
+            !Slab(o[2], inv[2], parallel[2], b.minZ[i], b.maxZ[i], tmin, tmax))
+            continue;
+
+        float t = (tmin >= 0.0f) ? tmin : tmax;
+        if (t >= 0.0f && t < best_t)
+        {
+            best_t = t;
+            slot = i;
+        }
+    }
+    return slot;
+}
+
+bool AnyBox(const PackedBoxes& b, const float o[3], const float d[3], float max_t)
+{
+    const float EPS = 1e-8f;
+    bool parallel[3];
+    float inv[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        parallel[axis] = __builtin_fabsf(d[axis]) < EPS;
+        inv[axis] = parallel[axis] ? 0.0f : 1.0f / d[axis];
+    }
+
+    for (int i = 0; i < b.count; ++i)
+    {
+        float tmin = -KERNEL_INF;
+        float tmax = KERNEL_INF;
+
+        if (!Slab(o[0], inv[0], parallel[0], b.minX[i], b.maxX[i], tmin, tmax) ||
+            !Slab(o[1], inv[1], parallel[1], b.minY[i], b.maxY[i], tmin, tmax) ||
+            !Slab(o[2], inv[2], parallel[2], b.minZ[i], b.maxZ[i], tmin, tmax))
+            continue;
+
+        float t = (tmin >= 0.0f) ? tmin : tmax;
+        if (t >= 0.0f && t < max_t)
+            return true;
+    }
+    return false;
+}
+
+// Same test as Plane::Intersect
+int ClosestPlane(const PackedPlanes& p, const float o[3], const float d[3], float& best_t)
+{
+    int slot = -1;
+
+    for (int i = 0; i < p.count; ++i)
+    {
+        float denom = p.nx[i] * d[0] + p.ny[i] * d[1] + p.nz[i] * d[2];
+        if (__builtin_fabsf(denom) <= 1e-6f)
+            continue;
+
+        float t = ((p.px[i] - o[0]) * p.nx[i] + (p.py[i] - o[1]) * p.ny[i] + (p.pz[i] - o[2]) * p.nz[i]) / denom;
+        if (t >= 1e-4f && t < best_t)
+        {
+            best_t = t;
+            slot = i;
+        }
+    }
+    return slot;
+}
+
+bool AnyPlane(const PackedPlanes& p, const float o[3], const float d[3], float max_t)
+{
+    for (int i = 0; i < p.count; ++i)
+    {
+        float denom = p.nx[i] * d[0] + p.ny[i] * d[1] + p.nz[i] * d[2];
+        if (__builtin_fabsf(denom) <= 1e-6f)
+            continue;
+
+        float t = ((p.px[i] - o[0]) * p.nx[i] + (p.py[i] - o[1]) * p.ny[i] + (p.pz[i] - o[2]) * p.nz[i]) / denom;
+        if (t >= 1e-4f && t < max_t)
+            return true;
+    }
+    return false;
+}
+
+int ClosestHit(const PackedGeometry& geometry, const float origin[3], const float direction[3], float& out_t)
+{
+    float best_t = KERNEL_INF;
+    int shapeIndex = -1;
+
+    int slot = ClosestSphere(geometry.spheres, origin, direction, best_t);
+    if (slot >= 0)
+        shapeIndex = geometry.spheres.shapeIndex[slot];
+
+    slot = ClosestBox(geometry.boxes, origin, direction, best_t);
+    if (slot >= 0)
+        shapeIndex = geometry.boxes.shapeIndex[slot];
+
+    slot = ClosestPlane(geometry.planes, origin, direction, best_t);
+    if (slot >= 0)
+        shapeIndex = geometry.planes.shapeIndex[slot];
+
+    if (shapeIndex >= 0)
+        out_t = best_t;
+    return shapeIndex;
+}
+
+// Shadow rays only need a yes/no answer: planes (few, cheap) first, then the
+// boxes, then the sphere lanes, returning on the first hit
+bool AnyHit(const PackedGeometry& geometry, const float origin[3], const float direction[3], float max_t)
+{
+    return AnyPlane(geometry.planes, origin, direction, max_t) ||
+           AnyBox(geometry.boxes, origin, direction, max_t) ||
+           AnySphere(geometry.spheres, origin, direction, max_t);
+}
+
+// Clamps and truncates Lanes::WIDTH channel values per step. Without a LUT,
+// values in [0, 1] map to floor(v * 255) like the former scalar loop; with a
+// LUT they are rounded to the nearest of its entries first.
+void QuantizeChannels(const float* values, unsigned char* out, std::size_t count, const unsigned char* lut)
+{
+    const float scale = lut ? static_cast<float>(TRANSFER_LUT_SIZE - 1) : 255.0f;
+    const float bias = lut ? 0.5f : 0.0f;
+
+    const Lanes::F vScale = Lanes::Set(scale);
+    const Lanes::F vBias = Lanes::Set(bias);
+    const Lanes::F vZero = Lanes::Set(0.0f);
+
+    std::size_t i = 0;
+    for (; i + Lanes::WIDTH <= count; i += Lanes::WIDTH)
+    {
+        // Max first so NaN lanes end up at 0
+        Lanes::F v = Lanes::Add(Lanes::Mul(Lanes::Load(values + i), vScale), vBias);
+        v = Lanes::Min(Lanes::Max(v, vZero), vScale);
+
+        if (!lut)
+        {
+            Lanes::StoreBytes(out + i, v);
+            continue;
+        }
+
+        alignas(64) int index[Lanes::WIDTH];
+        Lanes::StoreInt32(index, v);
+        for (int lane = 0; lane < Lanes::WIDTH; ++lane)
+            out[i + lane] = lut[index[lane]];
+    }
+
+    for (; i < count; ++i)
+    {
+        float v = values[i] * scale + bias;
+        v = v > 0.0f ? v : 0.0f;
+        v = v < scale ? v : scale;
+        int q = static_cast<int>(v);
+        out[i] = lut ? lut[q] : static_cast<unsigned char>(q);
+    }
+}
+
+} // namespace
+
+extern const KernelTable KERNEL_TABLE_NAME;
+const KernelTable KERNEL_TABLE_NAME = {
+    KERNEL_ISA_LEVEL,
+    &ClosestHit,
+    &AnyHit,
+    &QuantizeChannels,
+};
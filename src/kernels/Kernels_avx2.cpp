@@ -0,0 +1,6 @@
+// Compiled with -mavx2 -mfma (see src/CMakeLists.txt).
+#define KERNEL_ISA_AVX2
+#define KERNEL_ISA_LEVEL IsaLevel::AVX2
+#define KERNEL_TABLE_NAME KERNELS_AVX2
+
+#include "KernelsImpl.inl"
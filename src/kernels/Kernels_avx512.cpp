@@ -0,0 +1,6 @@
+// Compiled with -mavx512f -mavx512vl -mavx512bw -mavx512dq (see src/CMakeLists.txt).
+#define KERNEL_ISA_AVX512
+#define KERNEL_ISA_LEVEL IsaLevel::AVX512
+#define KERNEL_TABLE_NAME KERNELS_AVX512
+
+#include "KernelsImpl.inl"
@@ -0,0 +1,6 @@
+// Plain C++ fallback, compiled with the project's default flags.
+#define KERNEL_ISA_SCALAR
+#define KERNEL_ISA_LEVEL IsaLevel::Scalar
+#define KERNEL_TABLE_NAME KERNELS_SCALAR
+
+#include "KernelsImpl.inl"
@@ -0,0 +1,6 @@
+// Compiled with -msse4.2 (see src/CMakeLists.txt).
+#define KERNEL_ISA_SSE42
+#define KERNEL_ISA_LEVEL IsaLevel::SSE42
+#define KERNEL_TABLE_NAME KERNELS_SSE42
+
+#include "KernelsImpl.inl"
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Color.hpp"
+#include "Plane.hpp"
+#include "Shape.hpp"
+#include "Sphere.hpp"
+#include "Vec3.hpp"
+
+// Camera at z = -300 looking down +z, view plane one unit ahead and centered on the axis;
+// the spans set the aspect ratio. Unpacks as [camOrigin, horizontal, vertical, lowerLeftCorner]
+struct TestCamera {
+    Vec3 camOrigin{0.0f, 0.0f, -300.0f};
+    Vec3 horizontal;
+    Vec3 vertical;
+    Vec3 lowerLeftCorner;
+
+    explicit TestCamera(float verticalSpan = 0.72f, float horizontalSpan = 1.2f)
+        : horizontal(horizontalSpan, 0.0f, 0.0f)
+        , vertical(0.0f, verticalSpan, 0.0f)
+        , lowerLeftCorner(camOrigin + Vec3(0, 0, 1) - horizontal * 0.5f - vertical * 0.5f)
+    {
+    }
+};
+
+// Red sphere of radius 60 at z = 150 over the checkered floor at y = 80, in the middle of a TestCamera view
+inline std::vector<std::unique_ptr<Shape>> SphereOnFloor(float reflectivity = 0.6f)
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(0.0f, 0.0f, 150.0f), 60.0f, Color(1.0f, 0.3f, 0.2f), reflectivity));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    return shapes;
+}
@@ -0,0 +1,90 @@
+#include "../doctest.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "AdaptiveRenderer.hpp"
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "Plane.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "TestScenes.hpp"
+
+TEST_CASE("Adaptive sample order is a stratified permutation of the grid")
+{
+    const AntiAliasing antiAliasing(4);
+    std::vector<int> order = antiAliasing.GetSampleOrder();
+    REQUIRE(order.size() == 16);
+
+    // First 4 cells: one per quadrant of the pixel
+    std::vector<int> quadrants;
+    for (int k = 0; k < 4; ++k)
+        quadrants.push_back((order[k] % 4) / 2 + 2 * ((order[k] / 4) / 2));
+    std::sort(quadrants.begin(), quadrants.end());
+    CHECK(quadrants == std::vector<int>{0, 1, 2, 3});
+
+    std::sort(order.begin(), order.end());
+    for (int k = 0; k < 16; ++k)
+        CHECK(order[k] == k);
+
+    // Not a power of two: still every cell once
+    std::vector<int> odd = AntiAliasing(3).GetSampleOrder();
+    std::sort(odd.begin(), odd.end());
+    CHECK(odd == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8});
+}
+
+TEST_CASE("Adaptive rendering spends samples on edges only and matches the full grid")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(0.0f, 0.0f, 200.0f), 60.0f, Color(1.0f, 0.3f, 0.2f)));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+
+    RenderSettings settings;
+    settings.renderer = RendererType::Adaptive;
+    const Scene scene(shapes, settings);
+    const RenderSettings fullSettings;
+    const Scene fullScene(shapes, fullSettings);
+
+    const int width = 48, height = 32;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera(0.8f);
+    const AntiAliasing antiAliasing(4);
+
+    // Up to the whole grid, AddSamples traces the same rays as SamplePixel
+    AntiAliasing::PixelSamples pixel;
+    antiAliasing.AddSamples(pixel, 100, 20, 14, width, height, camOrigin, lowerLeftCorner, horizontal, vertical, scene);
+    CHECK(pixel.count == 16);
+    const Radiance grid = antiAliasing.SamplePixel(20, 14, width, height, camOrigin, lowerLeftCorner, horizontal, vertical, scene);
+    CHECK(pixel.Average().R() == doctest::Approx(grid.R()));
+    CHECK(pixel.Average().G() == doctest::Approx(grid.G()));
+
+    Image image(width, height);
+    std::vector<int> counts;
+    const AdaptiveRenderer renderer(scene, antiAliasing);
+    const AdaptiveStats stats = renderer.Render(image, camOrigin, lowerLeftCorner, horizontal, vertical, 3, nullptr, &counts);
+    REQUIRE(counts.size() == static_cast<std::size_t>(width * height));
+
+    long long total = 0;
+    float maxError = 0.0f;
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const int count = counts[j * width + i];
+            CHECK(count >= 4);
+            CHECK(count <= 16);
+            total += count;
+            const Radiance full = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                           horizontal, vertical, fullScene);
+            maxError = std::max(maxError, std::abs(image.GetPixel(i, j).R() - full.R()));
+        }
+    }
+    CHECK(stats.samples == total);
+    CHECK(stats.refinedPixels > 0);
+    CHECK(total < static_cast<long long>(width) * height * 16 / 2);
+    CHECK(maxError < 0.1f);
+
+    // The center of the sphere and the sky above it are uniform: first pass only
+    CHECK(counts[16 * width + 24] == 4);
+    CHECK(counts[31 * width + 2] == 4);
+}
@@ -0,0 +1,111 @@
+#include "../doctest.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Cube.hpp"
+#include "Plane.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "TestScenes.hpp"
+
+namespace {
+
+struct TestView : TestCamera {
+    int width = 48, height = 27;
+
+    TestView() : TestCamera(0.9f, 1.6f) {}
+};
+
+std::vector<std::unique_ptr<Shape>> TestShapes()
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(-40.0f, 0.0f, 150.0f), 50.0f, Color(1.0f, 0.3f, 0.2f), 0.6f));
+    shapes.push_back(std::make_unique<Cube>(Vec3(70.0f, 10.0f, 120.0f), 40.0f, Color(0.2f, 0.4f, 1.0f), 0.3f));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    return shapes;
+}
+
+} // namespace
+
+TEST_CASE("Specialized grids pick the compile-time path and match the generic loop bit for bit")
+{
+    const auto shapes = TestShapes();
+    const Scene scene(shapes);
+    const TestView view;
+
+    for (int samplesPerAxis = 1; samplesPerAxis <= 8; ++samplesPerAxis)
+    {
+        CAPTURE(samplesPerAxis);
+        const AntiAliasing antiAliasing(samplesPerAxis);
+        const bool specialized = samplesPerAxis == 1 || samplesPerAxis == 2 || samplesPerAxis == 4 || samplesPerAxis == 8;
+        CHECK(antiAliasing.IsSpecialized() == specialized);
+
+        for (int j = 0; j < view.height; j += 2)
+        {
+            for (int i = 0; i < view.width; i += 3)
+            {
+                PathStats fastStats, genericStats;
+                const Radiance fast = antiAliasing.SamplePixel(i, j, view.width, view.height, view.camOrigin,
+                                                               view.lowerLeftCorner, view.horizontal, view.vertical,
+                                                               scene, &fastStats);
+                const Radiance generic = antiAliasing.SamplePixelGeneric(i, j, view.width, view.height, view.camOrigin,
+                                                                         view.lowerLeftCorner, view.horizontal,
+                                                                         view.vertical, scene, &genericStats);
+                CHECK(fast.R() == generic.R());
+                CHECK(fast.G() == generic.G());
+                CHECK(fast.B() == generic.B());
+                CHECK(fastStats.rays == genericStats.rays);
+            }
+        }
+    }
+
+    // The other samplers keep the generic loop
+    CHECK_FALSE(AntiAliasing(4, SamplerType::Sobol).IsSpecialized());
+    CHECK_FALSE(AntiAliasing(2, SamplerType::Stratified, 4).IsSpecialized());
+}
+
+TEST_CASE("Specialized grid sampling time against the generic loop")
+{
+    const auto shapes = TestShapes();
+    const Scene scene(shapes);
+    TestView view;
+    view.width = 160;
+    view.height = 90;
+
+    for (int samplesPerAxis : {1, 2, 4, 8})
+    {
+        const AntiAliasing antiAliasing(samplesPerAxis);
+        auto time = [&](bool specialized)
+        {
+            float sink = 0.0f;
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (int j = 0; j < view.height; ++j)
+            {
+                for (int i = 0; i < view.width; ++i)
+                {
+                    const Radiance r = specialized
+                        ? antiAliasing.SamplePixel(i, j, view.width, view.height, view.camOrigin, view.lowerLeftCorner,
+                                                   view.horizontal, view.vertical, scene)
+                        : antiAliasing.SamplePixelGeneric(i, j, view.width, view.height, view.camOrigin,
+                                                          view.lowerLeftCorner, view.horizontal, view.vertical, scene);
+                    sink += r.R();
+                }
+            }
+            const std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+            CHECK(sink > 0.0f);
+            return duration.count();
+        };
+
+        // Best of three runs each, alternated, to keep the scheduler noise out
+        double generic = time(false), specialized = time(true);
+        for (int run = 1; run < 3; ++run)
+        {
+            generic = std::min(generic, time(false));
+            specialized = std::min(specialized, time(true));
+        }
+        MESSAGE(samplesPerAxis << "x" << samplesPerAxis << " grid: generic " << generic << " ms, specialized "
+                << specialized << " ms (" << generic / specialized << "x)");
+    }
+}
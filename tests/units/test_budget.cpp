@@ -0,0 +1,112 @@
+#include "../doctest.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "BudgetRenderer.hpp"
+#include "Image.hpp"
+#include "Plane.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "TestScenes.hpp"
+
+namespace {
+
+struct BudgetScene : TestCamera {
+    std::vector<std::unique_ptr<Shape>> shapes;
+    int width = 64, height = 48;
+
+    BudgetScene() : TestCamera(0.9f)
+    {
+        // A sphere in the lower half, in front of a checkered floor; the top rows are empty sky
+        shapes.push_back(std::make_unique<Sphere>(Vec3(0.0f, 30.0f, 150.0f), 40.0f, Color(1.0f, 0.3f, 0.2f), 0.6f));
+        shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    }
+};
+
+} // namespace
+
+TEST_CASE("A generous budget takes every pixel to the cap, the same samples as AddSamples")
+{
+    BudgetScene s;
+    RenderSettings settings;
+    settings.renderer = RendererType::Budget;
+    settings.timeBudgetMs = 60000;
+    const Scene scene(s.shapes, settings);
+    const AntiAliasing antiAliasing(4, SamplerType::Sobol, 16);
+
+    Image image(s.width, s.height);
+    std::vector<int> counts;
+    const BudgetStats stats = BudgetRenderer(scene, antiAliasing)
+        .Render(image, s.camOrigin, s.lowerLeftCorner, s.horizontal, s.vertical, 2, nullptr, &counts);
+
+    // Every pixel at the cap: the queue empties long before the deadline
+    CHECK(stats.samples == static_cast<long long>(s.width) * s.height * 16);
+    CHECK(stats.elapsedMs < 60000.0);
+    CHECK(std::all_of(counts.begin(), counts.end(), [](int count) { return count == 16; }));
+    CHECK(stats.tilesX == 4);
+    CHECK(stats.tilesY == 3);
+    CHECK(std::all_of(stats.tileSamples.begin(), stats.tileSamples.end(), [](float n) { return n == 16.0f; }));
+
+    for (int j = 0; j < s.height; j += 5)
+    {
+        for (int i = 0; i < s.width; i += 7)
+        {
+            AntiAliasing::PixelSamples pixel;
+            antiAliasing.AddSamples(pixel, 16, i, j, s.width, s.height, s.camOrigin, s.lowerLeftCorner,
+                                    s.horizontal, s.vertical, scene);
+            CHECK(image.GetPixel(i, j).R() == doctest::Approx(pixel.Average().R()).epsilon(1e-5));
+            CHECK(image.GetPixel(i, j).G() == doctest::Approx(pixel.Average().G()).epsilon(1e-5));
+        }
+    }
+}
+
+TEST_CASE("A short budget stops at the deadline and refines the noisy tiles first")
+{
+    BudgetScene s;
+    s.width = 160;
+    s.height = 96;
+    RenderSettings settings;
+    settings.renderer = RendererType::Budget;
+    settings.timeBudgetMs = 1;
+    settings.adaptiveMinSamples = 2;
+    const Scene scene(s.shapes, settings);
+    const AntiAliasing antiAliasing(4, SamplerType::Sobol, 4096);
+
+    // A 1 ms budget: the first pass is cut by the deadline too, the pixels it missed copy a sampled one
+    Image image(s.width, s.height);
+    std::vector<int> counts;
+    const BudgetStats quick = BudgetRenderer(scene, antiAliasing)
+        .Render(image, s.camOrigin, s.lowerLeftCorner, s.horizontal, s.vertical, 2, nullptr, &counts);
+    CHECK(quick.elapsedMs < 1.0 + 100.0);
+    CHECK(quick.unsampledPixels == std::count(counts.begin(), counts.end(), 0));
+    if (quick.unsampledPixels > 0)
+    {
+        CHECK(quick.tileRefinements == 0);
+        CHECK(std::all_of(counts.begin(), counts.end(), [](int count) { return count <= 1; }));
+    }
+    for (int j = 0; j < s.height; ++j)
+    {
+        for (int i = 0; i < s.width; ++i)
+        {
+            if (quick.samples > 0)
+                CHECK(image.GetPixel(i, j).R() > 0.0f);
+            else
+                CHECK(image.GetPixel(i, j).B() == Ray::BackgroundColor().B());
+        }
+    }
+
+    // A longer one, far from the cap: it ends on the clock, and the empty sky, without
+    // variance, never gets past the first batch size
+    settings.timeBudgetMs = 200;
+    const Scene longer(s.shapes, settings);
+    const BudgetStats stats = BudgetRenderer(longer, antiAliasing)
+        .Render(image, s.camOrigin, s.lowerLeftCorner, s.horizontal, s.vertical, 2, nullptr, &counts);
+    CHECK(stats.elapsedMs >= 200.0);
+    CHECK(stats.elapsedMs < 1200.0);
+    CHECK(stats.unsampledPixels == 0);
+    CHECK(stats.tileRefinements > 0);
+    for (int tile = 0; tile < stats.tilesX; ++tile)
+        CHECK(stats.tileSamples[tile] == 2.0f);
+    CHECK(*std::max_element(stats.tileSamples.begin(), stats.tileSamples.end()) > 2.0f);
+}
@@ -0,0 +1,127 @@
+#include "../doctest.h"
+#include <memory>
+#include <vector>
+#include "Denoiser.hpp"
+#include "Image.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "TestScenes.hpp"
+
+namespace {
+
+// Guides of a flat image: every pixel on the same shape, facing the camera, at the same depth
+DenoiseGuides FlatGuides(int width, int height, const Shape* shape)
+{
+    DenoiseGuides guides;
+    guides.width = width;
+    guides.height = height;
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    guides.shapes.assign(count, shape);
+    guides.normals.assign(count, Vec3(0.0f, 0.0f, -1.0f));
+    guides.depths.assign(count, 100.0f);
+    return guides;
+}
+
+// Deterministic noise in [-amplitude, amplitude], by steps of amplitude / 10
+float Noise(int i, int j, float amplitude)
+{
+    const unsigned hash = (static_cast<unsigned>(i) * 73856093u) ^ (static_cast<unsigned>(j) * 19349663u);
+    return amplitude * (static_cast<float>(hash % 21u) / 10.0f - 1.0f);
+}
+
+} // namespace
+
+TEST_CASE("Denoiser keeps constant and noise-free images, smooths noisy flat regions")
+{
+    const int width = 32, height = 24;
+    const Sphere sphere(Vec3(0.0f, 0.0f, 150.0f), 60.0f, Color(1.0f, 1.0f, 1.0f), 0.0f);
+    const DenoiseGuides guides = FlatGuides(width, height, &sphere);
+    const Denoiser denoiser(3, 0.5f);
+
+    // Constant image: every weighted mean gives the constant back
+    Image flat(width, height);
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            flat.SetPixel(i, j, Radiance(0.3f, 0.5f, 0.7f));
+    denoiser.Apply(flat, guides, std::vector<float>(static_cast<std::size_t>(width) * height, 0.01f), 2);
+    CHECK(flat.GetPixel(0, 0).R() == doctest::Approx(0.3f));
+    CHECK(flat.GetPixel(17, 11).G() == doctest::Approx(0.5f));
+    CHECK(flat.GetPixel(width - 1, height - 1).B() == doctest::Approx(0.7f));
+
+    // Noisy image, samples that agree (zero variance): the differences are real, nothing moves
+    Image sharp(width, height), noisy(width, height);
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const float value = 0.5f + Noise(i, j, 0.1f);
+            sharp.SetPixel(i, j, Radiance(value, value, value));
+            noisy.SetPixel(i, j, Radiance(value, value, value));
+        }
+    }
+    denoiser.Apply(sharp, guides, std::vector<float>(static_cast<std::size_t>(width) * height, 0.0f), 1);
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            CHECK(sharp.GetPixel(i, j).R() == doctest::Approx(0.5f + Noise(i, j, 0.1f)).epsilon(1e-4));
+
+    // Same image, samples whose spread explains the differences: it flattens towards 0.5
+    denoiser.Apply(noisy, guides, std::vector<float>(static_cast<std::size_t>(width) * height, 0.04f), 3);
+    double before = 0.0, after = 0.0;
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            before += Noise(i, j, 0.1f) * Noise(i, j, 0.1f);
+            after += (noisy.GetPixel(i, j).R() - 0.5f) * (noisy.GetPixel(i, j).R() - 0.5f);
+        }
+    }
+    CHECK(after < 0.25 * before);
+}
+
+TEST_CASE("Denoiser does not blur across silhouettes, and the guides see the scene")
+{
+    const auto shapes = SphereOnFloor(0.0f);
+    const Scene scene(shapes);
+
+    const int width = 40, height = 24;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera();
+
+    const DenoiseGuides guides = DenoiseGuides::Trace(scene, width, height, camOrigin, lowerLeftCorner,
+                                                      horizontal, vertical, 2);
+    REQUIRE(guides.shapes.size() == static_cast<std::size_t>(width) * height);
+
+    // The sphere fills the middle, facing the camera; the sky above the horizon is background
+    const std::size_t middle = static_cast<std::size_t>(height / 2) * width + width / 2;
+    CHECK(guides.shapes[middle] == shapes[0].get());
+    CHECK(guides.normals[middle].z < -0.9f);
+    CHECK(guides.depths[middle] == doctest::Approx(390.0f).epsilon(0.02));
+    int sky = 0, floor = 0;
+    for (const Shape* shape : guides.shapes)
+    {
+        sky += shape == nullptr;
+        floor += shape == shapes[1].get();
+    }
+    CHECK(sky > 0);
+    CHECK(floor > 0);
+
+    // Bright sphere, dark elsewhere, everything flagged as noisy: the two never mix
+    Image image(width, height);
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const bool onSphere = guides.shapes[static_cast<std::size_t>(j) * width + i] == shapes[0].get();
+            const float value = onSphere ? 1.0f : 0.0f;
+            image.SetPixel(i, j, Radiance(value, value, value));
+        }
+    }
+    Denoiser(4, 100.0f).Apply(image, guides, std::vector<float>(static_cast<std::size_t>(width) * height, 1.0f), 2);
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const bool onSphere = guides.shapes[static_cast<std::size_t>(j) * width + i] == shapes[0].get();
+            CHECK(image.GetPixel(i, j).R() == doctest::Approx(onSphere ? 1.0f : 0.0f));
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#include "../doctest.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "EdgeRenderer.hpp"
+#include "Image.hpp"
+#include "Plane.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "TestScenes.hpp"
+
+TEST_CASE("Edge-detected anti-aliasing supersamples silhouettes and reflection edges only")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(-40.0f, 0.0f, 200.0f), 50.0f, Color(1.0f, 0.3f, 0.2f), 0.8f));
+    shapes.push_back(std::make_unique<Sphere>(Vec3(70.0f, 10.0f, 260.0f), 40.0f, Color(0.2f, 0.3f, 1.0f)));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+
+    RenderSettings settings;
+    settings.renderer = RendererType::Edge;
+    const Scene scene(shapes, settings);
+
+    const int width = 64, height = 40;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera(0.75f);
+    const AntiAliasing antiAliasing(4);
+
+    Image image(width, height);
+    std::vector<int> counts;
+    const EdgeRenderer renderer(scene, antiAliasing);
+    const EdgeStats stats = renderer.Render(image, camOrigin, lowerLeftCorner, horizontal, vertical, 3, nullptr, &counts);
+    REQUIRE(counts.size() == static_cast<std::size_t>(width * height));
+
+    long long total = 0, edges = 0;
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const int count = counts[j * width + i];
+            total += count;
+            if (count == 1)
+                continue;
+            // Edge pixels are exactly the full grid
+            CHECK(count == 17);
+            ++edges;
+            const Radiance full = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                           horizontal, vertical, scene);
+            CHECK(image.GetPixel(i, j).R() == full.R());
+            CHECK(image.GetPixel(i, j).B() == full.B());
+        }
+    }
+    CHECK(stats.samples == total);
+    CHECK(stats.edgePixels == edges);
+    CHECK(edges > 0);
+    CHECK(edges < width * height / 3);
+
+    // The two silhouettes along the middle row are edges, the middle of the red sphere is not
+    const int row = height / 2;
+    int transitions = 0;
+    for (int i = 1; i < width; ++i)
+        transitions += (counts[row * width + i] > 1) != (counts[row * width + i - 1] > 1);
+    CHECK(transitions >= 4);
+
+    // Neighbors on one smooth surface are alike; another shape, a turned normal or another reflection is an edge
+    EdgeRenderer::SurfaceId a, b;
+    a.shape = b.shape = shapes[0].get();
+    a.normal = normalize(Vec3(0.0f, 0.0f, -1.0f));
+    b.normal = normalize(Vec3(0.05f, 0.0f, -1.0f));
+    CHECK_FALSE(a.DiffersFrom(b));
+    b.normal = normalize(Vec3(0.6f, 0.0f, -1.0f));
+    CHECK(a.DiffersFrom(b));
+    b.normal = a.normal;
+    b.reflected = shapes[2].get();
+    CHECK(a.DiffersFrom(b));
+    b.reflected = nullptr;
+    b.shape = shapes[1].get();
+    CHECK(a.DiffersFrom(b));
+}
+
+TEST_CASE("Coverage anti-aliasing: exact pixel split, lone sphere silhouettes take two samples")
+{
+    // Vertical edge through the center, then shifted a quarter pixel, then a diagonal
+    EdgeRenderer::Coverage half = EdgeRenderer::PixelCoverage(0.0f, 1.0f, 0.0f);
+    CHECK(half.inside == doctest::Approx(0.5f));
+    CHECK(half.insideX == doctest::Approx(0.25f));
+    CHECK(half.outsideX == doctest::Approx(-0.25f));
+    CHECK(half.insideY == doctest::Approx(0.0f));
+    EdgeRenderer::Coverage shifted = EdgeRenderer::PixelCoverage(0.25f, 1.0f, 0.0f);
+    CHECK(shifted.inside == doctest::Approx(0.75f));
+    CHECK(shifted.insideX == doctest::Approx(0.125f));
+    CHECK(shifted.outsideX == doctest::Approx(-0.375f));
+    EdgeRenderer::Coverage diagonal = EdgeRenderer::PixelCoverage(0.0f, 1.0f, 1.0f);
+    CHECK(diagonal.inside == doctest::Approx(0.5f));
+    CHECK(diagonal.insideX == doctest::Approx(1.0f / 6.0f));
+    CHECK(diagonal.insideY == doctest::Approx(1.0f / 6.0f));
+    CHECK(EdgeRenderer::PixelCoverage(2.0f, 1.0f, 0.5f).inside == doctest::Approx(1.0f));
+    CHECK(EdgeRenderer::PixelCoverage(-2.0f, 1.0f, 0.5f).inside == doctest::Approx(0.0f));
+
+    // A matte sphere against the background, no floor
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(0.0f, 0.0f, 200.0f), 90.0f, Color(1.0f, 0.3f, 0.2f)));
+    RenderSettings settings;
+    settings.renderer = RendererType::Edge;
+    const Scene edgeScene(shapes, settings);
+    settings.coverageAA = true;
+    const Scene coverageScene(shapes, settings);
+
+    const int width = 64, height = 40;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera(0.75f);
+    const AntiAliasing antiAliasing(4);
+    const AntiAliasing reference(16);
+
+    Image grid(width, height), covered(width, height);
+    std::vector<int> gridCounts, counts;
+    const EdgeStats gridStats = EdgeRenderer(edgeScene, antiAliasing)
+        .Render(grid, camOrigin, lowerLeftCorner, horizontal, vertical, 2, nullptr, &gridCounts);
+    const EdgeStats stats = EdgeRenderer(coverageScene, antiAliasing)
+        .Render(covered, camOrigin, lowerLeftCorner, horizontal, vertical, 2, nullptr, &counts);
+
+    // Every silhouette pixel is resolved by coverage, closer to the reference than the 16-sample grid
+    CHECK(stats.coveragePixels == gridStats.edgePixels);
+    CHECK(stats.edgePixels == 0);
+    CHECK(stats.samples < gridStats.samples);
+    double gridError = 0.0, coverageError = 0.0;
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const int index = j * width + i;
+            if (gridCounts[index] == 1)
+            {
+                CHECK(counts[index] == 1);
+                continue;
+            }
+            CHECK(counts[index] <= 2);
+            const float expected = reference.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                         horizontal, vertical, edgeScene).G();
+            gridError += std::abs(grid.GetPixel(i, j).G() - expected);
+            coverageError += std::abs(covered.GetPixel(i, j).G() - expected);
+            CHECK(covered.GetPixel(i, j).G() == doctest::Approx(expected).epsilon(0.05));
+        }
+    }
+    CHECK(coverageError < gridError);
+}
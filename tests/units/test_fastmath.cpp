@@ -0,0 +1,52 @@
+#include "../doctest.h"
+#include <cmath>
+#include "FastMath.hpp"
+
+// Scans check the error bounds documented in FastMath.hpp
+
+TEST_CASE("FastMath sin and cos stay within 8e-7 of std:: over the texture range")
+{
+    float maxError = 0.0f;
+    for (int i = -200000; i <= 200000; ++i)
+    {
+        const float x = i * 0.05f;
+        maxError = std::max(maxError, std::fabs(FastMath::Sin(x) - static_cast<float>(std::sin(static_cast<double>(x)))));
+        maxError = std::max(maxError, std::fabs(FastMath::Cos(x) - static_cast<float>(std::cos(static_cast<double>(x)))));
+    }
+    CHECK(maxError < 8.5e-7f);
+}
+
+TEST_CASE("FastMath exp2, log2 and pow stay within their relative bounds")
+{
+    for (int i = -1260; i < 1270; ++i)
+    {
+        const float x = i * 0.1f + 0.0371f;
+        const double expected = std::exp2(static_cast<double>(x));
+        CHECK(std::fabs(FastMath::Exp2(x) / expected - 1.0) < 2.5e-7);
+    }
+
+    for (float x = 1e-6f; x < 10.0f; x *= 1.01f)
+    {
+        CHECK(std::fabs(FastMath::Log2(x) - std::log2(static_cast<double>(x))) < 1.5e-6);
+        if (x <= 1.0f)
+        {
+            CHECK(std::fabs(FastMath::Pow(x, 1.4f) / std::pow(static_cast<double>(x), 1.4) - 1.0) < 2e-6);
+            CHECK(std::fabs(FastMath::Pow(x, 0.6f) / std::pow(static_cast<double>(x), 0.6) - 1.0) < 2e-6);
+        }
+    }
+    CHECK(FastMath::Pow(0.0f, 2.0f) == 0.0f);
+}
+
+TEST_CASE("FastMath PowInt matches repeated multiplication")
+{
+    CHECK(FastMath::PowInt<0>(3.0f) == 1.0f);
+    CHECK(FastMath::PowInt<5>(2.0f) == 32.0f);
+    CHECK(FastMath::PowInt(2.0f, 10) == 1024.0f);
+
+    for (float x = 0.3f; x <= 1.0f; x += 0.001f)
+    {
+        const double expected = std::pow(static_cast<double>(x), 64.0);
+        CHECK(std::fabs(FastMath::PowInt<64>(x) / expected - 1.0) < 4e-6);
+        CHECK(FastMath::PowInt<64>(x, MathMode::Exact) == doctest::Approx(std::pow(x, 64.0f)));
+    }
+}
@@ -0,0 +1,148 @@
+#include "../doctest.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Film.hpp"
+#include "FilmRenderer.hpp"
+#include "Image.hpp"
+#include "Scene.hpp"
+#include "TestScenes.hpp"
+
+TEST_CASE("Reconstruction filters peak at the sample and vanish past their radius")
+{
+    for (PixelFilter type : {PixelFilter::Box, PixelFilter::Gaussian, PixelFilter::Mitchell, PixelFilter::BlackmanHarris})
+    {
+        CAPTURE(static_cast<int>(type));
+        const ReconstructionFilter filter(type);
+        const float radius = filter.GetRadius();
+        CHECK(radius == ReconstructionFilter::DefaultRadius(type));
+
+        CHECK(filter.Weight1D(0.0f) > 0.0f);
+        CHECK(filter.Weight1D(radius * 1.01f) == 0.0f);
+        CHECK(filter.Weight1D(-radius * 1.01f) == 0.0f);
+        for (float dx = 0.0f; dx <= radius; dx += 0.037f)
+        {
+            // Symmetric, never above the center, and the table follows the closed form
+            CHECK(filter.Weight1D(dx) == filter.Weight1D(-dx));
+            CHECK(filter.Weight1D(dx) <= filter.Weight1D(0.0f) + 1e-6f);
+            CHECK(filter.Weight1D(dx) == doctest::Approx(filter.Evaluate1D(dx)).epsilon(1e-3));
+        }
+        CHECK(filter.Weight(0.3f, -0.7f) == doctest::Approx(filter.Weight1D(0.3f) * filter.Weight1D(0.7f)));
+    }
+
+    // Mitchell sharpens with a negative lobe; its radius stretches the cubic
+    const ReconstructionFilter mitchell(PixelFilter::Mitchell);
+    CHECK(mitchell.Weight1D(1.5f) < 0.0f);
+    CHECK(ReconstructionFilter(PixelFilter::Mitchell, 4.0f).Weight1D(3.0f) == doctest::Approx(mitchell.Weight1D(1.5f)));
+
+    CHECK_THROWS_AS(ReconstructionFilter(PixelFilter::Gaussian, -1.0f), std::invalid_argument);
+    CHECK_THROWS_AS(ReconstructionFilter(PixelFilter::Gaussian, 9.0f), std::invalid_argument);
+}
+
+TEST_CASE("Film tiles splat across their borders and merge into the same image")
+{
+    const int width = 12, height = 9;
+
+    // A few samples, including some on tile borders and image borders
+    struct Sample { float x, y; Radiance radiance; };
+    const std::vector<Sample> samples = {
+        {5.9f, 4.1f, Radiance(1.0f, 0.0f, 0.0f)},
+        {6.05f, 4.2f, Radiance(0.0f, 1.0f, 0.0f)},
+        {0.1f, 0.2f, Radiance(0.0f, 0.0f, 1.0f)},
+        {11.9f, 8.9f, Radiance(1.0f, 1.0f, 1.0f)},
+        {3.5f, 7.5f, Radiance(0.5f, 0.2f, 0.1f)},
+    };
+
+    // One tile for everything
+    Film whole(width, height, ReconstructionFilter(PixelFilter::Gaussian));
+    FilmTile all = whole.MakeTile(0, 0, width, height);
+    for (const Sample& s : samples)
+        all.AddSample(s.x, s.y, s.radiance);
+    whole.MergeTile(all);
+
+    // Four tiles, each getting the samples of its own pixels
+    Film split(width, height, ReconstructionFilter(PixelFilter::Gaussian));
+    for (int ty = 0; ty < 2; ++ty)
+    {
+        for (int tx = 0; tx < 2; ++tx)
+        {
+            const int x0 = tx * 6, y0 = ty * 4, x1 = tx ? width : 6, y1 = ty ? height : 4;
+            FilmTile tile = split.MakeTile(x0, y0, x1, y1);
+            for (const Sample& s : samples)
+            {
+                if (s.x >= x0 && s.x < x1 && s.y >= y0 && s.y < y1)
+                    tile.AddSample(s.x, s.y, s.radiance);
+            }
+            split.MergeTile(tile);
+        }
+    }
+
+    Image a(width, height), b(width, height);
+    whole.Resolve(a);
+    split.Resolve(b);
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            CHECK(a.GetPixel(i, j).R() == doctest::Approx(b.GetPixel(i, j).R()));
+            CHECK(a.GetPixel(i, j).G() == doctest::Approx(b.GetPixel(i, j).G()));
+            CHECK(a.GetPixel(i, j).B() == doctest::Approx(b.GetPixel(i, j).B()));
+        }
+    }
+
+    // The red sample at x = 5.9 (left tiles) reaches pixel 6 (right tiles), mixed with the green one
+    CHECK(a.GetPixel(6, 4).R() > 0.1f);
+    CHECK(a.GetPixel(6, 4).G() > a.GetPixel(6, 4).R());
+
+    // Constant radiance stays constant whatever the weights
+    Film flat(width, height, ReconstructionFilter(PixelFilter::Mitchell));
+    FilmTile tile = flat.MakeTile(0, 0, width, height);
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            tile.AddSample(i + 0.25f, j + 0.75f, Radiance(0.4f, 0.4f, 0.4f));
+    flat.MergeTile(tile);
+    Image c(width, height);
+    flat.Resolve(c);
+    CHECK(c.GetPixel(0, 0).R() == doctest::Approx(0.4f));
+    CHECK(c.GetPixel(7, 5).G() == doctest::Approx(0.4f));
+}
+
+TEST_CASE("Filtered rendering: the one-pixel box matches SamplePixel, threads do not change the image")
+{
+    const auto shapes = SphereOnFloor();
+    const Scene scene(shapes);
+
+    const int width = 40, height = 24;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera();
+    const AntiAliasing antiAliasing(2);
+
+    Image box(width, height);
+    const FilmStats stats = FilmRenderer(scene, antiAliasing, ReconstructionFilter(PixelFilter::Box))
+        .Render(box, camOrigin, lowerLeftCorner, horizontal, vertical, 2);
+    CHECK(stats.samples == width * height * 4);
+    CHECK(stats.tiles == 3 * 2);
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const Radiance expected = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                               horizontal, vertical, scene);
+            CHECK(box.GetPixel(i, j).R() == doctest::Approx(expected.R()).epsilon(1e-5));
+            CHECK(box.GetPixel(i, j).B() == doctest::Approx(expected.B()).epsilon(1e-5));
+        }
+    }
+
+    const FilmRenderer mitchell(scene, antiAliasing, ReconstructionFilter(PixelFilter::Mitchell));
+    Image one(width, height), three(width, height);
+    mitchell.Render(one, camOrigin, lowerLeftCorner, horizontal, vertical, 1);
+    mitchell.Render(three, camOrigin, lowerLeftCorner, horizontal, vertical, 3);
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            CHECK(one.GetPixel(i, j).R() == three.GetPixel(i, j).R());
+            CHECK(one.GetPixel(i, j).G() == three.GetPixel(i, j).G());
+        }
+    }
+}
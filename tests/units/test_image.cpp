@@ -48,8 +48,65 @@ TEST_CASE("Image has background color, width and height")
     CHECK(image.GetWidth() == 1920);
     CHECK(image.GetHeight() == 1080);
 
-    Color pixel = image.GetPixel(0, 0);
+    Radiance pixel = image.GetPixel(0, 0);
     CHECK(pixel.R() == 0.1f);
     CHECK(pixel.G() == 0.1f);
     CHECK(pixel.B() == 0.12f);
 }
+
+TEST_CASE("WriteFile encodes an RGB PNG with the requested transfer curve")
+{
+    Image image(4, 2, Color(0.5f, 0.0f, 1.0f));
+
+    image.WriteFile("test_linear.png");
+    image.WriteFile("test_srgb.png", TransferCurve::SRGB);
+
+    std::vector<unsigned char> pixels;
+    unsigned width = 0, height = 0;
+
+    REQUIRE(lodepng::decode(pixels, width, height, "test_linear.png", LCT_RGB, 8) == 0);
+    CHECK(width == 4);
+    CHECK(height == 2);
+    CHECK(pixels[0] == 127);
+    CHECK(pixels[1] == 0);
+    CHECK(pixels[2] == 255);
+
+    // sRGB(0.5) = 0.7354 ; decode appends to its output vector
+    pixels.clear();
+    REQUIRE(lodepng::decode(pixels, width, height, "test_srgb.png", LCT_RGB, 8) == 0);
+    CHECK(pixels[0] == 188);
+    CHECK(pixels[1] == 0);
+    CHECK(pixels[2] == 255);
+}
+
+TEST_CASE("Image keeps radiance above 1 until the tone-mapping stage")
+{
+    Image image(2, 1, Radiance(3.0f, 0.5f, -1.0f));
+    CHECK(image.GetPixel(1, 0).R() == 3.0f);
+
+    image.WriteFile("test_clamp.png");
+    image.WriteFile("test_reinhard.png", TransferCurve::Linear, ToneMapOperator::Reinhard);
+    image.WriteFile("test_aces.png", TransferCurve::Linear, ToneMapOperator::ACES);
+
+    std::vector<unsigned char> pixels;
+    unsigned width = 0, height = 0;
+
+    REQUIRE(lodepng::decode(pixels, width, height, "test_clamp.png", LCT_RGB, 8) == 0);
+    CHECK(pixels[0] == 255);
+    CHECK(pixels[1] == 127);
+    CHECK(pixels[2] == 0);
+
+    // Reinhard: 3 / 4 = 0.75, 0.5 / 1.5 = 0.333
+    pixels.clear();
+    REQUIRE(lodepng::decode(pixels, width, height, "test_reinhard.png", LCT_RGB, 8) == 0);
+    CHECK(pixels[0] == 191);
+    CHECK(pixels[1] == 85);
+    CHECK(pixels[2] == 0);
+
+    // ACES: 3 -> 0.9537, 0.5 -> 0.6163
+    pixels.clear();
+    REQUIRE(lodepng::decode(pixels, width, height, "test_aces.png", LCT_RGB, 8) == 0);
+    CHECK(pixels[0] == 243);
+    CHECK(pixels[1] == 157);
+    CHECK(pixels[2] == 0);
+}
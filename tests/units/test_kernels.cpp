@@ -0,0 +1,142 @@
+#include "../doctest.h"
+#include <memory>
+#include <vector>
+#include "CpuFeatures.hpp"
+#include "Kernels.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Cube.hpp"
+#include "Plane.hpp"
+
+namespace {
+
+std::vector<std::unique_ptr<Shape>> MakeShapes()
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    // 20 spheres so every SIMD width sees a partial last vector
+    for (int i = 0; i < 20; ++i)
+        shapes.push_back(std::make_unique<Sphere>(Vec3(i * 100.0f, 0.0f, 50.0f * (i % 3)), 40.0f, Color(1, 0, 0)));
+    shapes.push_back(std::make_unique<Cube>(Vec3(500.0f, -200.0f, 0.0f), 120.0f, Color(0, 1, 0)));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0, 300.0f, 0), Vec3(0, -1, 0), 0.5f));
+    return shapes;
+}
+
+} // namespace
+
+TEST_CASE("ISA level names round-trip through the parser")
+{
+    for (IsaLevel level : {IsaLevel::Scalar, IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::AVX512})
+    {
+        IsaLevel parsed = IsaLevel::Scalar;
+        CHECK(CpuFeatures::ParseIsaLevel(CpuFeatures::IsaLevelName(level), parsed));
+        CHECK(parsed == level);
+    }
+
+    IsaLevel parsed = IsaLevel::Scalar;
+    CHECK(CpuFeatures::ParseIsaLevel("AVX-512", parsed));
+    CHECK(parsed == IsaLevel::AVX512);
+    CHECK_FALSE(CpuFeatures::ParseIsaLevel("neon", parsed));
+}
+
+TEST_CASE("Every runnable kernel variant matches Shape::Intersect")
+{
+    auto shapes = MakeShapes();
+    Scene scene(shapes);
+    const IsaLevel detected = CpuFeatures::DetectIsaLevel();
+
+    // Reference: brute force over the virtual intersection routines
+    auto reference = [&](const Vec3& o, const Vec3& d, float& out_t) -> int {
+        int best = -1;
+        float closest = 1e30f;
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            float t;
+            if (shapes[i]->Intersect(o, d, t) && t < closest)
+            {
+                closest = t;
+                best = static_cast<int>(i);
+            }
+        }
+        out_t = closest;
+        return best;
+    };
+
+    const Vec3 origin(950.0f, -10.0f, -2000.0f);
+    for (int level = 0; level <= static_cast<int>(detected); ++level)
+    {
+        const KernelTable* table = Kernels::ForLevel(static_cast<IsaLevel>(level));
+        if (!table)
+            continue;
+
+        CAPTURE(CpuFeatures::IsaLevelName(table->level));
+        for (int iy = -10; iy <= 10; ++iy)
+        {
+            for (int ix = -20; ix <= 20; ++ix)
+            {
+                Vec3 dir = normalize(Vec3(ix * 0.025f, iy * 0.02f, 1.0f));
+
+                float expected_t;
+                int expected = reference(origin, dir, expected_t);
+
+                const float o[3] = {origin.x, origin.y, origin.z};
+                const float d[3] = {dir.x, dir.y, dir.z};
+                float t = 0.0f;
+                int index = table->closestHit(scene.GetGeometry(), o, d, t);
+
+                CHECK(index == expected);
+                if (expected >= 0)
+                    CHECK(t == doctest::Approx(expected_t).epsilon(1e-4));
+
+                // Occlusion: hit iff the closest hit is nearer than the light
+                CHECK(table->anyHit(scene.GetGeometry(), o, d, 1e30f) == (expected >= 0));
+                if (expected >= 0)
+                {
+                    CHECK_FALSE(table->anyHit(scene.GetGeometry(), o, d, expected_t * 0.99f));
+                    CHECK(table->anyHit(scene.GetGeometry(), o, d, expected_t * 1.01f));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Channel quantization truncates, clamps and applies the transfer table")
+{
+    // 19 values so every SIMD width also runs its scalar tail
+    std::vector<float> values(19, 0.5f);
+    values[0] = 0.0f;
+    values[1] = 1.0f;
+    values[2] = -0.2f;
+    values[3] = 1.5f;
+    values[4] = 0.999f;
+    values[18] = 0.25f;
+
+    std::vector<unsigned char> lut(TRANSFER_LUT_SIZE);
+    for (int i = 0; i < TRANSFER_LUT_SIZE; ++i)
+        lut[i] = static_cast<unsigned char>(i * 255 / (TRANSFER_LUT_SIZE - 1));
+
+    for (int level = 0; level <= static_cast<int>(CpuFeatures::DetectIsaLevel()); ++level)
+    {
+        const KernelTable* table = Kernels::ForLevel(static_cast<IsaLevel>(level));
+        if (!table)
+            continue;
+
+        CAPTURE(CpuFeatures::IsaLevelName(table->level));
+        std::vector<unsigned char> linear(values.size());
+        std::vector<unsigned char> mapped(values.size());
+        table->quantizeChannels(values.data(), linear.data(), values.size(), nullptr);
+        table->quantizeChannels(values.data(), mapped.data(), values.size(), lut.data());
+
+        CHECK(linear[0] == 0);
+        CHECK(linear[1] == 255);
+        CHECK(linear[2] == 0);
+        CHECK(linear[3] == 255);
+        CHECK(linear[4] == 254);
+        CHECK(linear[10] == 127);
+        CHECK(linear[18] == 63);
+
+        CHECK(mapped[0] == 0);
+        CHECK(mapped[1] == 255);
+        CHECK(mapped[10] == 127);
+        CHECK(mapped[18] == 63);
+    }
+}
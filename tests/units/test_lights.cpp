@@ -0,0 +1,141 @@
+#include "../doctest.h"
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "LightTiles.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "ShadingContext.hpp"
+#include "Sphere.hpp"
+#include "Plane.hpp"
+#include "TestScenes.hpp"
+
+namespace {
+
+// Floor color seen straight down from above the floor at x
+Radiance FloorAt(const Scene& scene, float x, PathStats* stats = nullptr)
+{
+    Ray ray(Vec3A(x, -300.0f, 0.0f), Vec3A(0.0f, 1.0f, 0.0f));
+    HitRecord hit;
+    REQUIRE(ray.Intersect(scene, hit));
+    float reflectivity;
+    return Ray::ShadeSurface(scene, hit, ray.GetDirection(), scene.AllLights(), reflectivity, stats);
+}
+
+} // namespace
+
+TEST_CASE("Shadow rays darken the floor under a sphere only")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(0.0f, 0.0f, 0.0f), 30.0f, Color(1.0f, 1.0f, 1.0f)));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 100.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f)));
+
+    // Light travelling down (+y), straight onto the floor
+    const std::vector<Light> lights = {Light::Directional(Vec3(0.0f, 1.0f, 0.0f))};
+    RenderSettings shadowed;
+    shadowed.shadows = true;
+    const Scene plain(shapes, RenderSettings(), lights);
+    const Scene scene(shapes, shadowed, lights);
+
+    PathStats stats;
+    // The camera ray above x = 0 hits the sphere first; look past it from below the sphere
+    Ray ray(Vec3A(0.0f, 50.0f, 0.0f), Vec3A(0.0f, 1.0f, 0.0f));
+    HitRecord hit;
+    REQUIRE(ray.Intersect(scene, hit));
+    float reflectivity;
+    const Radiance underSphere = Ray::ShadeSurface(scene, hit, ray.GetDirection(), scene.AllLights(), reflectivity, &stats);
+    const Radiance unshadowed = Ray::ShadeSurface(plain, hit, ray.GetDirection(), plain.AllLights(), reflectivity);
+
+    // Fully occluded: the checker drops to the ambient level
+    CHECK(underSphere.R() == doctest::Approx(unshadowed.R() * 0.15f));
+    CHECK(stats.shadowRays == 1);
+
+    // Away from the sphere nothing changes
+    const Radiance open = FloorAt(scene, 200.0f, &stats);
+    const Radiance reference = FloorAt(plain, 200.0f);
+    CHECK(open.R() == reference.R());
+    CHECK(stats.shadowRays == 2);
+}
+
+TEST_CASE("Shading context precomputes the light vectors and fades point lights at their range")
+{
+    const std::vector<Light> lights = {Light::Point(Vec3(0.0f, 0.0f, 0.0f), 100.0f),
+                                       Light::Directional(Vec3(0.0f, 1.0f, -0.3f))};
+    const ShadingContext shading(lights, RenderSettings());
+    REQUIRE(shading.lights.size() == 2);
+
+    const ShadingContext::LightUniforms& point = shading.lights[0];
+    CHECK(point.Falloff(0.0f) == 1.0f);
+    CHECK(point.Falloff(50.0f) == doctest::Approx(0.5625f));
+    CHECK(point.Falloff(100.0f) == 0.0f);
+    CHECK(point.Falloff(1000.0f) == 0.0f);
+
+    Vec3 toLight;
+    float distance;
+    Radiance incoming;
+    CHECK_FALSE(point.Incident(Vec3(0.0f, 150.0f, 0.0f), toLight, distance, incoming));
+    REQUIRE(point.Incident(Vec3(0.0f, 50.0f, 0.0f), toLight, distance, incoming));
+    CHECK(toLight.y == doctest::Approx(-1.0f));
+    CHECK(distance == doctest::Approx(50.0f));
+    CHECK(incoming.R() == doctest::Approx(0.5625f));
+
+    // Directional: same vectors the shading used to normalize at every hit
+    const ShadingContext::LightUniforms& sun = shading.lights[1];
+    const Vec3 expected = normalize(Vec3(0.0f, -1.0f, 0.3f));
+    const Vec3 halfway = normalize(expected + Vec3(0.0f, 0.0f, -1.0f));
+    CHECK(sun.Falloff(1e6f) == 1.0f);
+    CHECK(sun.toLight.y == expected.y);
+    CHECK(sun.toLight.z == expected.z);
+    CHECK(sun.halfway.y == halfway.y);
+    CHECK(sun.halfway.z == halfway.z);
+}
+
+TEST_CASE("Per-tile light culling drops unreachable lights without changing the image")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(-60.0f, 0.0f, 100.0f), 50.0f, Color(1.0f, 0.2f, 0.2f), 0.5f));
+    shapes.push_back(std::make_unique<Sphere>(Vec3(60.0f, -20.0f, 150.0f), 40.0f, Color(0.2f, 0.2f, 1.0f)));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+
+    // One small light per side of the view, one directional light everywhere
+    const std::vector<Light> lights = {
+        Light::Point(Vec3(-120.0f, -40.0f, 60.0f), 90.0f, Color(1.0f, 0.8f, 0.6f), 2.0f),
+        Light::Point(Vec3(120.0f, -60.0f, 120.0f), 90.0f, Color(0.6f, 0.8f, 1.0f), 2.0f),
+        Light::Directional(Vec3(0.0f, 1.0f, -0.3f), Color(1.0f, 1.0f, 1.0f), 0.5f),
+    };
+
+    const int width = 64, height = 48;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera(0.9f);
+    const AntiAliasing antiAliasing(2);
+    const LightTiles tiles(lights, width, height, camOrigin, lowerLeftCorner, horizontal, vertical);
+
+    CHECK(tiles.GetLightCount() == 3);
+    CHECK(tiles.AverageLightsPerTile() < 3.0);
+    CHECK(tiles.AverageLightsPerTile() >= 1.0);
+
+    for (bool shadows : {false, true})
+    {
+        CAPTURE(shadows);
+        RenderSettings settings;
+        settings.shadows = shadows;
+        const Scene scene(shapes, settings, lights);
+
+        PathStats culled, full;
+        for (int j = 0; j < height; ++j)
+        {
+            for (int i = 0; i < width; ++i)
+            {
+                Radiance a = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                      horizontal, vertical, scene, &culled, &tiles);
+                Radiance b = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                      horizontal, vertical, scene, &full);
+                CHECK(a.R() == b.R());
+                CHECK(a.G() == b.G());
+                CHECK(a.B() == b.B());
+            }
+        }
+        // Out-of-range lights never cost a shadow ray, culled or not
+        CHECK(culled.shadowRays == full.shadowRays);
+        CHECK(culled.rays == full.rays);
+    }
+}
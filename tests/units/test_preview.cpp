@@ -0,0 +1,86 @@
+#include "../doctest.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "PreviewRenderer.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "TestScenes.hpp"
+
+TEST_CASE("Preview patterns: checkerboard and even rows")
+{
+    CHECK(PreviewRenderer::IsTraced(PreviewPattern::Checkerboard, 0, 0));
+    CHECK_FALSE(PreviewRenderer::IsTraced(PreviewPattern::Checkerboard, 1, 0));
+    CHECK_FALSE(PreviewRenderer::IsTraced(PreviewPattern::Checkerboard, 0, 1));
+    CHECK(PreviewRenderer::IsTraced(PreviewPattern::Checkerboard, 3, 5));
+    CHECK(PreviewRenderer::IsTraced(PreviewPattern::Interlaced, 7, 0));
+    CHECK(PreviewRenderer::IsTraced(PreviewPattern::Interlaced, 3, 4));
+    CHECK_FALSE(PreviewRenderer::IsTraced(PreviewPattern::Interlaced, 3, 5));
+}
+
+TEST_CASE("Preview rendering: traced pixels are exact, interpolation stays on its shape")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(0.0f, 0.0f, 150.0f), 60.0f, Color(1.0f, 0.3f, 0.2f), 0.0f));
+    RenderSettings settings;
+    const Scene scene(shapes, settings);
+
+    const int width = 40, height = 24;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera();
+    const AntiAliasing antiAliasing(1);
+
+    Image full(width, height);
+    for (int j = 0; j < height; ++j)
+        for (int i = 0; i < width; ++i)
+            full.SetPixel(i, j, antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                         horizontal, vertical, scene));
+    const Radiance background = Ray::BackgroundColor();
+    auto isBackground = [&](int x, int y) { return full.GetPixel(x, y).G() == background.G(); };
+
+    for (PreviewPattern pattern : {PreviewPattern::Checkerboard, PreviewPattern::Interlaced})
+    {
+        Image image(width, height);
+        const PreviewStats stats = PreviewRenderer(scene, antiAliasing, pattern)
+            .Render(image, camOrigin, lowerLeftCorner, horizontal, vertical, 2);
+        CHECK(stats.tracedPixels + stats.interpolatedPixels == static_cast<long long>(width) * height);
+        CHECK(stats.tracedPixels >= static_cast<long long>(width) * height / 2);
+        CHECK(stats.interpolatedPixels > 0);
+
+        for (int j = 0; j < height; ++j)
+        {
+            for (int i = 0; i < width; ++i)
+            {
+                const Radiance c = image.GetPixel(i, j);
+                if (PreviewRenderer::IsTraced(pattern, i, j))
+                {
+                    CHECK(c.G() == full.GetPixel(i, j).G());
+                    continue;
+                }
+
+                // Background is rebuilt from background only, the sphere from the sphere only
+                if (isBackground(i, j))
+                {
+                    CHECK(c.G() == doctest::Approx(background.G()));
+                    continue;
+                }
+                float low = full.GetPixel(i, j).G(), high = low;
+                for (int y = std::max(j - 1, 0); y <= std::min(j + 1, height - 1); ++y)
+                {
+                    for (int x = std::max(i - 1, 0); x <= std::min(i + 1, width - 1); ++x)
+                    {
+                        if (!isBackground(x, y))
+                        {
+                            low = std::min(low, full.GetPixel(x, y).G());
+                            high = std::max(high, full.GetPixel(x, y).G());
+                        }
+                    }
+                }
+                CHECK(c.G() >= doctest::Approx(low));
+                CHECK(c.G() <= doctest::Approx(high));
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "../doctest.h"
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "ProgressiveRenderer.hpp"
+#include "Scene.hpp"
+#include "TestScenes.hpp"
+#include "lodepng.h"
+
+namespace fs = std::filesystem;
+
+TEST_CASE("Progressive passes grow by four up to the full count")
+{
+    CHECK(ProgressiveRenderer::PassSamples(1) == std::vector<int>{1});
+    CHECK(ProgressiveRenderer::PassSamples(4) == std::vector<int>{1, 4});
+    CHECK(ProgressiveRenderer::PassSamples(16) == std::vector<int>{1, 4, 16});
+    CHECK(ProgressiveRenderer::PassSamples(64) == std::vector<int>{1, 4, 16, 64});
+    CHECK(ProgressiveRenderer::PassSamples(10) == std::vector<int>{1, 4, 10});
+}
+
+TEST_CASE("Progressive rendering ends on the single-pass samples and writes a snapshot per pass")
+{
+    const auto shapes = SphereOnFloor();
+    RenderSettings settings;
+    settings.renderer = RendererType::Progressive;
+    const Scene scene(shapes, settings);
+
+    const int width = 40, height = 24;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera();
+    const AntiAliasing antiAliasing(4);
+
+    const fs::path snapshot = "test_progress.png";
+    fs::remove(snapshot);
+    Image image(width, height);
+    const ProgressiveStats stats = ProgressiveRenderer(scene, antiAliasing)
+        .Render(image, camOrigin, lowerLeftCorner, horizontal, vertical, 2, snapshot.string());
+
+    CHECK(stats.passSamples == std::vector<int>{1, 4, 16});
+    REQUIRE(stats.passMs.size() == 3);
+    CHECK(stats.passMs[0] <= stats.passMs[1]);
+    CHECK(stats.passMs[1] <= stats.passMs[2]);
+    CHECK(stats.samples == static_cast<long long>(width) * height * 16);
+
+    // One snapshot after each pass but the last, a complete PNG of the image size
+    CHECK(stats.snapshots == 2);
+    std::vector<unsigned char> pixels;
+    unsigned w = 0, h = 0;
+    REQUIRE(lodepng::decode(pixels, w, h, snapshot.string(), LCT_RGB, 8) == 0);
+    CHECK(w == static_cast<unsigned>(width));
+    CHECK(h == static_cast<unsigned>(height));
+    CHECK_FALSE(fs::exists("test_progress.tmp.png"));
+    fs::remove(snapshot);
+
+    // The passes only add samples: the final image is the 16-sample mean
+    for (int j = 0; j < height; j += 3)
+    {
+        for (int i = 0; i < width; i += 3)
+        {
+            AntiAliasing::PixelSamples pixel;
+            antiAliasing.AddSamples(pixel, 16, i, j, width, height, camOrigin, lowerLeftCorner, horizontal, vertical, scene);
+            CHECK(image.GetPixel(i, j).R() == doctest::Approx(pixel.Average().R()).epsilon(1e-5));
+            CHECK(image.GetPixel(i, j).B() == doctest::Approx(pixel.Average().B()).epsilon(1e-5));
+        }
+    }
+
+    // No file, no snapshot
+    const ProgressiveStats silent = ProgressiveRenderer(scene, antiAliasing)
+        .Render(image, camOrigin, lowerLeftCorner, horizontal, vertical, 1, "");
+    CHECK(silent.snapshots == 0);
+    CHECK_FALSE(fs::exists(snapshot));
+
+    // A snapshot that cannot be written is skipped, the render still completes
+    Image unwritten(width, height);
+    const ProgressiveStats failed = ProgressiveRenderer(scene, antiAliasing)
+        .Render(unwritten, camOrigin, lowerLeftCorner, horizontal, vertical, 1, "missing_directory/test_progress.png");
+    CHECK(failed.snapshots == 0);
+    CHECK(failed.passSamples == std::vector<int>{1, 4, 16});
+    CHECK(unwritten.GetPixel(width / 2, height / 2).R() == doctest::Approx(image.GetPixel(width / 2, height / 2).R()));
+}
@@ -0,0 +1,103 @@
+#include "../doctest.h"
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "QualityMap.hpp"
+#include "QualityRenderer.hpp"
+#include "Scene.hpp"
+#include "TestScenes.hpp"
+#include "lodepng.h"
+
+TEST_CASE("Quality maps: regions cover pixel centers, quality scales samples and depth")
+{
+    QualityMap map(10, 4, 0.25f);
+    CHECK(map.At(0, 0) == 0.25f);
+
+    // x in [0.2, 0.5): centers 2.5, 3.5, 4.5 of 10; y in [0.5, 1): rows 2 and 3
+    map.Paint({0.2f, 0.5f, 0.3f, 0.5f, 1.0f});
+    CHECK(map.At(1, 2) == 0.25f);
+    CHECK(map.At(2, 2) == 1.0f);
+    CHECK(map.At(4, 3) == 1.0f);
+    CHECK(map.At(5, 3) == 0.25f);
+    CHECK(map.At(3, 1) == 0.25f);
+
+    // round(q * full), never below one
+    CHECK(map.Samples(0, 0, 16) == 4);
+    CHECK(map.Samples(2, 2, 16) == 16);
+    CHECK(map.Depth(0, 0, 5) == 1);
+    CHECK(map.Depth(2, 2, 5) == 5);
+    map.Paint({0.0f, 0.0f, 0.1f, 0.25f, 0.0f});
+    CHECK(map.Samples(0, 0, 16) == 1);
+    CHECK(map.Depth(0, 0, 5) == 1);
+
+    // A 2x1 PNG stretched over 4x2 pixels, a region painted over it
+    const std::vector<unsigned char> gray = {0, 255};
+    REQUIRE(lodepng::encode("test_quality_map.png", gray, 2, 1, LCT_GREY, 8) == 0);
+    const QualityMap fromPng = QualityMap::Build(4, 2, "test_quality_map.png", {{0.0f, 0.0f, 0.25f, 0.5f, 0.5f}}, 1.0f);
+    std::filesystem::remove("test_quality_map.png");
+    CHECK(fromPng.At(0, 0) == 0.5f);
+    CHECK(fromPng.At(0, 1) == 0.0f);
+    CHECK(fromPng.At(1, 1) == 0.0f);
+    CHECK(fromPng.At(2, 0) == 1.0f);
+    CHECK(fromPng.At(3, 1) == 1.0f);
+
+    CHECK_THROWS_AS(QualityMap::Build(4, 2, "no_such_quality_map.png", {}, 1.0f), std::runtime_error);
+}
+
+TEST_CASE("Quality rendering: full quality is the uniform render, lower quality saves rays")
+{
+    const auto shapes = SphereOnFloor();
+    RenderSettings settings;
+    settings.maxDepth = 3;
+    const Scene scene(shapes, settings);
+    std::vector<std::unique_ptr<Scene>> shallow;
+    std::vector<const Scene*> views;
+    for (int depth = 1; depth < settings.maxDepth; ++depth)
+    {
+        RenderSettings s = settings;
+        s.maxDepth = depth;
+        shallow.push_back(std::make_unique<Scene>(shapes, s));
+        views.push_back(shallow.back().get());
+    }
+    views.push_back(&scene);
+
+    const int width = 40, height = 24;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera();
+    const AntiAliasing antiAliasing(4);
+
+    // Full quality: every pixel gets the 16 samples at full depth, nothing is saved
+    const QualityMap full(width, height, 1.0f);
+    Image image(width, height);
+    const QualityStats uniform = QualityRenderer(views, antiAliasing, full)
+        .Render(image, camOrigin, lowerLeftCorner, horizontal, vertical, 2);
+    CHECK(uniform.samples == uniform.uniformSamples);
+    CHECK(uniform.paths.rays == uniform.uniformRays);
+    for (int j = 0; j < height; j += 3)
+    {
+        for (int i = 0; i < width; i += 3)
+        {
+            AntiAliasing::PixelSamples pixel;
+            antiAliasing.AddSamples(pixel, 16, i, j, width, height, camOrigin, lowerLeftCorner, horizontal, vertical, scene);
+            CHECK(image.GetPixel(i, j).R() == doctest::Approx(pixel.Average().R()).epsilon(1e-5));
+        }
+    }
+
+    // Left half at quality 0.25: 4 samples of single-segment paths there, the right half untouched
+    QualityMap half(width, height, 1.0f);
+    half.Paint({0.0f, 0.0f, 0.5f, 1.0f, 0.25f});
+    Image mixed(width, height);
+    std::vector<int> counts;
+    const QualityStats stats = QualityRenderer(views, antiAliasing, half)
+        .Render(mixed, camOrigin, lowerLeftCorner, horizontal, vertical, 2, nullptr, &counts);
+    CHECK(stats.samples == static_cast<long long>(width / 2) * height * 4 + static_cast<long long>(width / 2) * height * 16);
+    CHECK(stats.uniformSamples == uniform.uniformSamples);
+    CHECK(stats.paths.rays < uniform.paths.rays);
+    CHECK(stats.uniformRays <= uniform.uniformRays);
+    CHECK(counts[0] == 4);
+    CHECK(counts[width - 1] == 16);
+    for (int j = 0; j < height; ++j)
+        CHECK(mixed.GetPixel(width - 1, j).G() == image.GetPixel(width - 1, j).G());
+}
@@ -0,0 +1,214 @@
+#include "../doctest.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Plane.hpp"
+
+namespace {
+
+// The former recursive TraceScene: one mix per level
+Radiance RecursiveReference(const Scene& scene, const Ray& ray, int depth)
+{
+    if (depth <= 0)
+        return Ray::BackgroundColor();
+
+    HitRecord hit;
+    if (!ray.Intersect(scene, hit))
+        return Ray::BackgroundColor();
+
+    float reflectivity;
+    Radiance surface = Ray::ShadeSurface(scene, hit, ray.GetDirection(), scene.AllLights(), reflectivity);
+    if (reflectivity <= 0.0f)
+        return surface;
+
+    Ray reflected(hit.point + hit.normal * 1e-4f, reflect(ray.GetDirection(), hit.normal));
+    Radiance bounce = RecursiveReference(scene, reflected, depth - 1);
+    return surface * (1.0f - reflectivity) + bounce * reflectivity;
+}
+
+} // namespace
+
+namespace {
+
+std::vector<std::unique_ptr<Shape>> MakeMirrors()
+{
+    // Two mirrors facing each other above a reflective floor: paths reach the depth limit
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Sphere>(Vec3(-80.0f, 0.0f, 200.0f), 60.0f, Color(1.0f, 0.3f, 0.3f), 0.9f));
+    shapes.push_back(std::make_unique<Sphere>(Vec3(80.0f, 0.0f, 200.0f), 60.0f, Color(0.3f, 0.3f, 1.0f), 0.9f));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 70.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    return shapes;
+}
+
+Ray MakeRay(int ix, int iy)
+{
+    return Ray(Vec3A(0.0f, -10.0f, -100.0f), normalize(Vec3A(ix * 0.05f, iy * 0.03f, 1.0f)));
+}
+
+} // namespace
+
+TEST_CASE("Iterative TraceScene matches the recursive Fresnel mix")
+{
+    const auto shapes = MakeMirrors();
+    for (int depth : {0, 1, 2, 5, 8})
+    {
+        CAPTURE(depth);
+        RenderSettings fixed;
+        fixed.maxDepth = depth;
+        fixed.termination = PathTermination::Fixed;
+        const Scene fixedScene(shapes, fixed);
+
+        RenderSettings cutoff = fixed;
+        cutoff.termination = PathTermination::Cutoff;
+        const Scene cutoffScene(shapes, cutoff);
+
+        for (int iy = -10; iy <= 10; ++iy)
+        {
+            for (int ix = -10; ix <= 10; ++ix)
+            {
+                const Ray ray = MakeRay(ix, iy);
+                const Radiance expected = RecursiveReference(fixedScene, ray, depth);
+
+                // No early termination: identical up to rounding
+                PathStats stats;
+                const Radiance exact = ray.TraceScene(fixedScene, 0, &stats);
+                CHECK(exact.R() == doctest::Approx(expected.R()).epsilon(1e-5));
+                CHECK(exact.G() == doctest::Approx(expected.G()).epsilon(1e-5));
+                CHECK(exact.B() == doctest::Approx(expected.B()).epsilon(1e-5));
+                CHECK(stats.terminated == 0);
+
+                // Cutoff: the dropped contribution is below minThroughput
+                const Radiance cut = ray.TraceScene(cutoffScene);
+                CHECK(std::abs(cut.R() - expected.R()) <= cutoff.minThroughput);
+                CHECK(std::abs(cut.G() - expected.G()) <= cutoff.minThroughput);
+                CHECK(std::abs(cut.B() - expected.B()) <= cutoff.minThroughput);
+            }
+        }
+    }
+}
+
+TEST_CASE("Russian roulette saves rays and stays unbiased")
+{
+    const auto shapes = MakeMirrors();
+    RenderSettings fixed;
+    fixed.maxDepth = 8;
+    fixed.termination = PathTermination::Fixed;
+    const Scene fixedScene(shapes, fixed);
+
+    RenderSettings roulette = fixed;
+    roulette.termination = PathTermination::RussianRoulette;
+    roulette.rouletteThreshold = 0.5f;
+    const Scene rouletteScene(shapes, roulette);
+
+    PathStats fixedStats, rouletteStats;
+    for (int iy = -3; iy <= 3; ++iy)
+    {
+        for (int ix = -3; ix <= 3; ++ix)
+        {
+            const Ray ray = MakeRay(ix, iy);
+            const Radiance expected = ray.TraceScene(fixedScene, 0, &fixedStats);
+
+            const int paths = 4000;
+            double r = 0.0, g = 0.0, b = 0.0;
+            for (int seed = 0; seed < paths; ++seed)
+            {
+                const Radiance c = ray.TraceScene(rouletteScene, static_cast<std::uint32_t>(seed), &rouletteStats);
+                r += c.R();
+                g += c.G();
+                b += c.B();
+            }
+            CHECK(r / paths == doctest::Approx(expected.R()).epsilon(0.02));
+            CHECK(g / paths == doctest::Approx(expected.G()).epsilon(0.02));
+            CHECK(b / paths == doctest::Approx(expected.B()).epsilon(0.02));
+        }
+    }
+
+    // Same ray count per path on average would mean roulette never fired
+    CHECK(rouletteStats.terminated > 0);
+    CHECK(static_cast<double>(rouletteStats.rays) / 4000.0 < static_cast<double>(fixedStats.rays));
+}
+
+TEST_CASE("Ray cones widen on spheres and filter the textures by their footprint")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    auto sphere = std::make_unique<Sphere>(Vec3(0.0f, 0.0f, 200.0f), 50.0f, Color(1.0f, 0.5f, 0.25f), 0.9f);
+    sphere->SetTexture(Sphere::TextureType::Marble, 3.0f);
+    const Sphere& marble = *sphere;
+    shapes.push_back(std::move(sphere));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 70.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    const Scene scene(shapes);
+
+    // Straight into the sphere: t = 150, cos = 1
+    RayCone cone;
+    cone.spread = 0.01f;
+    const Ray ray(Vec3A(0.0f, 0.0f, 0.0f), Vec3A(0.0f, 0.0f, 1.0f), cone);
+    HitRecord hit;
+    REQUIRE(ray.Intersect(scene, hit));
+    CHECK(hit.t == doctest::Approx(150.0f));
+    CHECK(hit.footprint == doctest::Approx(1.5f));
+    CHECK(hit.curvature == doctest::Approx(1.0f / 50.0f));
+
+    // Convex mirror: the reflected cone opens by 2 * width / radius
+    const Ray reflected = ray.Reflected(hit);
+    CHECK(reflected.GetCone().width == doctest::Approx(1.5f));
+    CHECK(reflected.GetCone().spread == doctest::Approx(0.01f + 2.0f * 1.5f / 50.0f));
+
+    // Without a cone the footprint stays 0: point sampling, as before
+    HitRecord point;
+    REQUIRE(Ray(Vec3A(0.0f, 0.0f, 0.0f), Vec3A(0.0f, 0.0f, 1.0f)).Intersect(scene, point));
+    CHECK(point.footprint == 0.0f);
+
+    // A footprint much wider than the marble veins leaves their mean, 0.5^1.4
+    const Vec3 p(10.0f, 20.0f, 160.0f);
+    const Vec3 n = normalize(p - marble.GetCenter());
+    const Radiance wide = marble.GetAlbedo(p, n, 1e4f);
+    CHECK(wide.R() == doctest::Approx(std::pow(0.5f, 1.4f)));
+    CHECK(wide.G() == doctest::Approx(0.5f * std::pow(0.5f, 1.4f)));
+    const Radiance sharp = marble.GetAlbedo(p, n, 0.0f);
+    const Radiance narrow = marble.GetAlbedo(p, n, 1e-3f);
+    CHECK(narrow.R() == doctest::Approx(sharp.R()).epsilon(1e-4));
+}
+
+TEST_CASE("The floor checker is box-filtered exactly over the cone footprint")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 70.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    const Scene scene(shapes);
+
+    // Straight down onto the floor from 100 above: the footprint is a square of side `width`
+    auto floorAt = [&](float x, float z, float width) {
+        RayCone cone;
+        cone.spread = width / 100.0f;
+        const Ray ray(Vec3A(x, -30.0f, z), Vec3A(0.0f, 1.0f, 0.0f), cone);
+        HitRecord hit;
+        REQUIRE(ray.Intersect(scene, hit));
+        CHECK(hit.footprint == doctest::Approx(width));
+        float reflectivity;
+        return Ray::ShadeSurface(scene, hit, ray.GetDirection(), scene.AllLights(), reflectivity).R();
+    };
+
+    // Cells are 1000 wide: dark 0.2, light 1
+    CHECK(floorAt(500.0f, 500.0f, 100.0f) == doctest::Approx(0.2f));
+    CHECK(floorAt(1500.0f, 500.0f, 100.0f) == doctest::Approx(1.0f));
+    CHECK(floorAt(1000.0f, 500.0f, 200.0f) == doctest::Approx(0.6f));
+    CHECK(floorAt(700.0f, 300.0f, 1e5f) == doctest::Approx(0.6f).epsilon(0.01));
+
+    // Across a corner: same as averaging the point-sampled checker over the square
+    const float x = 980.0f, z = 1030.0f, width = 300.0f;
+    const int n = 256;
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            const float px = x + width * ((i + 0.5f) / n - 0.5f);
+            const float pz = z + width * ((j + 0.5f) / n - 0.5f);
+            const int check = (static_cast<int>(std::floor(px * 0.001f)) + static_cast<int>(std::floor(pz * 0.001f))) & 1;
+            sum += check ? 1.0 : 0.2;
+        }
+    }
+    CHECK(floorAt(x, z, width) == doctest::Approx(sum / (n * n)).epsilon(1e-3));
+}
@@ -0,0 +1,122 @@
+#include "../doctest.h"
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "Sampler.hpp"
+#include "Scene.hpp"
+#include "TestScenes.hpp"
+#include "WavefrontRenderer.hpp"
+
+TEST_CASE("Samplers are deterministic per pixel and stay inside it")
+{
+    for (SamplerType type : {SamplerType::Grid, SamplerType::Stratified, SamplerType::Sobol,
+                             SamplerType::R2, SamplerType::BlueNoise})
+    {
+        CAPTURE(static_cast<int>(type));
+        const int count = type == SamplerType::Grid ? 9 : 7;
+        const std::unique_ptr<Sampler> sampler = Sampler::Create(type, count);
+        REQUIRE(sampler);
+        CHECK(sampler->GetSampleCount() == count);
+
+        for (int index = 0; index < count; ++index)
+        {
+            float x, y, x2, y2;
+            sampler->Offset(12, 34, index, x, y);
+            sampler->Offset(12, 34, index, x2, y2);
+            CHECK(x == x2);
+            CHECK(y == y2);
+            CHECK(x >= 0.0f);
+            CHECK(x < 1.0f);
+            CHECK(y >= 0.0f);
+            CHECK(y < 1.0f);
+        }
+
+        // The random patterns differ from one pixel to the next
+        float a, b, c, d;
+        sampler->Offset(12, 34, 0, a, b);
+        sampler->Offset(13, 34, 0, c, d);
+        if (type == SamplerType::Grid)
+            CHECK((a == c && b == d));
+        else
+            CHECK((a != c || b != d));
+    }
+
+    CHECK_THROWS(Sampler::Create(SamplerType::Grid, 8));
+}
+
+TEST_CASE("Path seeds wrap around on large frames")
+{
+    // 3840x2180 at 1024 samples: the last index is past INT_MAX
+    const AntiAliasing antiAliasing(4, SamplerType::Stratified, 1024);
+    const std::uint64_t pixel = 2179ull * 3840ull + 3839ull;
+    CHECK(antiAliasing.PathSeed(3839, 2179, 3840, 1023) == static_cast<std::uint32_t>(pixel * 1024ull + 1023ull));
+    CHECK(antiAliasing.PathSeed(1, 0, 3840, 0) == 1024u);
+}
+
+TEST_CASE("Stratified and Sobol samples cover every stratum")
+{
+    // Correlated multi-jittered, any count: one sample in each of the count rows (n-rooks)
+    const std::unique_ptr<Sampler> stratified = Sampler::Create(SamplerType::Stratified, 7);
+    std::set<int> rows;
+    for (int index = 0; index < 7; ++index)
+    {
+        float x, y;
+        stratified->Offset(5, 9, index, x, y);
+        rows.insert(static_cast<int>(y * 7.0f));
+    }
+    CHECK(rows.size() == 7);
+
+    // Owen-scrambled Sobol keeps the (0, 2)-net property: 16 points, one per 4x4 cell,
+    // per 16x1 column and per 1x16 row
+    const std::unique_ptr<Sampler> sobol = Sampler::Create(SamplerType::Sobol, 16);
+    std::set<int> cells, columns, lines;
+    for (int index = 0; index < 16; ++index)
+    {
+        float x, y;
+        sobol->Offset(100, 7, index, x, y);
+        cells.insert(static_cast<int>(x * 4.0f) + 4 * static_cast<int>(y * 4.0f));
+        columns.insert(static_cast<int>(x * 16.0f));
+        lines.insert(static_cast<int>(y * 16.0f));
+    }
+    CHECK(cells.size() == 16);
+    CHECK(columns.size() == 16);
+    CHECK(lines.size() == 16);
+}
+
+TEST_CASE("Any sample count renders the same in both pipelines")
+{
+    const auto shapes = SphereOnFloor();
+    const Scene scene(shapes);
+
+    const int width = 24, height = 16;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera(0.8f);
+
+    // The grid ignores samplesPerPixel; the others use it
+    CHECK(AntiAliasing(3, SamplerType::Grid, 6).GetTotalSamples() == 9);
+    CHECK(AntiAliasing(3, SamplerType::R2).GetTotalSamples() == 9);
+
+    for (SamplerType type : {SamplerType::Stratified, SamplerType::Sobol, SamplerType::BlueNoise})
+    {
+        CAPTURE(static_cast<int>(type));
+        const AntiAliasing antiAliasing(4, type, 6);
+        REQUIRE(antiAliasing.GetTotalSamples() == 6);
+
+        Image wavefront(width, height);
+        const WavefrontStats stats = WavefrontRenderer(scene, antiAliasing).Render(
+            wavefront, camOrigin, lowerLeftCorner, horizontal, vertical, 2);
+        CHECK(stats.raysTraced == stats.reflectionRays + static_cast<long long>(width) * height * 6);
+
+        for (int j = 0; j < height; ++j)
+        {
+            for (int i = 0; i < width; ++i)
+            {
+                const Radiance expected = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                                   horizontal, vertical, scene);
+                CHECK(wavefront.GetPixel(i, j).R() == doctest::Approx(expected.R()).epsilon(1e-5));
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "../doctest.h"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Sphere.hpp"
+#include "TextureCache.hpp"
+
+TEST_CASE("Baked cube maps return the pattern at texel centers and interpolate it in between")
+{
+    Sphere sphere(Vec3(10.0f, -20.0f, 300.0f), 80.0f, Color(1.0f, 1.0f, 1.0f));
+    sphere.SetTexture(Sphere::TextureType::Marble, 1234.0f);
+    const Vec3 center = sphere.GetCenter();
+    const float radius = sphere.GetRadius();
+    auto pattern = [&](const Vec3& direction) { return sphere.EvaluatePattern(center + direction * radius, direction); };
+
+    const SphereTextureCache cache(256, pattern);
+    CHECK(cache.GetBytes() == SphereTextureCache::BytesFor(256));
+
+    for (int face = 0; face < 6; ++face)
+    {
+        CAPTURE(face);
+        const Vec3 direction = cache.TexelDirection(face, 37, 201);
+        CHECK(cache.Sample(direction) == doctest::Approx(pattern(direction)).epsilon(1e-5));
+        CHECK(cache.Sample(direction * 3.0f) == doctest::Approx(pattern(direction)).epsilon(1e-5));
+    }
+
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist;
+    double maxError = 0.0;
+    for (int k = 0; k < 2000; ++k)
+    {
+        const Vec3 direction = normalize(Vec3(dist(gen), dist(gen), dist(gen)));
+        maxError = std::max(maxError, static_cast<double>(std::fabs(cache.Sample(direction) - pattern(direction))));
+    }
+    CHECK(maxError < 0.02);
+
+    // The albedo follows the cache while the footprint stays under a texel, the analytic texture past it
+    const Vec3 normal = normalize(Vec3(0.3f, -0.5f, -0.8f));
+    const Vec3 point = center + normal * radius;
+    sphere.SetTextureCache(std::make_shared<const SphereTextureCache>(8, pattern));
+    CHECK(sphere.GetAlbedo(point, normal).R() != sphere.EvaluatePattern(point, normal));
+    CHECK(sphere.GetAlbedo(point, normal, 30.0f).R() == sphere.EvaluatePattern(point, normal, 30.0f));
+    sphere.SetTexture(Sphere::TextureType::Marble, 1234.0f);
+    CHECK_FALSE(sphere.HasTextureCache());
+}
+
+TEST_CASE("Texture baking sizes caches by projected radius and keeps to the memory cap")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    auto add = [&](float z, float radius, Sphere::TextureType type) {
+        auto sphere = std::make_unique<Sphere>(Vec3(0.0f, 0.0f, z), radius, Color(1.0f, 1.0f, 1.0f));
+        sphere->SetTexture(type, 42.0f);
+        shapes.push_back(std::move(sphere));
+        return static_cast<Sphere*>(shapes.back().get());
+    };
+    Sphere* near = add(100.0f, 50.0f, Sphere::TextureType::Noise);       // 50 px of radius -> 75 texels
+    Sphere* far = add(1000.0f, 50.0f, Sphere::TextureType::Marble);      // 5 px -> MIN_CACHE_SIZE
+    Sphere* gradient = add(200.0f, 50.0f, Sphere::TextureType::Gradient);
+
+    const Vec3 camOrigin(0.0f, 0.0f, 0.0f);
+    const float pixelsPerUnit = 100.0f;
+
+    TextureBakeStats stats = BakeSphereTextures(shapes, camOrigin, pixelsPerUnit, 1u << 30, 4);
+    CHECK(stats.baked == 2);
+    CHECK(stats.analytic == 0);
+    CHECK(stats.bytes == SphereTextureCache::BytesFor(75) + SphereTextureCache::BytesFor(MIN_CACHE_SIZE));
+    CHECK(near->HasTextureCache());
+    CHECK(far->HasTextureCache());
+    CHECK_FALSE(gradient->HasTextureCache());
+
+    // Room for the near sphere only: the far one falls back to the analytic texture
+    stats = BakeSphereTextures(shapes, camOrigin, pixelsPerUnit, SphereTextureCache::BytesFor(75), 4);
+    CHECK(stats.baked == 1);
+    CHECK(stats.analytic == 1);
+    CHECK(near->HasTextureCache());
+    CHECK_FALSE(far->HasTextureCache());
+
+    const Vec3 normal(0.0f, 0.0f, -1.0f);
+    const Vec3 point = far->GetCenter() + normal * far->GetRadius();
+    CHECK(far->GetAlbedo(point, normal).R() == far->EvaluatePattern(point, normal));
+}
@@ -1,5 +1,6 @@
 #include "../doctest.h"
 #include "Vec3.hpp"
+#include "Vec3A.hpp"
 
 TEST_CASE("Vec3 default constructor initializes to zero")
 {
@@ -61,3 +62,45 @@ TEST_CASE("Vec3 unary minus works")
     CHECK(r.y == 2.0f);
     CHECK(r.z == -3.0f);
 }
+
+TEST_CASE("Vec3A round-trips through Vec3 and matches its operators")
+{
+    Vec3 a(1.5f, -2.0f, 3.25f), b(0.5f, 4.0f, -1.0f);
+    Vec3A va(a), vb(b);
+
+    Vec3 sum = static_cast<Vec3>(va + vb);
+    CHECK(sum.x == 2.0f);
+    CHECK(sum.y == 2.0f);
+    CHECK(sum.z == 2.25f);
+
+    Vec3 scaled = static_cast<Vec3>((va - vb) * 2.0f);
+    CHECK(scaled.x == 2.0f);
+    CHECK(scaled.y == -12.0f);
+    CHECK(scaled.z == 8.5f);
+
+    CHECK(dot(va, vb) == dot(a, b));
+    CHECK(length(va) == doctest::Approx(length(a)));
+
+    Vec3 r = static_cast<Vec3>(reflect(va, Vec3A(0.0f, 1.0f, 0.0f)));
+    CHECK(r.x == 1.5f);
+    CHECK(r.y == 2.0f);
+    CHECK(r.z == 3.25f);
+}
+
+TEST_CASE("Vec3A normalize is accurate and keeps zero vectors at zero")
+{
+    for (int i = 1; i < 200; ++i)
+    {
+        Vec3A v(i * 0.37f - 30.0f, i * 1.91f, 1000.0f / i);
+        Vec3 expected = normalize(static_cast<Vec3>(v));
+        Vec3 n = static_cast<Vec3>(normalize(v));
+        CHECK(n.x == doctest::Approx(expected.x).epsilon(1e-6));
+        CHECK(n.y == doctest::Approx(expected.y).epsilon(1e-6));
+        CHECK(n.z == doctest::Approx(expected.z).epsilon(1e-6));
+    }
+
+    Vec3 zero = static_cast<Vec3>(normalize(Vec3A()));
+    CHECK(zero.x == 0.0f);
+    CHECK(zero.y == 0.0f);
+    CHECK(zero.z == 0.0f);
+}
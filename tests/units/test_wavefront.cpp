@@ -0,0 +1,74 @@
+#include "../doctest.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "AntiAliasing.hpp"
+#include "Image.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Cube.hpp"
+#include "Plane.hpp"
+#include "TestScenes.hpp"
+#include "WavefrontRenderer.hpp"
+
+TEST_CASE("Wavefront pipeline reproduces the recursive renderer")
+{
+    std::vector<std::unique_ptr<Shape>> shapes;
+    auto marble = std::make_unique<Sphere>(Vec3(-60.0f, 0.0f, 100.0f), 50.0f, Color(1.0f, 0.2f, 0.2f), 0.8f);
+    marble->SetTexture(Sphere::TextureType::Marble, 12.0f);
+    shapes.push_back(std::move(marble));
+    shapes.push_back(std::make_unique<Sphere>(Vec3(60.0f, -20.0f, 150.0f), 40.0f, Color(0.2f, 0.2f, 1.0f), 0.5f));
+    shapes.push_back(std::make_unique<Cube>(Vec3(0.0f, 40.0f, 300.0f), 60.0f, Color(0.2f, 1.0f, 0.2f)));
+    shapes.push_back(std::make_unique<Plane>(Vec3(0.0f, 80.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), 0.5f));
+    const Scene scene(shapes);
+
+    // Russian roulette: the same path seeds must give the same random decisions
+    RenderSettings roulette;
+    roulette.termination = PathTermination::RussianRoulette;
+    roulette.rouletteThreshold = 0.5f;
+    const Scene rouletteScene(shapes, roulette);
+
+    // Ray cones: the footprints must follow the same reflections
+    RenderSettings filtered;
+    filtered.textureFilter = true;
+    const Scene filteredScene(shapes, filtered);
+
+    const int width = 40, height = 30;
+    const auto [camOrigin, horizontal, vertical, lowerLeftCorner] = TestCamera(0.9f);
+    const AntiAliasing antiAliasing(2);
+
+    for (bool sortReflections : {false, true})
+    {
+        CAPTURE(sortReflections);
+        for (const Scene* view : {&scene, &rouletteScene, &filteredScene})
+        {
+            Image wavefront(width, height);
+            const WavefrontStats stats = WavefrontRenderer(*view, antiAliasing, sortReflections).Render(
+                wavefront, camOrigin, lowerLeftCorner, horizontal, vertical, 3);
+            CHECK(stats.raysTraced == stats.reflectionRays + static_cast<long long>(width) * height * antiAliasing.GetTotalSamples());
+            CHECK(stats.reflectionRays > 0);
+            CHECK(stats.sortedRays == (sortReflections ? stats.reflectionRays : 0));
+            // Sorting does not always reduce the switches; unsorted renders do not count them
+            if (sortReflections)
+                CHECK(stats.shapeSwitchesUnsorted > 0);
+            else
+                CHECK(stats.shapeSwitchesTraced + stats.shapeSwitchesUnsorted == 0);
+
+            PathStats recursive;
+            for (int j = 0; j < height; ++j)
+            {
+                for (int i = 0; i < width; ++i)
+                {
+                    Radiance expected = antiAliasing.SamplePixel(i, j, width, height, camOrigin, lowerLeftCorner,
+                                                              horizontal, vertical, *view, &recursive);
+                    Radiance actual = wavefront.GetPixel(i, j);
+                    CHECK(actual.R() == doctest::Approx(expected.R()).epsilon(1e-5));
+                    CHECK(actual.G() == doctest::Approx(expected.G()).epsilon(1e-5));
+                    CHECK(actual.B() == doctest::Approx(expected.B()).epsilon(1e-5));
+                }
+            }
+            CHECK(stats.raysTraced == recursive.rays);
+            CHECK(stats.terminatedPaths == recursive.terminated);
+        }
+    }
+}